@@ -0,0 +1,116 @@
+// Calla Chen
+// Benchmark for Banker::requestBatch() against one Banker::request() per request
+//
+// Two Bankers start from the same random state and see the same ticks: a batch of requests followed by a few
+// releases. One decides each tick with request() in a loop, the other with a single requestBatch() call. Verdicts
+// must match exactly; only request time is measured. Build and run with: make bench-batch
+//
+// Usage: bench_batch [customers] [resources] [batch size] [ticks] [available per resource]
+#include "banker.h"
+#include "log_global.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <sys/time.h>
+
+using namespace std;
+
+static double nowMicros() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+// Writes a random max demand file and loads it, with 'avail' units of every resource available
+static void setUp(Banker& banker, const string& path, int n, int m, int avail) {
+    if (banker.isSafeSequenceEnabled()) banker.toggleSafeSequence();  // Time the decision, not the [SAFE] line
+    srand(7);
+    ofstream out(path.c_str());
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < m; ++j) out << (j ? "," : "") << 1 + rand() % 10;
+        out << "\n";
+    }
+    out.close();
+    banker.loadMaximumFromFile(path);
+    vector<int> res(m, avail);
+    banker.setAvailable(&res[0]);
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 200;
+    int m = argc > 2 ? atoi(argv[2]) : 16;
+    int batchSize = argc > 3 ? atoi(argv[3]) : 32;
+    int ticks = argc > 4 ? atoi(argv[4]) : 200;
+    int avail = argc > 5 ? atoi(argv[5]) : 40; // Scarce relative to the claims, so a share of requests is unsafe
+    if (n <= 0 || m <= 0 || batchSize <= 0 || ticks <= 0 || avail <= 0) {
+        cerr << "Usage: " << argv[0] << " [customers] [resources] [batch size] [ticks] [available per resource]" << endl;
+        return 1;
+    }
+    initCustomerStats(n);
+    string path = "bench_batch_max.txt";
+    Banker serial(n, m), batched(n, m);
+    setUp(serial, path, n, m, avail);
+    setUp(batched, path, n, m, avail);
+    remove(path.c_str());
+
+    // Silence the deadlock reports from the serial path while timing
+    streambuf* console = cout.rdbuf();
+    ostringstream sink;
+    cout.rdbuf(sink.rdbuf());
+
+    srand(11);
+    double serialUs = 0, batchUs = 0;
+    long checks = 0, granted = 0, mismatches = 0, total = 0;
+    vector<int> verdicts;
+    for (int t = 0; t < ticks; ++t) {
+        // Build the tick: small requests against each customer's declared maximum
+        vector<Banker::BatchRequest> batch(batchSize);
+        for (int k = 0; k < batchSize; ++k) {
+            batch[k].customer = rand() % n;
+            batch[k].amounts.resize(m);
+            for (int j = 0; j < m; ++j) batch[k].amounts[j] = rand() % 3;
+        }
+
+        double start = nowMicros();
+        vector<int> serialVerdicts(batchSize);
+        for (int k = 0; k < batchSize; ++k)
+            serialVerdicts[k] = serial.request(batch[k].customer, &batch[k].amounts[0]);
+        serialUs += nowMicros() - start;
+
+        start = nowMicros();
+        checks += batched.requestBatch(batch, verdicts);
+        batchUs += nowMicros() - start;
+
+        for (int k = 0; k < batchSize; ++k) {
+            if (verdicts[k] != serialVerdicts[k]) ++mismatches;
+            if (verdicts[k] == Banker::GRANTED) ++granted;
+        }
+        total += batchSize;
+
+        // A few customers finish and hand everything back
+        const int* alloc = batched.getAllocation();
+        for (int r = 0; r < batchSize / 4; ++r) {
+            int c = rand() % n;
+            vector<int> rel(alloc + (size_t)c * batched.getRowStride(), alloc + (size_t)c * batched.getRowStride() + m);
+            serial.release(c, &rel[0]);
+            batched.release(c, &rel[0]);
+        }
+    }
+    cout.rdbuf(console);
+
+    cout << "Batch requests: " << n << " customers x " << m << " resources, " << ticks << " ticks of "
+         << batchSize << " (" << granted << "/" << total << " granted)" << endl;
+    cout << fixed << setprecision(0)
+         << "serial    " << setw(10) << total * 1e6 / serialUs << " req/s" << endl
+         << "batch     " << setw(10) << total * 1e6 / batchUs << " req/s  (" << setprecision(2)
+         << serialUs / batchUs << "x, " << checks << " safety checks for " << total << " requests)" << endl;
+    if (mismatches) {
+        cout << "[ERROR] " << mismatches << " verdicts differ from the serial path" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+// Calla Chen
+// Benchmark for the binary checkpoint (save bin / load bin) against the text save.txt format
+//
+// Fills a Banker with random maximum claims and allocations, then saves and loads it in both formats and checks that
+// each load reproduces the saved state. Build and run with: make bench-checkpoint
+//
+// Usage: bench_checkpoint [customers] [resources]
+#include "banker.h"
+#include "log_global.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <sys/time.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static double nowMicros() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+static long fileSize(const string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? (long)st.st_size : 0;
+}
+
+static bool sameState(const Banker& a, const Banker& b) {
+    Banker::StateSnapshot x, y;
+    a.readSnapshot(x);
+    b.readSnapshot(y);
+    return x.available == y.available && x.maximum == y.maximum && x.allocation == y.allocation && x.need == y.need;
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 20000;
+    int m = argc > 2 ? atoi(argv[2]) : 256;
+    if (n <= 0 || m <= 0) {
+        cerr << "Usage: " << argv[0] << " [customers] [resources]" << endl;
+        return 1;
+    }
+    initCustomerStats(n);
+
+    // Text state file with random claims and allocations, loaded through the text path to build the source state
+    srand(5);
+    string textPath = "bench_checkpoint_save.txt", binPath = "bench_checkpoint_save.bin";
+    {
+        ofstream out(textPath.c_str());
+        out << "Available:";
+        for (int j = 0; j < m; ++j) out << " " << rand() % 100;
+        out << "\nMaximum:\n";
+        vector<int> alloc((size_t)n * m);
+        for (int i = 0; i < n; ++i) {
+            out << "P" << i << ":";
+            for (int j = 0; j < m; ++j) {
+                int claim = 1 + rand() % 10;
+                alloc[(size_t)i * m + j] = rand() % (claim + 1);
+                out << " " << claim;
+            }
+            out << "\n";
+        }
+        out << "Allocation:\n";
+        for (int i = 0; i < n; ++i) {
+            out << "P" << i << ":";
+            for (int j = 0; j < m; ++j) out << " " << alloc[(size_t)i * m + j];
+            out << "\n";
+        }
+    }
+    Banker source(n, m);
+    if (!source.loadState(textPath)) {
+        cerr << "[ERROR] Could not build the source state" << endl;
+        return 1;
+    }
+
+    double start = nowMicros();
+    source.saveState(textPath);
+    double textSaveUs = nowMicros() - start;
+    Banker textCopy(n, m);
+    start = nowMicros();
+    bool textOk = textCopy.loadState(textPath) && sameState(source, textCopy);
+    double textLoadUs = nowMicros() - start;
+
+    start = nowMicros();
+    bool binOk = source.saveBinary(binPath);
+    double binSaveUs = nowMicros() - start;
+    Banker binCopy(n, m);
+    start = nowMicros();
+    binOk = binOk && binCopy.loadBinary(binPath);
+    double binLoadUs = nowMicros() - start;
+    binOk = binOk && sameState(source, binCopy);
+
+    long textBytes = fileSize(textPath), binBytes = fileSize(binPath);
+    remove(textPath.c_str());
+    remove(binPath.c_str());
+    rmdir("logs"); // Created by the logging globals; only removed if empty
+
+    cout << "Checkpoint: " << n << " customers x " << m << " resources" << endl;
+    cout << fixed << setprecision(1)
+         << "text     save " << setw(8) << textSaveUs / 1000 << " ms  load " << setw(8) << textLoadUs / 1000
+         << " ms  " << setw(6) << textBytes / 1048576.0 << " MB" << (textOk ? "" : "  MISMATCH") << endl
+         << "binary   save " << setw(8) << binSaveUs / 1000 << " ms  load " << setw(8) << binLoadUs / 1000
+         << " ms  " << setw(6) << binBytes / 1048576.0 << " MB  (" << textSaveUs / binSaveUs << "x / "
+         << textLoadUs / binLoadUs << "x faster, fsync included)" << (binOk ? "" : "  MISMATCH") << endl;
+    if (!textOk || !binOk) {
+        cout << "[ERROR] A loaded state differs from the saved one" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+// Calla Chen
+// Stress test and throughput benchmark for ConcurrentBanker (src/concurrent_banker.cpp)
+//
+// Every thread owns the customers i with i % threads == thread id and mixes requests, releases of what its customers
+// hold, previews and state snapshots. Each snapshot is checked for conservation (Available + sum of Allocation equals
+// the initial Available for every resource), which fails if a reader ever sees a half-applied commit.
+// Build and run with: make bench-concurrent
+//
+// Usage: bench_concurrent [customers] [resources] [ops per thread] [max threads]
+#include "concurrent_banker.h"
+#include "log_global.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <pthread.h>
+#include <sys/time.h>
+
+using namespace std;
+
+static double nowMicros() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+struct Worker {
+    ConcurrentBanker* front;
+    int id;
+    int threads;
+    int ops;
+    int avail;                  // Initial available units of every resource
+    long granted;
+    long broken;                // Snapshots that violated conservation
+    pthread_t thread;
+};
+
+static void* runWorker(void* arg) {
+    Worker* w = (Worker*)arg;
+    int n = w->front->getNumCustomers();
+    int m = w->front->getNumResources();
+    unsigned seed = 1234u + w->id;
+    vector<int> amounts(m), held((size_t)n * m, 0), sequence, available, allocation, need;
+
+    for (int op = 0; op < w->ops; ++op) {
+        int c = w->id + w->threads * (rand_r(&seed) % ((n - 1 - w->id) / w->threads + 1)); // One of our customers
+        int kind = rand_r(&seed) % 10;
+        if (kind < 6) {
+            for (int j = 0; j < m; ++j) amounts[j] = rand_r(&seed) % 3;
+            if (w->front->request(c, &amounts[0]) == Banker::GRANTED) {
+                ++w->granted;
+                for (int j = 0; j < m; ++j) held[(size_t)c * m + j] += amounts[j];
+            }
+        } else if (kind < 8) {
+            for (int j = 0; j < m; ++j) amounts[j] = held[(size_t)c * m + j];
+            if (w->front->release(c, &amounts[0]))
+                for (int j = 0; j < m; ++j) held[(size_t)c * m + j] = 0;
+        } else if (kind < 9) {
+            for (int j = 0; j < m; ++j) amounts[j] = rand_r(&seed) % 3;
+            w->front->preview(c, &amounts[0], sequence);
+        } else {
+            w->front->snapshotState(available, allocation, need);
+            for (int j = 0; j < m; ++j) {
+                long total = available[j];
+                for (int i = 0; i < n; ++i) total += allocation[(size_t)i * m + j];
+                if (total != w->avail) { ++w->broken; break; }
+            }
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 64;
+    int m = argc > 2 ? atoi(argv[2]) : 8;
+    int ops = argc > 3 ? atoi(argv[3]) : 20000;
+    int maxThreads = argc > 4 ? atoi(argv[4]) : 8;
+    if (n <= 0 || m <= 0 || ops <= 0 || maxThreads <= 0 || maxThreads > n) {
+        cerr << "Usage: " << argv[0] << " [customers] [resources] [ops per thread] [max threads <= customers]" << endl;
+        return 1;
+    }
+    initCustomerStats(n);
+
+    string path = "bench_concurrent_max.txt";
+    srand(7);
+    ofstream out(path.c_str());
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < m; ++j) out << (j ? "," : "") << 1 + rand() % 10;
+        out << "\n";
+    }
+    out.close();
+    int avail = n * 2;
+
+    cout << "ConcurrentBanker: " << n << " customers x " << m << " resources, " << ops << " ops per thread" << endl;
+    bool ok = true;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        Banker banker(n, m);
+        banker.loadMaximumFromFile(path);
+        vector<int> res(m, avail);
+        banker.setAvailable(&res[0]);
+        ConcurrentBanker front(banker);
+
+        vector<Worker> workers(threads);
+        double start = nowMicros();
+        for (int t = 0; t < threads; ++t) {
+            Worker w = { &front, t, threads, ops, avail, 0, 0, pthread_t() };
+            workers[t] = w;
+            pthread_create(&workers[t].thread, NULL, runWorker, &workers[t]);
+        }
+        long granted = 0, broken = 0;
+        for (int t = 0; t < threads; ++t) {
+            pthread_join(workers[t].thread, NULL);
+            granted += workers[t].granted;
+            broken += workers[t].broken;
+        }
+        double elapsed = nowMicros() - start;
+
+        // The final state must also be safe and conserve every resource
+        vector<int> available, allocation, need, sequence;
+        front.snapshotState(available, allocation, need);
+        vector<int> zero(m, 0);
+        bool safe = front.preview(0, &zero[0], sequence) == Banker::GRANTED;
+
+        cout << setw(2) << threads << " thread" << (threads == 1 ? " " : "s") << fixed << setprecision(0)
+             << setw(12) << (double)threads * ops * 1e6 / elapsed << " ops/s  (" << granted << " granted, "
+             << broken << " inconsistent snapshots, final state " << (safe ? "safe" : "UNSAFE") << ")" << endl;
+        if (broken || !safe) ok = false;
+    }
+    remove(path.c_str());
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+// Calla Chen
+// Microbenchmark for the Banker row kernels (src/kernels.cpp)
+//
+// Times the original per-element loops from isSafe() against each instruction set the CPU supports, on the padded
+// layout the Banker uses. Build and run with: make bench-kernels
+//
+// Usage: bench_kernels [resources] [customers] [passes]
+#include "kernels.h"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <vector>
+#include <sys/time.h>
+
+using namespace std;
+
+static double nowMicros() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+// The loops as they were written in Banker::isSafe(): early exit on the first resource that does not fit
+static bool baselineRowFits(const int* row, const int* work, int m) {
+    for (int j = 0; j < m; ++j)
+        if (row[j] > work[j]) return false;
+    return true;
+}
+
+static void baselineAddRow(int* work, const int* row, int m) {
+    for (int j = 0; j < m; ++j)
+        work[j] += row[j];
+}
+
+// One full classic safety scan; every row fits, so each pass does the full compare + accumulate work
+static long scan(bool (*fits)(const int*, const int*, int), void (*add)(int*, const int*, int),
+                 const int* needM, const int* alloc, int* work, int n, int width, int stride) {
+    long finished = 0;
+    for (int i = 0; i < n; ++i) {
+        if (fits(needM + (size_t)i * stride, work, width)) {
+            add(work, alloc + (size_t)i * stride, width);
+            ++finished;
+        }
+    }
+    return finished;
+}
+
+static double timeScan(bool (*fits)(const int*, const int*, int), void (*add)(int*, const int*, int),
+                       const vector<int>& needM, const vector<int>& alloc, int n, int width, int stride,
+                       int passes, long& checksum) {
+    vector<int> work(stride, 0);
+    double start = nowMicros();
+    for (int p = 0; p < passes; ++p) {
+        for (int j = 0; j < stride; ++j) work[j] = j < width ? 1000 : 0;
+        checksum += scan(fits, add, &needM[0], &alloc[0], &work[0], n, width, stride);
+    }
+    return (nowMicros() - start) / passes;
+}
+
+int main(int argc, char* argv[]) {
+    int m = argc > 1 ? atoi(argv[1]) : 256;
+    int n = argc > 2 ? atoi(argv[2]) : 512;
+    int passes = argc > 3 ? atoi(argv[3]) : 200;
+    if (m <= 0 || n <= 0 || passes <= 0) {
+        cerr << "Usage: " << argv[0] << " [resources] [customers] [passes]" << endl;
+        return 1;
+    }
+    int stride = (m + KERNEL_LANES - 1) / KERNEL_LANES * KERNEL_LANES;
+
+    // Needs below the starting Work so every row fits; padding columns stay zero as in Banker
+    vector<int> needM((size_t)n * stride, 0), alloc((size_t)n * stride, 0);
+    srand(42);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < m; ++j) {
+            needM[(size_t)i * stride + j] = rand() % 1000;
+            alloc[(size_t)i * stride + j] = rand() % 4;
+        }
+    }
+
+    cout << "Row kernels: " << n << " customers x " << m << " resources (stride " << stride << "), "
+         << passes << " scans each" << endl;
+
+    long checksum = 0;
+    double base = timeScan(baselineRowFits, baselineAddRow, needM, alloc, n, m, stride, passes, checksum);
+    cout << left << setw(10) << "baseline" << fixed << setprecision(2) << setw(12) << base << " us/scan" << endl;
+
+    Kernels::Isa isas[3] = { Kernels::ISA_SCALAR, Kernels::ISA_SSE41, Kernels::ISA_AVX2 };
+    for (int k = 0; k < 3; ++k) {
+        Kernels::select(isas[k]);
+        if (Kernels::activeIsa() != isas[k]) {
+            cout << left << setw(10) << Kernels::isaName(isas[k]) << "not supported by this CPU" << endl;
+            continue;
+        }
+        double t = timeScan(Kernels::rowFits, Kernels::addRow, needM, alloc, n, stride, stride, passes, checksum);
+        cout << left << setw(10) << Kernels::isaName(isas[k]) << fixed << setprecision(2) << setw(12) << t
+             << " us/scan  (" << setprecision(2) << base / t << "x)" << endl;
+    }
+    cout << "checksum " << checksum << endl;
+    return 0;
+}
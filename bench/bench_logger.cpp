@@ -0,0 +1,129 @@
+// Calla Chen
+// Benchmark for the asynchronous Logger mode and the binary event log against the synchronous text log
+//
+// Times the RQ/RL outcome lines the command handler logs on every request and release, first through the synchronous
+// path (format, write with a flush, echo to the console), then through the lock-free ring and background writer, and
+// last as BinaryLog records (binlog on). The console echo goes to /dev/null so only the logging work is measured.
+// Reports caller-side cost and bytes per line, and the writer's batches and dropped records. The binary log is decoded
+// again to check that every record survives. Build and run with: make bench-logger
+//
+// Usage: bench_logger [lines] [resources] [ring capacity] [flush interval ms]
+#include "logger.h"
+#include "binary_log.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <sys/time.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static double nowMicros() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+// Logs 'lines' request/release outcomes the way the RQ and RL commands do; returns microseconds
+static double logLines(int lines, int m) {
+    vector<int> amounts(m);
+    double start = nowMicros();
+    for (int i = 0; i < lines; ++i) {
+        for (int j = 0; j < m; ++j) amounts[j] = (i + j) % 4;
+        if (i % 2 == 0)
+            Logger::event(Logger::EVENT_REQUEST, i % 50, &amounts[0], m, "GRANTED", Logger::INFO);
+        else
+            Logger::event(Logger::EVENT_RELEASE, i % 50, &amounts[0], m, "RELEASED", Logger::INFO);
+    }
+    return nowMicros() - start;
+}
+
+// The same events as BinaryLog records; returns microseconds, including the final write
+static double logBinary(int lines, int m) {
+    vector<int> amounts(m);
+    double start = nowMicros();
+    for (int i = 0; i < lines; ++i) {
+        for (int j = 0; j < m; ++j) amounts[j] = (i + j) % 4;
+        BinaryLog::record(i % 2 == 0 ? BinaryLog::TYPE_REQUEST : BinaryLog::TYPE_RELEASE, i % 50, &amounts[0], m, 0);
+    }
+    BinaryLog::close();
+    return nowMicros() - start;
+}
+
+static long fileSize(const string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? (long)st.st_size : 0;
+}
+
+int main(int argc, char* argv[]) {
+    int lines = argc > 1 ? atoi(argv[1]) : 200000;
+    int m = argc > 2 ? atoi(argv[2]) : 4;
+    int capacity = argc > 3 ? atoi(argv[3]) : LOGGER_RING_CAPACITY;
+    int interval = argc > 4 ? atoi(argv[4]) : LOGGER_FLUSH_INTERVAL_MS;
+    if (lines <= 0 || m <= 0 || m > LOGGER_RECORD_VALUES || capacity <= 0 || interval <= 0) {
+        cerr << "Usage: " << argv[0] << " [lines] [resources <= " << LOGGER_RECORD_VALUES
+             << "] [ring capacity] [flush interval ms]" << endl;
+        return 1;
+    }
+    string path = "bench_logger_events.log";
+    Logger::init(path);
+
+    // Keep the synchronous console echo, but send it nowhere
+    ofstream devNull("/dev/null");
+    streambuf* console = cout.rdbuf();
+    cout.rdbuf(devNull.rdbuf());
+    double syncUs = logLines(lines, m);
+    cout.rdbuf(console);
+    double textBytes = (double)fileSize(path) / lines;
+
+    Logger::startAsync(interval, capacity);
+    double asyncUs = logLines(lines, m);
+    double drainStart = nowMicros();
+    Logger::AsyncStats stats = Logger::stopAsync();
+    double drainUs = nowMicros() - drainStart;
+    Logger::close();
+    remove(path.c_str());
+
+    string binPath = "bench_logger_events.bin";
+    if (!BinaryLog::open(binPath)) {
+        cerr << "[ERROR] Cannot create " << binPath << endl;
+        return 1;
+    }
+    double binaryUs = logBinary(lines, m);
+    double binaryBytes = (double)fileSize(binPath) / lines;
+    unsigned long decoded = 0;
+    FILE* file = fopen(binPath.c_str(), "rb");
+    if (file) {
+        BinaryLogReader reader(file);
+        BinaryLogReader::Record record;
+        while (reader.next(record)) ++decoded;
+        fclose(file);
+    }
+    remove(binPath.c_str());
+    rmdir("logs"); // Created by Logger::init() and BinaryLog::open(); only removed if empty
+
+    cout << "Event logging: " << lines << " RQ/RL lines, " << m << " resources, " << stats.capacity
+         << "-record ring, " << interval << " ms flush interval" << endl;
+    cout << fixed << setprecision(0)
+         << "sync      " << setw(8) << syncUs * 1000 / lines << " ns/line  (" << setprecision(1) << textBytes
+         << " bytes/line)" << setprecision(0) << endl
+         << "async     " << setw(8) << asyncUs * 1000 / lines << " ns/line  (" << setprecision(1)
+         << syncUs / asyncUs << "x; " << stats.written << " written in " << stats.batches << " write() calls, "
+         << stats.dropped << " dropped, " << setprecision(0) << drainUs / 1000 << " ms to drain at stop)" << endl
+         << "binary    " << setw(8) << binaryUs * 1000 / lines << " ns/line  (" << setprecision(1)
+         << syncUs / binaryUs << "x; " << binaryBytes << " bytes/line, " << textBytes / binaryBytes
+         << "x smaller)" << endl;
+    if (decoded != (unsigned long)lines) {
+        cout << "[ERROR] " << decoded << " of " << lines << " binary records decoded" << endl;
+        return 1;
+    }
+    if (stats.written + stats.dropped != (unsigned long)lines) {
+        cout << "[ERROR] " << lines - stats.written - stats.dropped << " records unaccounted for" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,190 @@
+// Calla Chen
+// Benchmark for command parsing: stringstream tokenizing vs the in-place tokenizer and perfect-hash dispatch
+//
+// Parses the same generated session (mostly RQ/RL lines, plus aliases and other commands) two ways. The old path is
+// what CommandHandler::process used to do: copy and trim the line, split it into a vector<string> with a stringstream,
+// resolve aliases through a map, walk a chain of string comparisons, and read RQ/RL amounts with a second stringstream.
+// The new path tokenizes in place with CommandParser, looks the command up in one hash probe and parses the amounts
+// strictly into a reused buffer. Both must agree on every line. Heap allocations are counted by replacing operator new.
+// Build and run with: make bench-parse
+//
+// Usage: bench_parse [resources] [lines] [passes]
+#include "command_parser.h"
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <new>
+#include <cstdio>
+#include <cstdlib>
+#include <time.h>
+
+using namespace std;
+
+// Every operator new in the process goes through here, so a pass can report how often it hit the heap.
+// Kept out of line so the compiler does not pair the inlined malloc()/free() with new/delete expressions.
+static unsigned long allocations = 0;
+
+__attribute__((noinline)) void* operator new(size_t size) throw(std::bad_alloc) {
+    ++allocations;
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+__attribute__((noinline)) void operator delete(void* p) throw() {
+    free(p);
+}
+
+static double nowNanos() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Canonical names in CommandId order, so a position in this chain plus one is the id
+static const char* chain[] = {
+    "*", "RQ", "RQB", "RL", "safety", "engine", "log", "binlog", "custlog", "journal", "reset", "report", "explain",
+    "preview", "preview-file", "snapshot", "undo", "redo", "test", "replay", "history", "recap", "help", "summary", "verbose",
+    "color", "heatmap", "exit", "save", "load", "savepoint", "savepoints", "compare", "diff", "rollback"
+};
+static const int chainLength = sizeof(chain) / sizeof(chain[0]);
+
+static map<string, string> makeAliases() {
+    map<string, string> m;
+    m["req"] = "RQ"; m["rq"] = "RQ"; m["rqb"] = "RQB"; m["rel"] = "RL"; m["rl"] = "RL";
+    m["rep"] = "report"; m["sum"] = "summary"; m["xpl"] = "explain"; m["hist"] = "history";
+    m["snap"] = "snapshot"; m["undo!"] = "undo"; m["v"] = "verbose"; m["c"] = "color";
+    m["sp"] = "savepoint"; m["rb"] = "rollback"; m["q"] = "exit"; m["hm"] = "heatmap";
+    m["pre"] = "preview"; m["pf"] = "preview-file"; m["cmp"] = "compare"; m["df"] = "diff";
+    return m;
+}
+
+// Folds one parsed line into a checksum both paths must reproduce
+static unsigned long mix(unsigned long sum, long value) {
+    return sum * 1000003UL ^ (unsigned long)value;
+}
+
+// The old way, as process() did it before the dispatch table
+static unsigned long parseOld(const vector<string>& lines, int m, const map<string, string>& aliases) {
+    unsigned long sum = 0;
+    for (size_t k = 0; k < lines.size(); ++k) {
+        string trimmed = lines[k];
+        trimmed.erase(0, trimmed.find_first_not_of(" \t\r\n"));
+        trimmed.erase(trimmed.find_last_not_of(" \t\r\n") + 1);
+        stringstream iss(trimmed);
+        vector<string> parts;
+        string token;
+        while (iss >> token) parts.push_back(token);
+        if (parts.empty()) continue;
+
+        map<string, string>::const_iterator it = aliases.find(parts[0]);
+        string cmd = (it != aliases.end()) ? it->second : parts[0];
+        int id = 0;
+        for (int c = 0; c < chainLength && !id; ++c)
+            if (cmd == chain[c]) id = c + 1;
+        sum = mix(sum, id);
+
+        if (id == CommandParser::CMD_RQ || id == CommandParser::CMD_RL) {
+            int cust = -1;
+            vector<int> amounts(m, -1);
+            stringstream ss(trimmed.substr(parts[0].size()));
+            ss >> cust;
+            for (int j = 0; j < m; ++j) ss >> amounts[j];
+            sum = mix(sum, cust);
+            for (int j = 0; j < m; ++j) sum = mix(sum, amounts[j]);
+        }
+    }
+    return sum;
+}
+
+// The new way: spans, one hash probe, strict integers into a reused buffer
+static unsigned long parseNew(const vector<string>& lines, int m, vector<int>& amounts) {
+    unsigned long sum = 0;
+    for (size_t k = 0; k < lines.size(); ++k) {
+        const char* begin = lines[k].c_str();
+        const char* end = begin + lines[k].size();
+        CommandParser::Tokenizer tokens(begin, end);
+        CommandParser::Token word;
+        if (!tokens.next(word)) continue;
+        CommandParser::CommandId id = CommandParser::lookup(word.text, word.length);
+        sum = mix(sum, id);
+
+        if (id == CommandParser::CMD_RQ || id == CommandParser::CMD_RL) {
+            int cust = -1;
+            CommandParser::Token token;
+            if (tokens.nextInt(cust, token) != CommandParser::INT_OK) cust = -1;
+            for (int j = 0; j < m; ++j)
+                if (tokens.nextInt(amounts[j], token) != CommandParser::INT_OK) amounts[j] = -1;
+            sum = mix(sum, cust);
+            for (int j = 0; j < m; ++j) sum = mix(sum, amounts[j]);
+        }
+    }
+    return sum;
+}
+
+int main(int argc, char* argv[]) {
+    int m = argc > 1 ? atoi(argv[1]) : 16;
+    int count = argc > 2 ? atoi(argv[2]) : 200000;
+    int passes = argc > 3 ? atoi(argv[3]) : 5;
+    if (m <= 0 || count <= 0 || passes <= 0) {
+        cerr << "Usage: " << argv[0] << " [resources] [lines] [passes]" << endl;
+        return 1;
+    }
+
+    // A session of mostly well-formed requests and releases, with some aliases and other commands mixed in
+    static const char* others[] = { "*", "summary", "sum", "hm", "undo 2", "redo", "snap", "safety", "history",
+                                    "preview 1 0 1", "savepoint before", "rb before", "help RQ" };
+    srand(5);
+    vector<string> lines(count);
+    for (int k = 0; k < count; ++k) {
+        int kind = rand() % 10;
+        if (kind >= 9) {
+            lines[k] = others[rand() % (sizeof(others) / sizeof(others[0]))];
+            continue;
+        }
+        stringstream line;
+        line << (kind < 6 ? "RQ" : kind < 7 ? "req" : kind < 8 ? "RL" : "rel") << ' ' << rand() % 1000;
+        for (int j = 0; j < m; ++j) line << ' ' << rand() % 10;
+        lines[k] = line.str();
+    }
+    map<string, string> aliases = makeAliases();
+    vector<int> amounts(m);
+
+    double bestOld = 0, bestNew = 0;
+    unsigned long oldAllocs = 0, newAllocs = 0;
+    for (int pass = 0; pass < passes; ++pass) {
+        unsigned long before = allocations;
+        double start = nowNanos();
+        unsigned long oldSum = parseOld(lines, m, aliases);
+        double took = nowNanos() - start;
+        oldAllocs = allocations - before;
+        if (pass == 0 || took < bestOld) bestOld = took;
+
+        before = allocations;
+        start = nowNanos();
+        unsigned long newSum = parseNew(lines, m, amounts);
+        took = nowNanos() - start;
+        newAllocs = allocations - before;
+        if (pass == 0 || took < bestNew) bestNew = took;
+
+        if (oldSum != newSum) {
+            cerr << "FAIL: the two parsers disagree (pass " << pass << ")" << endl;
+            return 1;
+        }
+    }
+
+    cout << "Parsing " << count << " lines, " << m << " resources, best of " << passes << " passes"
+         << " (perfect hash seed " << CommandParser::tableSeed() << "):\n"
+         << "parser                        ns/line      lines/s   allocations/line\n"
+         << fixed << setprecision(1)
+         << "stringstream + map + chain" << setw(12) << bestOld / count << setw(13) << setprecision(0)
+         << count / (bestOld / 1e9) << setw(19) << setprecision(2) << (double)oldAllocs / count << "\n"
+         << setprecision(1)
+         << "in place + perfect hash   " << setw(12) << bestNew / count << setw(13) << setprecision(0)
+         << count / (bestNew / 1e9) << setw(19) << setprecision(2) << (double)newAllocs / count << "\n"
+         << setprecision(1) << "speedup: " << bestOld / bestNew << "x\n";
+    return 0;
+}
@@ -0,0 +1,113 @@
+// Calla Chen
+// Benchmark for Banker::previewMany() (the preview-file command) against one previewRequest() per candidate
+//
+// Builds a random state with most of the resources handed out, then previews the same set of candidate requests
+// serially and with previewMany() on 1 to the given number of threads. Every verdict and safe sequence must match
+// the serial ones. Build and run with: make bench-preview
+//
+// Usage: bench_preview [customers] [resources] [candidates] [max threads]
+#include "banker.h"
+#include "log_global.h"
+#include "thread_pool.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <sys/time.h>
+
+using namespace std;
+
+static double nowMicros() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 2000;
+    int m = argc > 2 ? atoi(argv[2]) : 8;
+    int count = argc > 3 ? atoi(argv[3]) : 20000;
+    int maxThreads = argc > 4 ? atoi(argv[4]) : 8;
+    if (n <= 0 || m <= 0 || count <= 0 || maxThreads <= 0) {
+        cerr << "Usage: " << argv[0] << " [customers] [resources] [candidates] [max threads]" << endl;
+        return 1;
+    }
+    initCustomerStats(n);
+
+    // Random max demands of 1-10 and enough units for everyone to hold about half of their claim
+    srand(7);
+    string path = "bench_preview_max.txt";
+    ofstream out(path.c_str());
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < m; ++j) out << (j ? "," : "") << 1 + rand() % 10;
+        out << "\n";
+    }
+    out.close();
+    Banker banker(n, m);
+    banker.loadMaximumFromFile(path);
+    remove(path.c_str());
+    vector<int> res(m, n * 3);
+    banker.setAvailable(&res[0]);
+
+    // Hand most of it out through ordinary requests (output silenced)
+    streambuf* console = cout.rdbuf();
+    ostringstream sink;
+    cout.rdbuf(sink.rdbuf());
+    vector<int> req(m);
+    for (int i = 0; i < n * 4; ++i) {
+        for (int j = 0; j < m; ++j) req[j] = rand() % 2;
+        banker.request(rand() % n, &req[0]);
+    }
+    cout.rdbuf(console);
+
+    vector<Banker::BatchRequest> candidates(count);
+    for (int k = 0; k < count; ++k) {
+        candidates[k].customer = rand() % n;
+        candidates[k].amounts.resize(m);
+        for (int j = 0; j < m; ++j) candidates[k].amounts[j] = rand() % 3;
+    }
+
+    Banker::StateSnapshot snap;
+    banker.readSnapshot(snap);
+    StateView view = snap.view();
+
+    // Serial reference: one previewRequest() per candidate
+    vector<int> serialVerdicts(count);
+    vector<vector<int> > serialSequences(count);
+    double start = nowMicros();
+    for (int k = 0; k < count; ++k)
+        serialVerdicts[k] = banker.previewRequest(view, candidates[k].customer, &candidates[k].amounts[0],
+                                                  serialSequences[k]);
+    double serialUs = nowMicros() - start;
+    int granted = 0;
+    for (int k = 0; k < count; ++k)
+        if (serialVerdicts[k] == Banker::GRANTED) ++granted;
+
+    cout << "Bulk preview: " << n << " customers x " << m << " resources, " << count << " candidates (" << granted
+         << " safe), " << ThreadPool::hardwareThreads() << " online CPUs" << endl;
+    cout << fixed << setprecision(0)
+         << "serial     " << setw(10) << count * 1e6 / serialUs << " candidates/s" << endl;
+
+    bool ok = true;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        ThreadPool pool(threads);
+        vector<int> verdicts;
+        vector<vector<int> > sequences;
+        start = nowMicros();
+        banker.previewMany(view, candidates, verdicts, sequences, pool);
+        double us = nowMicros() - start;
+        bool match = verdicts == serialVerdicts && sequences == serialSequences;
+        if (!match) ok = false;
+        cout << "parallel " << setw(2) << threads << setw(10) << count * 1e6 / us << " candidates/s  ("
+             << setprecision(2) << serialUs / us << "x serial)" << setprecision(0)
+             << (match ? "" : "  RESULT MISMATCH") << endl;
+    }
+    if (!ok) {
+        cout << "[ERROR] Parallel previews differ from the serial ones" << endl;
+        return 1;
+    }
+    return 0;
+}
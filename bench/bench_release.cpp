@@ -0,0 +1,147 @@
+// Calla Chen
+// Release throughput benchmark for ConcurrentBanker: exclusive-lock releases vs lock-free releases
+//
+// One thread keeps issuing requests for random customers while K release threads hand back single units of what
+// their own customers (i % K == thread id) hold. Release throughput is measured for both release modes; afterwards
+// the state must conserve every resource and still be safe. Build and run with: make bench-release
+//
+// Usage: bench_release [customers] [resources] [releases per thread] [max release threads]
+#include "concurrent_banker.h"
+#include "log_global.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <pthread.h>
+#include <sys/time.h>
+
+using namespace std;
+
+static double nowMicros() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+struct Releaser {
+    ConcurrentBanker* front;
+    int id;
+    int threads;
+    int ops;
+    long released;              // Releases that were applied (the rest found nothing held)
+    pthread_t thread;
+};
+
+struct Requester {
+    ConcurrentBanker* front;
+    volatile int* stop;
+    long requests;
+    pthread_t thread;
+};
+
+static void* runReleaser(void* arg) {
+    Releaser* r = (Releaser*)arg;
+    int n = r->front->getNumCustomers();
+    int m = r->front->getNumResources();
+    unsigned seed = 4321u + r->id;
+    vector<int> amounts(m, 0);
+    for (int op = 0; op < r->ops; ++op) {
+        int c = r->id + r->threads * (rand_r(&seed) % ((n - 1 - r->id) / r->threads + 1)); // One of our customers
+        int j = rand_r(&seed) % m;
+        amounts[j] = 1;
+        if (r->front->release(c, &amounts[0])) ++r->released;
+        amounts[j] = 0;
+    }
+    return NULL;
+}
+
+static void* runRequester(void* arg) {
+    Requester* q = (Requester*)arg;
+    int n = q->front->getNumCustomers();
+    int m = q->front->getNumResources();
+    unsigned seed = 99u;
+    vector<int> amounts(m);
+    while (!__atomic_load_n(q->stop, __ATOMIC_ACQUIRE)) {
+        for (int j = 0; j < m; ++j) amounts[j] = rand_r(&seed) % 3;
+        q->front->request(rand_r(&seed) % n, &amounts[0]);
+        ++q->requests;
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 64;
+    int m = argc > 2 ? atoi(argv[2]) : 8;
+    int ops = argc > 3 ? atoi(argv[3]) : 50000;
+    int maxThreads = argc > 4 ? atoi(argv[4]) : 8;
+    if (n <= 0 || m <= 0 || ops <= 0 || maxThreads <= 0 || maxThreads > n) {
+        cerr << "Usage: " << argv[0] << " [customers] [resources] [releases per thread] [max threads <= customers]"
+             << endl;
+        return 1;
+    }
+    initCustomerStats(n);
+
+    string path = "bench_release_max.txt";
+    srand(7);
+    ofstream out(path.c_str());
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < m; ++j) out << (j ? "," : "") << 1 + rand() % 10;
+        out << "\n";
+    }
+    out.close();
+    int avail = n * 2;
+
+    cout << "Releases alongside one request thread: " << n << " customers x " << m << " resources, " << ops
+         << " releases per thread" << endl;
+    cout << "threads      locked rel/s   lock-free rel/s" << endl;
+    bool ok = true;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        double rate[2];
+        for (int mode = 0; mode < 2; ++mode) {
+            Banker banker(n, m);
+            banker.loadMaximumFromFile(path);
+            vector<int> res(m, avail);
+            banker.setAvailable(&res[0]);
+            ConcurrentBanker front(banker, mode ? ConcurrentBanker::RELEASE_LOCK_FREE
+                                                : ConcurrentBanker::RELEASE_LOCKED);
+
+            volatile int stop = 0;
+            Requester requester = { &front, &stop, 0, pthread_t() };
+            pthread_create(&requester.thread, NULL, runRequester, &requester);
+
+            vector<Releaser> releasers(threads);
+            double start = nowMicros();
+            for (int t = 0; t < threads; ++t) {
+                Releaser r = { &front, t, threads, ops, 0, pthread_t() };
+                releasers[t] = r;
+                pthread_create(&releasers[t].thread, NULL, runReleaser, &releasers[t]);
+            }
+            for (int t = 0; t < threads; ++t) pthread_join(releasers[t].thread, NULL);
+            double elapsed = nowMicros() - start;
+            __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+            pthread_join(requester.thread, NULL);
+            rate[mode] = (double)threads * ops * 1e6 / elapsed;
+
+            // Every unit must be either available or allocated, and the final state must be safe
+            vector<int> available, allocation, need, sequence;
+            front.snapshotState(available, allocation, need);
+            for (int j = 0; j < m; ++j) {
+                long total = available[j];
+                for (int i = 0; i < n; ++i) total += allocation[(size_t)i * m + j];
+                if (total != avail) ok = false;
+            }
+            vector<int> zero(m, 0);
+            if (front.preview(0, &zero[0], sequence) != Banker::GRANTED) ok = false;
+        }
+        cout << setw(7) << threads << fixed << setprecision(0) << setw(18) << rate[0] << setw(18) << rate[1]
+             << "  (" << setprecision(2) << rate[1] / rate[0] << "x)" << endl;
+    }
+    remove(path.c_str());
+    if (!ok) {
+        cout << "[ERROR] A final state broke resource conservation or was unsafe" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+// Calla Chen
+// Scaling benchmark for the parallel safety engine (Safety::parallel in src/safety.cpp)
+//
+// For customer counts from 10^3 up to the given maximum (by powers of ten) it builds a random state, times the serial
+// classic and indexed engines, then the parallel engine from 1 to the given number of threads. Speedups are against
+// classic, which the parallel engine splits up. Every verdict and finished set must match. The state finishes in a
+// handful of passes, so classic stays near O(n * m) here. Build and run with: make bench-safety
+//
+// Usage: bench_safety [resources] [max customers] [max threads]
+#include "safety.h"
+#include "thread_pool.h"
+#include "kernels.h"
+#include "banker.h"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstdlib>
+#include <vector>
+#include <sys/time.h>
+
+using namespace std;
+
+static double nowMicros() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+typedef bool (*Engine)(const StateView&, vector<int>&, vector<bool>&, vector<int>*);
+
+// Times 'reps' checks with a serial engine; returns microseconds per check
+static double timeSerial(Engine engine, const StateView& view, int reps, bool& safe, vector<bool>& finish) {
+    vector<int> sequence;
+    double start = nowMicros();
+    for (int r = 0; r < reps; ++r) safe = engine(view, sequence, finish, 0);
+    return (nowMicros() - start) / reps;
+}
+
+int main(int argc, char* argv[]) {
+    int m = argc > 1 ? atoi(argv[1]) : 8;
+    long maxCustomers = argc > 2 ? atol(argv[2]) : 1000000;
+    int maxThreads = argc > 3 ? atoi(argv[3]) : 8;
+    if (m <= 0 || maxCustomers < 1000 || maxThreads <= 0) {
+        cerr << "Usage: " << argv[0] << " [resources] [max customers >= 1000] [max threads]" << endl;
+        return 1;
+    }
+    Kernels::init();
+    int stride = (m + BANKER_ROW_ALIGN - 1) / BANKER_ROW_ALIGN * BANKER_ROW_ALIGN;
+
+    cout << "Safety check scaling: " << m << " resources, " << ThreadPool::hardwareThreads() << " online CPUs ("
+         << Kernels::isaName(Kernels::activeIsa()) << " kernels)" << endl;
+    bool ok = true;
+    for (long n = 1000; n <= maxCustomers; n *= 10) {
+        // Random state: needs of 0-9, allocations of 0-2, and a small available pool so a check takes several rounds
+        srand(7);
+        vector<int> available(stride, 0), allocation((size_t)n * stride, 0), need((size_t)n * stride, 0);
+        for (int j = 0; j < m; ++j) available[j] = 4;
+        for (long i = 0; i < n; ++i)
+            for (int j = 0; j < m; ++j) {
+                need[(size_t)i * stride + j] = rand() % 10;
+                allocation[(size_t)i * stride + j] = rand() % 3;
+            }
+        StateView view(&available[0], &allocation[0], &need[0], (int)n, m, stride);
+        int reps = n >= 100000 ? 1 : (int)(100000 / n);
+
+        bool indexedSafe, classicSafe;
+        vector<bool> indexedFinish, classicFinish;
+        double classicUs = timeSerial(Safety::classic, view, reps, classicSafe, classicFinish);
+        double indexedUs = timeSerial(Safety::indexed, view, reps, indexedSafe, indexedFinish);
+        if (classicSafe != indexedSafe || classicFinish != indexedFinish) ok = false;
+        cout << setw(8) << n << " customers  classic " << fixed << setprecision(0) << setw(9) << classicUs
+             << " us  indexed " << setw(9) << indexedUs << " us  (" << (classicSafe ? "safe" : "unsafe") << ")"
+             << endl;
+
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            ThreadPool pool(threads);
+            vector<int> sequence;
+            vector<bool> finish;
+            bool safe = false;
+            double start = nowMicros();
+            for (int r = 0; r < reps; ++r) safe = Safety::parallel(view, sequence, finish, pool);
+            double us = (nowMicros() - start) / reps;
+            bool match = safe == classicSafe && finish == classicFinish;
+            if (!match) ok = false;
+            cout << "           parallel " << setw(2) << threads << " thread" << (threads == 1 ? " " : "s")
+                 << setw(9) << us << " us  (" << setprecision(2) << classicUs / us << "x classic)"
+                 << setprecision(0) << (match ? "" : "  VERDICT MISMATCH") << endl;
+        }
+    }
+    if (!ok) {
+        cout << "[ERROR] Engines disagree" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,235 @@
+// Calla Chen
+// Benchmark for the Sequencer (src/sequencer.cpp) against ConcurrentBanker's exclusive-lock requests
+//
+// Every producer thread owns the customers i with i % threads == thread id and mixes requests with releases of what
+// its customers hold, through ConcurrentBanker and then through a Sequencer. A third run sends requests only, through
+// Sequencer::requestAsync(), so producers never wait for a verdict. For the Sequencer runs it also prints the queue
+// depth, batch size and latency figures. While the blocking Sequencer run is going, a monitor thread keeps taking
+// published snapshots, each of which must conserve every resource. Afterwards the state must also be safe.
+// Build and run with: make bench-sequencer
+//
+// Usage: bench_sequencer [customers] [resources] [ops per thread] [max threads]
+#include "concurrent_banker.h"
+#include "sequencer.h"
+#include "log_global.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/time.h>
+
+using namespace std;
+
+static double nowMicros() {
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+struct Producer {
+    ConcurrentBanker* front;    // Exactly one of front/sequencer is set
+    Sequencer* sequencer;
+    int n, m;
+    int id;
+    int threads;
+    int ops;
+    long granted;
+    bool async;                 // Fire-and-forget requests through requestAsync()
+    pthread_t thread;
+};
+
+// Completion counter for async requests (callbacks run on the owner thread)
+static long asyncDone = 0;
+static long asyncGranted = 0;
+
+static void onVerdict(int result, void*) {
+    if (result == Banker::GRANTED) __atomic_add_fetch(&asyncGranted, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&asyncDone, 1, __ATOMIC_RELEASE);
+}
+
+static void* runProducer(void* arg) {
+    Producer* p = (Producer*)arg;
+    unsigned seed = 1234u + p->id;
+    vector<int> amounts(p->m), held((size_t)p->n * p->m, 0);
+
+    for (int op = 0; op < p->ops; ++op) {
+        int c = p->id + p->threads * (rand_r(&seed) % ((p->n - 1 - p->id) / p->threads + 1)); // One of our customers
+        int* row = &held[(size_t)c * p->m];
+        if (p->async) {
+            for (int j = 0; j < p->m; ++j) amounts[j] = rand_r(&seed) % 3;
+            p->sequencer->requestAsync(c, &amounts[0], onVerdict, NULL);
+        } else if (rand_r(&seed) % 10 < 7) {
+            for (int j = 0; j < p->m; ++j) amounts[j] = rand_r(&seed) % 3;
+            int result = p->front ? p->front->request(c, &amounts[0]) : p->sequencer->request(c, &amounts[0]);
+            if (result == Banker::GRANTED) {
+                ++p->granted;
+                for (int j = 0; j < p->m; ++j) row[j] += amounts[j];
+            }
+        } else {
+            bool released = p->front ? p->front->release(c, row) : p->sequencer->release(c, row);
+            if (released)
+                for (int j = 0; j < p->m; ++j) row[j] = 0;
+        }
+    }
+    return NULL;
+}
+
+// Takes published snapshots until told to stop, counting any that break conservation
+struct Monitor {
+    Sequencer* sequencer;
+    int avail;
+    volatile int stop;
+    long snapshots;
+    long broken;
+    pthread_t thread;
+};
+
+static void* runMonitor(void* arg) {
+    Monitor* mon = (Monitor*)arg;
+    Banker::StateSnapshot snap;
+    while (!__atomic_load_n(&mon->stop, __ATOMIC_ACQUIRE)) {
+        mon->sequencer->snapshot(snap);
+        StateView view = snap.view();
+        for (int j = 0; j < view.numResources; ++j) {
+            long total = view.available[j];
+            for (int i = 0; i < view.numCustomers; ++i) total += view.allocationRow(i)[j];
+            if (total != mon->avail) { ++mon->broken; break; }
+        }
+        ++mon->snapshots;
+        sched_yield();
+    }
+    return NULL;
+}
+
+// Runs 'threads' producers against whichever front is set; returns ops per second
+static double runProducers(ConcurrentBanker* front, Sequencer* sequencer, int n, int m, int threads, int ops,
+                           bool async, long& granted) {
+    vector<Producer> producers(threads);
+    __atomic_store_n(&asyncDone, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&asyncGranted, 0, __ATOMIC_RELAXED);
+    double start = nowMicros();
+    for (int t = 0; t < threads; ++t) {
+        Producer p = { front, sequencer, n, m, t, threads, ops, 0, async, pthread_t() };
+        producers[t] = p;
+        pthread_create(&producers[t].thread, NULL, runProducer, &producers[t]);
+    }
+    granted = 0;
+    for (int t = 0; t < threads; ++t) {
+        pthread_join(producers[t].thread, NULL);
+        granted += producers[t].granted;
+    }
+    while (async && __atomic_load_n(&asyncDone, __ATOMIC_ACQUIRE) < (long)threads * ops)
+        sched_yield(); // Wait for the owner to decide everything queued
+    if (async) granted = asyncGranted;
+    return (double)threads * ops * 1e6 / (nowMicros() - start);
+}
+
+// Every unit is either available or allocated, and the state is safe
+static bool checkState(Banker& banker, int avail) {
+    StateView view = banker.currentView();
+    for (int j = 0; j < view.numResources; ++j) {
+        long total = view.available[j];
+        for (int i = 0; i < view.numCustomers; ++i) total += view.allocationRow(i)[j];
+        if (total != avail) return false;
+    }
+    vector<int> sequence;
+    vector<bool> finish;
+    return banker.evaluateSafety(view, sequence, finish);
+}
+
+static void printStats(const char* label, const Sequencer::Stats& s) {
+    cout << "    " << setw(9) << left << label << right << " batch " << fixed << setprecision(2) << s.meanBatch
+         << " avg / " << s.maxBatch << " max, depth " << s.meanDepth << " avg / " << s.maxDepth << " max, "
+         << s.safetyChecks << " safety checks for " << s.requests << " requests; latency p50 " << setprecision(0)
+         << s.p50Us << " us, p90 " << s.p90Us << " us, p99 " << s.p99Us << " us, max " << s.maxUs << " us" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 64;
+    int m = argc > 2 ? atoi(argv[2]) : 8;
+    int ops = argc > 3 ? atoi(argv[3]) : 20000;
+    int maxThreads = argc > 4 ? atoi(argv[4]) : 8;
+    if (n <= 0 || m <= 0 || ops <= 0 || maxThreads <= 0 || maxThreads > n) {
+        cerr << "Usage: " << argv[0] << " [customers] [resources] [ops per thread] [max threads <= customers]" << endl;
+        return 1;
+    }
+    initCustomerStats(n);
+
+    string path = "bench_sequencer_max.txt";
+    srand(7);
+    ofstream out(path.c_str());
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < m; ++j) out << (j ? "," : "") << 1 + rand() % 10;
+        out << "\n";
+    }
+    out.close();
+    int avail = n * 2;
+    vector<int> res(m, avail);
+
+    cout << "Sequencer vs ConcurrentBanker: " << n << " customers x " << m << " resources, " << ops
+         << " ops per thread" << endl;
+    bool ok = true;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        long lockedGranted, seqGranted, asyncGrantedTotal;
+        double locked, sequenced, async;
+        Sequencer::Stats s, a;
+        long snapshots, brokenSnapshots;
+        {
+            Banker banker(n, m);
+            banker.loadMaximumFromFile(path);
+            banker.setAvailable(&res[0]);
+            {
+                ConcurrentBanker front(banker);
+                locked = runProducers(&front, NULL, n, m, threads, ops, false, lockedGranted);
+            }
+            if (!checkState(banker, avail)) ok = false;
+        }
+        {
+            Banker banker(n, m);
+            banker.loadMaximumFromFile(path);
+            banker.setAvailable(&res[0]);
+            Sequencer sequencer(banker);
+            sequencer.start();
+            Monitor mon = { &sequencer, avail, 0, 0, 0, pthread_t() };
+            pthread_create(&mon.thread, NULL, runMonitor, &mon);
+            sequenced = runProducers(NULL, &sequencer, n, m, threads, ops, false, seqGranted);
+            __atomic_store_n(&mon.stop, 1, __ATOMIC_RELEASE);
+            pthread_join(mon.thread, NULL);
+            sequencer.stop();
+            snapshots = mon.snapshots;
+            brokenSnapshots = mon.broken;
+            if (brokenSnapshots) ok = false;
+            s = sequencer.stats();
+            if (!checkState(banker, avail)) ok = false;
+        }
+        {
+            Banker banker(n, m);
+            banker.loadMaximumFromFile(path);
+            banker.setAvailable(&res[0]);
+            Sequencer sequencer(banker);
+            sequencer.start();
+            async = runProducers(NULL, &sequencer, n, m, threads, ops, true, asyncGrantedTotal);
+            sequencer.stop();
+            a = sequencer.stats();
+            if (!checkState(banker, avail)) ok = false;
+        }
+
+        cout << setw(2) << threads << " thread" << (threads == 1 ? " " : "s") << fixed << setprecision(0)
+             << "  locked " << setw(9) << locked << " ops/s   sequencer " << setw(9) << sequenced << " ops/s  ("
+             << setprecision(2) << sequenced / locked << "x)   async requests " << setprecision(0) << setw(9)
+             << async << " req/s" << endl;
+        printStats("sequencer", s);
+        cout << "    monitor   " << snapshots << " published snapshots, " << brokenSnapshots << " inconsistent" << endl;
+        printStats("async", a);
+    }
+    remove(path.c_str());
+    if (!ok) {
+        cout << "[ERROR] A final state broke resource conservation or was unsafe" << endl;
+        return 1;
+    }
+    return 0;
+}
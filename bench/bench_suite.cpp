@@ -0,0 +1,290 @@
+// Calla Chen
+// Benchmark suite: the core Banker operations and command parsing over a grid of sizes and allocation densities
+//
+// For every customer count (100 up to the given maximum, by powers of ten), resource count (4 up to the given maximum,
+// by powers of four) and density (the share of each maximum claim already allocated), it builds a random state and
+// times request(), release(), both safety engines, simulateSequence(), savepoint()/rollback(), saveState()/loadState()
+// and CommandHandler::process on RQ/RL lines. Every call is timed on its own, up to the given number of samples or a
+// quarter of a second per operation, whichever comes first. Results go to a CSV file and a JSON file (ns/op, ops/s and
+// latency percentiles) so they can be compared from run to run. Build and run with: make bench
+//
+// Usage: bench_suite [max customers] [max resources] [samples per operation] [csv file] [json file]
+#include "banker.h"
+#include "command_handler.h"
+#include "kernels.h"
+#include "log_global.h"
+#include "safety.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <time.h>
+#include <unistd.h>
+
+using namespace std;
+
+#define SUITE_BUDGET_NS 250000000.0     // Time spent on one operation in one configuration at most
+#define SUITE_MIN_SAMPLES 5             // ... unless fewer samples than this were taken
+
+static double nowNanos() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// One operation in one configuration
+struct Result {
+    string operation;
+    int customers, resources;
+    double density;
+    long samples;
+    double meanNs, p50Ns, p90Ns, p99Ns, maxNs;
+};
+
+// Collects per-call latencies for one operation
+class Samples {
+public:
+    Samples(int limit) : limit(limit), started(nowNanos()) { times.reserve(limit); }
+
+    bool more() const {
+        return (long)times.size() < limit
+               && ((long)times.size() < SUITE_MIN_SAMPLES || nowNanos() - started < SUITE_BUDGET_NS);
+    }
+    void add(double nanos) { times.push_back(nanos); }
+
+    Result result(const string& operation, int n, int m, double density) {
+        Result r;
+        r.operation = operation;
+        r.customers = n;
+        r.resources = m;
+        r.density = density;
+        r.samples = times.size();
+        r.meanNs = r.p50Ns = r.p90Ns = r.p99Ns = r.maxNs = 0;
+        if (times.empty()) return r;
+        sort(times.begin(), times.end());
+        double total = 0;
+        for (size_t k = 0; k < times.size(); ++k) total += times[k];
+        size_t last = times.size() - 1;
+        r.meanNs = total / times.size();
+        r.p50Ns = times[last * 50 / 100];
+        r.p90Ns = times[last * 90 / 100];
+        r.p99Ns = times[last * 99 / 100];
+        r.maxNs = times[last];
+        return r;
+    }
+
+private:
+    long limit;
+    double started;
+    vector<double> times;
+};
+
+// Random claims of 1-10 per resource, 'density' of each already allocated, and n * (1 - density) + 1 units of every
+// resource left available so the state stays safe
+static void setUp(Banker& banker, vector<int>& maximum, const string& path, int n, int m, double density) {
+    if (banker.isSafeSequenceEnabled()) banker.toggleSafeSequence();  // Time the decision, not the [SAFE] line
+    srand(11);
+    maximum.assign((size_t)n * m, 0);
+    ofstream out(path.c_str());
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < m; ++j) {
+            maximum[(size_t)i * m + j] = 1 + rand() % 10;
+            out << (j ? "," : "") << maximum[(size_t)i * m + j];
+        }
+        out << "\n";
+    }
+    out.close();
+    banker.loadMaximumFromFile(path);
+
+    vector<int> held((size_t)n * m), total(m, (int)(n * (1 - density)) + 1);
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < m; ++j) {
+            held[(size_t)i * m + j] = (int)(maximum[(size_t)i * m + j] * density);
+            total[j] += held[(size_t)i * m + j];
+        }
+    banker.setAvailable(&total[0]);
+    for (int i = 0; i < n; ++i) banker.replayRequest(i, &held[(size_t)i * m]);
+}
+
+// A random request of 0 or 1 units per resource, within the customer's remaining need
+static void makeRequest(const Banker& banker, const vector<int>& maximum, int customer, int m, vector<int>& amounts) {
+    const int* held = banker.getAllocation() + (size_t)customer * banker.getRowStride();
+    amounts.resize(m);
+    for (int j = 0; j < m; ++j)
+        amounts[j] = min(rand() % 2, maximum[(size_t)customer * m + j] - held[j]);
+}
+
+static void runConfig(int n, int m, double density, int limit, vector<Result>& results) {
+    string maxPath = "bench_suite_max.txt", statePath = "bench_suite_state.txt";
+    Banker banker(n, m);
+    vector<int> maximum, amounts;
+    setUp(banker, maximum, maxPath, n, m, density);
+    initCustomerStats(n);
+
+    // request() and release(): every granted request is released again so the state stays put
+    Samples requests(limit), releases(limit);
+    while (requests.more()) {
+        int c = rand() % n;
+        makeRequest(banker, maximum, c, m, amounts);
+        double start = nowNanos();
+        int verdict = banker.request(c, &amounts[0]);
+        requests.add(nowNanos() - start);
+        if (verdict == Banker::GRANTED) {
+            start = nowNanos();
+            banker.release(c, &amounts[0]);
+            releases.add(nowNanos() - start);
+        }
+    }
+    results.push_back(requests.result("request", n, m, density));
+    results.push_back(releases.result("release", n, m, density));
+
+    // The safety check itself, on the live state
+    vector<int> sequence;
+    vector<bool> finish;
+    Samples classic(limit), indexed(limit);
+    while (classic.more()) {
+        double start = nowNanos();
+        Safety::classic(banker.currentView(), sequence, finish);
+        classic.add(nowNanos() - start);
+    }
+    while (indexed.more()) {
+        double start = nowNanos();
+        Safety::indexed(banker.currentView(), sequence, finish);
+        indexed.add(nowNanos() - start);
+    }
+    results.push_back(classic.result("is_safe_classic", n, m, density));
+    results.push_back(indexed.result("is_safe_indexed", n, m, density));
+
+    Samples simulate(limit);
+    while (simulate.more()) {
+        int c = rand() % n;
+        makeRequest(banker, maximum, c, m, amounts);
+        double start = nowNanos();
+        banker.simulateSequence(banker.currentView(), c, &amounts[0]);
+        simulate.add(nowNanos() - start);
+    }
+    results.push_back(simulate.result("simulate_sequence", n, m, density));
+
+    // A savepoint after one small change (sharing unchanged blocks with the previous one), then a rollback to it
+    Samples savepoints(limit), rollbacks(limit);
+    banker.savepoint("base");
+    while (savepoints.more()) {
+        int c = rand() % n;
+        makeRequest(banker, maximum, c, m, amounts);
+        bool granted = banker.request(c, &amounts[0]) == Banker::GRANTED;
+        double start = nowNanos();
+        banker.savepoint("bench");
+        savepoints.add(nowNanos() - start);
+        if (granted) banker.release(c, &amounts[0]);
+        start = nowNanos();
+        banker.rollback("bench");
+        rollbacks.add(nowNanos() - start);
+        banker.rollback("base");
+    }
+    results.push_back(savepoints.result("savepoint", n, m, density));
+    results.push_back(rollbacks.result("rollback", n, m, density));
+
+    Samples saves(limit), loads(limit);
+    while (saves.more()) {
+        double start = nowNanos();
+        banker.saveState(statePath);
+        saves.add(nowNanos() - start);
+        start = nowNanos();
+        banker.loadState(statePath);
+        loads.add(nowNanos() - start);
+    }
+    results.push_back(saves.result("save_state", n, m, density));
+    results.push_back(loads.result("load_state", n, m, density));
+
+    // Full command path: parse, validate, decide, record
+    Samples rqLines(limit), rlLines(limit);
+    while (rqLines.more()) {
+        int c = rand() % n;
+        makeRequest(banker, maximum, c, m, amounts);
+        stringstream line;
+        line << "RQ " << c;
+        for (int j = 0; j < m; ++j) line << ' ' << amounts[j];
+        string rq = line.str(), rl = "RL" + rq.substr(2);
+        double start = nowNanos();
+        CommandHandler::Result r = CommandHandler::process(rq, banker);
+        rqLines.add(nowNanos() - start);
+        if (!r.wasDenied) {
+            start = nowNanos();
+            CommandHandler::process(rl, banker);
+            rlLines.add(nowNanos() - start);
+        }
+    }
+    results.push_back(rqLines.result("process_rq", n, m, density));
+    results.push_back(rlLines.result("process_rl", n, m, density));
+
+    remove(maxPath.c_str());
+    remove(statePath.c_str());
+}
+
+int main(int argc, char* argv[]) {
+    int maxCustomers = argc > 1 ? atoi(argv[1]) : 10000;
+    int maxResources = argc > 2 ? atoi(argv[2]) : 64;
+    int limit = argc > 3 ? atoi(argv[3]) : 2000;
+    string csvPath = argc > 4 ? argv[4] : "bench_results.csv";
+    string jsonPath = argc > 5 ? argv[5] : "bench_results.json";
+    if (maxCustomers < 100 || maxResources < 4 || limit < SUITE_MIN_SAMPLES) {
+        cerr << "Usage: " << argv[0] << " [max customers >= 100] [max resources >= 4] [samples per operation >= "
+             << SUITE_MIN_SAMPLES << "] [csv file] [json file]" << endl;
+        return 1;
+    }
+    Kernels::init();
+    const double densities[] = { 0.25, 0.75 };
+
+    // Silence the per-command output while timing
+    streambuf* console = cout.rdbuf();
+    ostringstream sink;
+
+    vector<Result> results;
+    for (int n = 100; n <= maxCustomers; n *= 10)
+        for (int m = 4; m <= maxResources; m *= 4)
+            for (int d = 0; d < 2; ++d) {
+                cerr << "[BENCH] " << n << " customers x " << m << " resources, density " << densities[d] << endl;
+                cout.rdbuf(sink.rdbuf());
+                runConfig(n, m, densities[d], limit, results);
+                cout.rdbuf(console);
+                sink.str("");
+            }
+    rmdir("logs"); // Created by the logging globals; only removed if empty
+
+    time_t now = time(NULL);
+    char stamp[32];
+    strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+    ofstream csv(csvPath.c_str());
+    csv << "operation,customers,resources,density,samples,ns_per_op,ops_per_sec,p50_ns,p90_ns,p99_ns,max_ns\n";
+    ofstream json(jsonPath.c_str());
+    json << "{\n  \"timestamp\": \"" << stamp << "\",\n  \"kernels\": \"" << Kernels::isaName(Kernels::activeIsa())
+         << "\",\n  \"samples_per_operation\": " << limit << ",\n  \"results\": [\n";
+    cout << "operation           customers resources density  samples     ns/op        ops/s       p50       p99\n";
+    for (size_t k = 0; k < results.size(); ++k) {
+        const Result& r = results[k];
+        double opsPerSec = r.meanNs > 0 ? 1e9 / r.meanNs : 0;
+        csv << r.operation << ',' << r.customers << ',' << r.resources << ',' << setprecision(2) << r.density << ',' << r.samples << ','
+            << fixed << setprecision(1) << r.meanNs << ',' << opsPerSec << ',' << r.p50Ns << ',' << r.p90Ns << ','
+            << r.p99Ns << ',' << r.maxNs << '\n';
+        csv.unsetf(ios::fixed);
+        json << "    {\"operation\": \"" << r.operation << "\", \"customers\": " << r.customers
+             << ", \"resources\": " << r.resources << ", \"density\": " << setprecision(2) << r.density << ", \"samples\": " << r.samples
+             << fixed << setprecision(1) << ", \"ns_per_op\": " << r.meanNs << ", \"ops_per_sec\": " << opsPerSec
+             << ", \"p50_ns\": " << r.p50Ns << ", \"p90_ns\": " << r.p90Ns << ", \"p99_ns\": " << r.p99Ns
+             << ", \"max_ns\": " << r.maxNs << "}" << (k + 1 < results.size() ? "," : "") << "\n";
+        json.unsetf(ios::fixed);
+        cout << left << setw(20) << r.operation << right << setw(9) << r.customers << setw(10) << r.resources
+             << setw(8) << setprecision(2) << r.density << setw(9) << r.samples << fixed << setprecision(0)
+             << setw(10) << r.meanNs << setw(13) << opsPerSec << setw(10) << r.p50Ns << setw(10) << r.p99Ns << "\n";
+        cout.unsetf(ios::fixed);
+    }
+    json << "  ]\n}\n";
+    cout << "Wrote " << results.size() << " results to " << csvPath << " and " << jsonPath << "\n";
+    return 0;
+}
@@ -0,0 +1,165 @@
+// Calla Chen
+// Benchmark for request latency as the number of customers grows
+//
+// For each customer count, runs the same kind of workload (small random requests, with a customer releasing
+// everything it holds every few operations) through request() one at a time and through requestBatch() in batches.
+// Tentative grants only touch the requester's rows and Available: request() checks a tentative view without writing,
+// and a batch window that turns out unsafe is undone by releasing its grants again. The last column estimates what
+// copying the whole state in and out for every window (the old snapshot()/restore()) would add per request.
+// With plenty available nearly every request takes an O(m) fast path; a lower available percentage brings in full
+// safety checks, which are O(n * m) by nature. Build and run with: make bench-tentative
+//
+// Usage: bench_tentative [resources] [requests per size] [largest customer count] [available, % of customers]
+#include "banker.h"
+#include "log_global.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <time.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Nanosecond clock: the fast paths take well under a microsecond
+static double nowNanos() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Writes a random max demand file and loads it, with 'percent' units of every resource available per 100 customers
+static void setUp(Banker& banker, const string& path, int n, int m, int percent) {
+    if (banker.isSafeSequenceEnabled()) banker.toggleSafeSequence();  // Time the decision, not the [SAFE] line
+    srand(3);
+    ofstream out(path.c_str());
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < m; ++j) out << (j ? "," : "") << 1 + rand() % 10;
+        out << "\n";
+    }
+    out.close();
+    banker.loadMaximumFromFile(path);
+    vector<int> res(m, max(1, (int)((long)n * percent / 100)));
+    banker.setAvailable(&res[0]);
+}
+
+// One operation of the workload: a small request, or (every fourth) a release of everything a customer holds
+struct Op {
+    bool release;
+    Banker::BatchRequest request;
+};
+
+static void makeOps(vector<Op>& ops, int count, int n, int m) {
+    srand(17);
+    ops.resize(count);
+    for (int k = 0; k < count; ++k) {
+        ops[k].release = (k % 4 == 3);
+        ops[k].request.customer = rand() % n;
+        ops[k].request.amounts.resize(m);
+        for (int j = 0; j < m; ++j) ops[k].request.amounts[j] = rand() % 2;
+    }
+}
+
+static void releaseAll(Banker& banker, int customer, int m) {
+    const int* row = banker.getAllocation() + (size_t)customer * banker.getRowStride();
+    vector<int> held(row, row + m);
+    banker.release(customer, &held[0]);
+}
+
+int main(int argc, char* argv[]) {
+    int m = argc > 1 ? atoi(argv[1]) : 16;
+    int count = argc > 2 ? atoi(argv[2]) : 20000;
+    int largest = argc > 3 ? atoi(argv[3]) : 64000;
+    int percent = argc > 4 ? atoi(argv[4]) : 100;
+    if (m <= 0 || count <= 0 || largest < 250 || percent <= 0) {
+        cerr << "Usage: " << argv[0] << " [resources] [requests per size] [largest customer count (>= 250)]"
+             << " [available, % of customers]" << endl;
+        return 1;
+    }
+    const int batchSize = 32;
+    initCustomerStats(largest);
+
+    // Silence the per-request output while timing
+    streambuf* console = cout.rdbuf();
+    ostringstream sink;
+    cout.rdbuf(sink.rdbuf());
+
+    stringstream table;
+    table << "Request latency, " << m << " resources, " << count << " operations per size, " << percent
+          << "% as many units available as customers:\n"
+          << "customers   request() p50   request() mean   RQB per request   + full copy per window (est.)\n";
+    string path = "bench_tentative_max.txt";
+    for (int n = 250; n <= largest; n *= 4) {
+        vector<Op> ops;
+        makeOps(ops, count, n, m);
+
+        // One request() per request
+        Banker serial(n, m);
+        setUp(serial, path, n, m, percent);
+        vector<double> latency;
+        latency.reserve(count);
+        double serialNs = 0;
+        for (int k = 0; k < count; ++k) {
+            if (ops[k].release) {
+                releaseAll(serial, ops[k].request.customer, m);
+                continue;
+            }
+            double start = nowNanos();
+            serial.request(ops[k].request.customer, &ops[k].request.amounts[0]);
+            double took = nowNanos() - start;
+            latency.push_back(took);
+            serialNs += took;
+        }
+        sort(latency.begin(), latency.end());
+
+        // Runs of consecutive requests as batches
+        Banker batched(n, m);
+        setUp(batched, path, n, m, percent);
+        vector<Banker::BatchRequest> batch;
+        vector<int> verdicts;
+        double batchNs = 0;
+        long windows = 0;
+        for (int k = 0; k <= count; ++k) {
+            if (k < count && !ops[k].release && (int)batch.size() < batchSize) {
+                batch.push_back(ops[k].request);
+                continue;
+            }
+            if (!batch.empty()) {
+                double start = nowNanos();
+                windows += batched.requestBatch(batch, verdicts);
+                batchNs += nowNanos() - start;
+                batch.clear();
+            }
+            if (k < count && ops[k].release) releaseAll(batched, ops[k].request.customer, m);
+            else if (k < count) batch.push_back(ops[k].request);
+        }
+
+        // What snapshot() and restore() copied for every window: Available, allocation and need, both ways
+        size_t bytes = ((size_t)n * batched.getRowStride() * 2 + batched.getRowStride()) * sizeof(int);
+        vector<char> from(bytes, 1), to(bytes);
+        double start = nowNanos();
+        for (int r = 0; r < 10; ++r) {
+            memcpy(&to[0], &from[0], bytes);
+            memcpy(&from[0], &to[0], bytes);
+        }
+        double copyNs = (nowNanos() - start) / 10;
+
+        long requests = (long)latency.size();
+        table << fixed << setprecision(0)
+              << setw(9) << n << setw(13) << latency[latency.size() / 2] << " ns"
+              << setw(14) << serialNs / requests << " ns"
+              << setw(15) << batchNs / requests << " ns"
+              << setw(15) << windows * copyNs / requests << " ns (" << windows << " checked windows)\n";
+    }
+    remove(path.c_str());
+    rmdir("logs"); // Created by the logging globals; only removed if empty
+
+    cout.rdbuf(console);
+    cout << table.str();
+    return 0;
+}
@@ -3,32 +3,181 @@
 #include "banker.h"
 #include "logger.h"
 #include "log_global.h"
+#include "kernels.h"
+#include "binary_log.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include <set>
+#include <sys/time.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 using namespace std;
 /**
 * @brief Constructor for the Banker class.
 *
-* Initializing all resource matrices (allocation, maximum, need) and available resources arrays to zero. This sets up a
-* clean starting state for tbe Banker's Algorithm simulation.
+* Sizes every matrix for the given number of customers and resource types and initializes all of them (allocation,
+* maximum, need) and the available resources array to zero. This sets up a clean starting state for tbe Banker's
+* Algorithm simulation.
+*
+* Each matrix is one contiguous, cache-aligned buffer in row-major order. Rows are padded to 'rowStride' ints so that
+* every row starts on an aligned boundary; the padding columns stay zero.
+*
+* @param customers Number of customers (rows in the maximum file).
+* @param resources Number of resource types (available values on the command line).
 */
-Banker::Banker() {
+Banker::Banker(int customers, int resources)
+    : numCustomers(customers), numResources(resources),
+      rowStride((resources + BANKER_ROW_ALIGN - 1) / BANKER_ROW_ALIGN * BANKER_ROW_ALIGN) {
     // Initializing allocation, maximum, and need matrices to 0
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i)
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-            allocation[i][j] = 0;
-            maximum[i][j] = 0;
-            need[i][j] = 0;
-        }
-    // Initialize available resources vector to 0
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j)
-        available[j] = 0;
+    maximum = allocMatrix();
+    allocation = allocMatrix();
+    need = allocMatrix();
+    allocationSnapshot = allocMatrix();
+    needSnapshot = allocMatrix();
 
+    // Initialize available resources vector to 0
+    available = allocVector();
+    availableSnapshot = allocVector();
+    requestRow = allocVector();
+
+    writersActive = 0;
+    stateVersion = 0;
+
+    // Concurrent release buffers are only allocated by setConcurrentReleases()
+    concurrentReleases = false;
+    liveAvailable = NULL;
+    snapAllocation = NULL;
+    snapNeed = NULL;
+
+    showSafeSequence = true;            // Grants print their safe sequence until 'safety' turns it off
+    safeOrderValid = false;
+    safetyEngine = ENGINE_CLASSIC;
+    safetyThreads = 0;
+    safetyPool = NULL;
+    lastActiveCustomer = -1;
+    lastDenialHasReport = false;
     hasUndoSnapshot = false;
     hasSavepoint = false;
+
+    undoBudget = BANKER_UNDO_BUDGET;
+    undoTail = undoCursor = undoHead = 0;
+    undoUsed = redoUsed = 0;
+    undoCount = redoCount = 0;
+    undoFirstSeq = 0;
+    undoMarkSeq = -1;
+    undoEvicted = 0;
+}
+
+/**
+* @brief Destructor for the Banker class.
+*
+* Frees every aligned matrix and vector buffer allocated by the constructor.
+*/
+Banker::~Banker() {
+    free(maximum);
+    free(allocation);
+    free(need);
+    free(allocationSnapshot);
+    free(needSnapshot);
+    free(available);
+    free(availableSnapshot);
+    free(requestRow);
+    free(liveAvailable);
+    free(snapAllocation);
+    free(snapNeed);
+    delete safetyPool;
+    for (map<string, Savepoint>::iterator it = savepoints.begin(); it != savepoints.end(); ++it)
+        releaseSavepoint(it->second);
+}
+
+// Wall-clock microseconds, used to time the safety engines against each other
+static long currentMicros() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (long)tv.tv_sec * 1000000L + tv.tv_usec;
+}
+
+// Allocates a zeroed buffer of 'count' ints aligned to BANKER_CACHE_LINE
+static int* alignedBuffer(size_t count) {
+    void* mem = NULL;
+    size_t bytes = count * sizeof(int);
+    if (bytes == 0) bytes = BANKER_CACHE_LINE;
+    if (posix_memalign(&mem, BANKER_CACHE_LINE, bytes) != 0) {
+        cerr << "[FATAL] Out of memory allocating " << bytes << " bytes for Banker state\n";
+        exit(1);
+    }
+    memset(mem, 0, bytes);
+    return static_cast<int*>(mem);
+}
+
+int* Banker::allocVector() const {
+    return alignedBuffer(rowStride);
+}
+
+int* Banker::allocMatrix() const {
+    return alignedBuffer((size_t)numCustomers * rowStride);
+}
+
+void Banker::copyVector(int* dst, const int* src) const {
+    memcpy(dst, src, rowStride * sizeof(int));
+}
+
+void Banker::copyMatrix(int* dst, const int* src) const {
+    memcpy(dst, src, (size_t)numCustomers * rowStride * sizeof(int));
+}
+
+// Copies 'count' ints that other threads may be updating, one atomic load each; later reads are not hoisted above it
+static void copyAtomically(int* dst, const int* src, size_t count) {
+    for (size_t k = 0; k < count; ++k)
+        dst[k] = __atomic_load_n(&src[k], __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+/**
+* @brief Counts the customer rows in a maximum demand file.
+*
+* A row is any line that contains at least one digit; blank lines (and the trailing carriage returns left by Windows
+* editors) are ignored. This is used by main() to size the Banker before the matrix itself is loaded.
+*
+* @param filename Name of the file to scan.
+* @return Number of customer rows, or -1 if the file cannot be opened.
+*/
+int Banker::countDemandRows(const string& filename) {
+    ifstream infile(filename.c_str());
+    if (!infile) return -1; // File open failed
+
+    int rows = 0;
+    string line;
+    while (getline(infile, line)) {
+        for (size_t k = 0; k < line.size(); ++k) {
+            if (isdigit((unsigned char)line[k])) {
+                ++rows;
+                break;
+            }
+        }
+    }
+    return rows;
+}
+
+int Banker::getNumCustomers() const {
+    return numCustomers;
+}
+
+int Banker::getNumResources() const {
+    return numResources;
+}
+
+int Banker::getRowStride() const {
+    return rowStride;
 }
 
 /**
@@ -37,14 +186,18 @@ Banker::Banker() {
 * Copies the provided resource array into the 'available' array, which represents the count of unallocated resources
 * for each type.
 *
-* @param res Integer of size NUMBER_OF_RESOURCES containing the available units for each resource type.
+* @param res Integer of size getNumResources() containing the available units for each resource type.
 */
-void Banker::setAvailable(int res[]) {
+void Banker::setAvailable(const int res[]) {
     // Copy resource availability into internal array
-    for (int i = 0; i < NUMBER_OF_RESOURCES; ++i) {
+    beginWrite();
+    for (int i = 0; i < numResources; ++i) {
         available[i] = res[i];
         availableSnapshot[i] = res[i]; // Save snapshot for reset
     }
+    endWrite();
+    invalidateSafeOrder();
+    clearUndoHistory();
 }
 
 /**
@@ -63,25 +216,29 @@ bool Banker::loadMaximumFromFile(const string& filename) {
     if (!infile) return false; // File open failed
 
     string line;
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS && getline(infile, line); ++i) {
+    int i = 0;
+    WriteSection section(*this);
+    while (i < numCustomers && getline(infile, line)) {
+        if (line.find_first_of("0123456789") == string::npos) continue; // Skip blank lines
         stringstream ss(line);
         string token;
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
+        int* maxRow = maximum + (size_t)i * rowStride;
+        for (int j = 0; j < numResources; ++j) {
             if (!getline(ss, token, ',')) return false; // Malformed line
-            maximum[i][j] = atoi(token.c_str()); // Parse max demand
+            maxRow[j] = atoi(token.c_str()); // Parse max demand
         }
+        ++i;
     }
+    if (i < numCustomers) return false; // File shorter than the Banker was sized for
 
     calculateNeed(); // Recalculate need after loading maximum
+    invalidateSafeOrder();
 
     // Save initial state after max and need are calculated
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i)
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-            allocationSnapshot[i][j] = allocation[i][j]; // should be 0 at startup
-            needSnapshot[i][j] = need[i][j];
-        }
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j)
-        availableSnapshot[j] = available[j];
+    copyMatrix(allocationSnapshot, allocation); // should be 0 at startup
+    copyMatrix(needSnapshot, need);
+    copyVector(availableSnapshot, available);
+    clearUndoHistory();
 
     return true;
 }
@@ -94,218 +251,474 @@ bool Banker::loadMaximumFromFile(const string& filename) {
 * The result reflects on how many more units each customer may still request.
 */
 void Banker::calculateNeed() {
-    // Calculate need = maximum - allocation for each customer and resource
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i)
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j)
-            need[i][j] = maximum[i][j] - allocation[i][j];
+    // Calculate need = maximum - allocation for each customer and resource (padding stays 0 - 0)
+    WriteSection section(*this);
+    Kernels::subRows(need, maximum, allocation, (long)numCustomers * rowStride);
+}
+
+/**
+ * @brief View of the current state for the safety kernel.
+ */
+StateView Banker::currentView() const {
+    return StateView(available, allocation, need, numCustomers, numResources, rowStride);
 }
 
 /**
- * @brief Saves a backup of the current system state.
+ * @brief View of 'base' as if 'request' were granted to 'customerNum', without touching the matrices.
  *
- * Stores the current values of `available`, `allocation`, and `need` arrays so that they can be restored later in case
- * of unsafe allocation. This is used during tentative resource allocation.
+ * Only the available vector and the requester's two rows differ, so they are built in 'rows' (O(m)) and overlaid on
+ * the shared matrices.
  */
-void Banker::snapshot() {
-    // [CRITICAL SECTION START] Saving current system state (snapshot)
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j)
-        backupAvailable[j] = available[j];
-
-    // Save current allocation and needed matrices
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i)
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-            backupAllocation[i][j] = allocation[i][j];
-            backupNeed[i][j] = need[i][j];
-        }
-    // [CRITICAL SECTION END] Snapshot saved
+StateView Banker::tentativeView(const StateView& base, int customerNum, const int request[],
+                                 TentativeRows& rows) const {
+    const int* allocRow = base.allocationRow(customerNum);
+    const int* needRow = base.needRow(customerNum);
+    rows.available.assign(rowStride, 0);
+    rows.allocation.assign(rowStride, 0);
+    rows.need.assign(rowStride, 0);
+    for (int j = 0; j < numResources; ++j) {
+        rows.available[j] = base.available[j] - request[j];
+        rows.allocation[j] = allocRow[j] + request[j];
+        rows.need[j] = needRow[j] - request[j];
+    }
+
+    StateView view(&rows.available[0], base.allocation, base.need, numCustomers, numResources, rowStride);
+    view.overrideCustomer = customerNum;
+    view.overrideAllocation = &rows.allocation[0];
+    view.overrideNeed = &rows.need[0];
+    return view;
 }
 
 /**
-* @brief Saves a backup of the current system state.
-*
-* Stores the current values of 'available', 'allocation', and 'need' arrays so that they can be restored later in case
-* of unsafe allocation. This is used during tentative resource allocation.
-*/
-void Banker::restore() {
-    // [CRITICAL SECTION START] Restoring system state from snapshot
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j)
-        available[j] = backupAvailable[j];
-
-    // Restore allocation and need matrices from backup
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i)
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-            allocation[i][j] = backupAllocation[i][j];
-            need[i][j] = backupNeed[i][j];
-        }
-    // [CRITICAL SECTION END] Restore complete
+ * @brief Side-effect-free safety check with the selected engine (ENGINE_VERIFY uses the classic verdict).
+ *
+ * Safe to call from any number of threads at once as long as nothing writes the state behind the view.
+ */
+bool Banker::evaluateSafety(const StateView& view, vector<int>& sequence, vector<bool>& finish,
+                            vector<int>* finalWork) const {
+    if (safetyEngine == ENGINE_INDEXED)
+        return Safety::indexed(view, sequence, finish, finalWork);
+    if (safetyEngine == ENGINE_PARALLEL)
+        return Safety::parallel(view, sequence, finish, *safetyPool, finalWork);
+    return Safety::classic(view, sequence, finish, finalWork);
+}
+
+/**
+ * @brief Runs the currently selected safety engine over the given state.
+ *
+ * In ENGINE_VERIFY mode both engines run on the same state; a verdict mismatch is logged as an error and the classic
+ * result is returned. Timings for both are written to the full session log when verbose mode is on.
+ */
+bool Banker::runSafetyEngine(const StateView& view, vector<int>& sequence, vector<bool>& finish,
+                             vector<int>* finalWork) const {
+    if (safetyEngine != ENGINE_VERIFY)
+        return evaluateSafety(view, sequence, finish, finalWork);
+
+    // ENGINE_VERIFY: run both and cross-check the verdicts
+    vector<int> indexedSequence;
+    vector<bool> indexedFinish;
+    long startUs = currentMicros();
+    bool classicSafe = Safety::classic(view, sequence, finish, finalWork);
+    long classicUs = currentMicros() - startUs;
+    startUs = currentMicros();
+    bool indexedSafe = Safety::indexed(view, indexedSequence, indexedFinish);
+    long indexedUs = currentMicros() - startUs;
+
+    if (classicSafe != indexedSafe || finish != indexedFinish)
+        Logger::log("ENGINE → Verdict mismatch between classic and indexed safety checks", Logger::ERROR);
+    if (verboseMode)
+        fullLog << "[VERBOSE] Safety check: classic " << classicUs << " us ("
+                << (classicSafe ? "safe" : "unsafe") << "), indexed " << indexedUs << " us ("
+                << (indexedSafe ? "safe" : "unsafe") << ")\n";
+    return classicSafe;
 }
 
 /**
- * @brief Determines if the system is in a safe state.
+ * @brief Records an unsafe denial from request() without rendering anything.
  *
- * Implements the Banker's safety algorithm by simulating a sequence of process completions. The system is safe if for
- * all unfinished processes Pi, Need[i] <= Work, and their resources can eventually be released to allow others to
- * finish.
+ * Keeps the finish bitmap and final Work vector the safety check already produced (plus the request, in 'requestRow'),
+ * so the denial costs O(n + m) on top of the check. Records are rendered by flushDeadlockReports(), which runs before
+ * the next write to the matrices, so every buffered record still describes the current state.
  *
- * @return true if a safe sequence exists; false otherwise.
+ * @param customerNum The requester.
+ * @param finish Per customer, whether it could finish with the grant applied (as returned by the safety engine).
  */
-bool Banker::isSafe() {
-    int work[NUMBER_OF_RESOURCES];
-    bool finish[NUMBER_OF_CUSTOMERS] = { false };
-    int safeSequence[NUMBER_OF_CUSTOMERS];
-    int idx = 0;
-
-    // Step 1: Initialize Work = Available
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j)
-        work[j] = available[j];
-
-    bool progress = true;
-    while (progress) {
-        progress = false;
-
-        // Step 2. Find an unfinished customer i such that Need[i] <= Work
-        for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
-            if (!finish[i]) {
-                bool canFinish = true;
-                for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-                    if (need[i][j] > work[j]) {
-                        canFinish = false;
-                        break;
-                    }
-                }
-
-                // Step 3. If found, simulate completion: Work += Allocation[i]
-                if (canFinish) {
-                    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j)
-                        work[j] += allocation[i][j];
-                    finish[i] = true;
-                    safeSequence[idx++] = i;
-                    progress = true;
-                }
+void Banker::recordDeadlock(int customerNum, const vector<bool>& finish) {
+    globalStats.countDeadlock++;
+    if ((int)pendingDeadlocks.size() >= BANKER_DEADLOCK_PENDING_MAX)
+        flushDeadlockReports();
+
+    pendingDeadlocks.push_back(DeadlockRecord());
+    DeadlockRecord& record = pendingDeadlocks.back();
+    record.customer = customerNum;
+    record.request.assign(requestRow, requestRow + numResources);
+    record.finish = finish;
+    record.work = failureWork;
+    record.when = time(NULL);
+
+    int blocked = 0;
+    for (int i = 0; i < numCustomers; ++i)
+        if (!finish[i]) ++blocked;
+    if (BinaryLog::isOpen()) {
+        vector<int> blockedIds;
+        blockedIds.reserve(blocked);
+        for (int i = 0; i < numCustomers; ++i)
+            if (!finish[i]) blockedIds.push_back(i);
+        BinaryLog::record(BinaryLog::TYPE_DEADLOCK, customerNum, requestRow, numResources, blocked,
+                          blockedIds.empty() ? 0 : &blockedIds[0], blocked);
+    }
+    stringstream msg;
+    msg << "[DEADLOCK] No process can proceed — potential deadlock state (" << blocked << " customer"
+        << (blocked == 1 ? "" : "s") << " blocked; 'explain' shows why).\n";
+    cout << COLOR_RED << msg.str() << COLOR_RESET;
+    fullLog << msg.str();
+}
+
+/**
+ * @brief Renders one unsafe denial against the current matrices with the rejected grant applied.
+ *
+ * A blocked customer is explained by the resources it needs more of than the final Work vector holds; those
+ * resources are listed with the blocked customers holding them (finished customers already returned theirs).
+ *
+ * @param record The denial to render.
+ * @param csv If not null, receives the deadlock_log.csv lines for it.
+ * @return The diagnostics text shown by explain.
+ */
+string Banker::renderDeadlock(const DeadlockRecord& record, ostream* csv) const {
+    const vector<int>& work = record.work;
+    const vector<bool>& finish = record.finish;
+    stringstream out;
+
+    out << "[DEADLOCK] Granting P" << record.customer << " (";
+    for (int j = 0; j < numResources; ++j) out << (j ? " " : "") << record.request[j];
+    out << ") would leave no safe sequence.\n";
+    out << "Blocked customers: ";
+    for (int i = 0; i < numCustomers; ++i)
+        if (!finish[i]) out << "P" << i << " ";
+    out << "\n";
+
+    // Detailed Explanation: Why each process is blocked
+    vector<bool> shortResource(numResources, false);
+    for (int i = 0; i < numCustomers; ++i) {
+        if (finish[i]) continue;
+        const int* needRow = need + (size_t)i * rowStride;
+        out << "  - P" << i << " is blocked because it needs: ";
+        for (int j = 0; j < numResources; ++j) {
+            int needed = needRow[j] - (i == record.customer ? record.request[j] : 0);
+            if (needed > work[j]) {
+                out << "R" << j << "(" << needed << ") ";
+                shortResource[j] = true;
             }
         }
+        out << "\n";
     }
+    out << "Work once nobody else can finish:";
+    for (int j = 0; j < numResources; ++j) out << " " << work[j];
+    out << "\n";
 
-    // Step 4: Check if all customers are finished
-    bool deadlockDetected = false;
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
-        if (!finish[i]) {
-            deadlockDetected = true;
-            break;
+    // Shows who is holding each critical resource
+    out << "\nResource holders:\n";
+    for (int j = 0; j < numResources; ++j) {
+        if (!shortResource[j]) continue;
+        out << "  - R" << j << " held by: ";
+        for (int i = 0; i < numCustomers; ++i) {
+            int held = allocation[(size_t)i * rowStride + j] + (i == record.customer ? record.request[j] : 0);
+            if (!finish[i] && held > 0) out << "P" << i << "(" << held << ") ";
         }
+        out << "\n";
     }
 
-    if (deadlockDetected) {
-        globalStats.countDeadlock++;
-
-        cout << COLOR_RED << "[DEADLOCK] No process can proceed — potential deadlock state.\n";
-        cout << "Blocked customers: ";
-        fullLog << "[DEADLOCK] No process can proceed — potential deadlock state.\n";
-        fullLog << "Blocked customers: ";
-        for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
-            if (!finish[i]) {
-                cout << "P" << i << " ";
-                fullLog << "P" << i << " ";
-            }
-        }
-        cout << "\n";
-        fullLog << "\n";
-
-        // Detailed Explanation: Why each process is blocked
-        for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
-            if (!finish[i]) {
-                cout << COLOR_RED << "  - P" << i << " is blocked because it needs: ";
-                fullLog << "  - P" << i << " is blocked because it needs: ";
-                for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-                    if (need[i][j] > available[j]) {
-                        cout << COLOR_YELLOW << "R" << j << "(" << need[i][j] << ") " << COLOR_RED;
-                        fullLog << "R" << j << "(" << need[i][j] << ") ";
-                    }
-                }
-                cout << "\n";
-                fullLog << "\n";
+    if (csv) {
+        char stamp[32];
+        strftime(stamp, sizeof(stamp), "%a %b %d %H:%M:%S %Y", localtime(&record.when));
+        *csv << "[" << stamp << "] Blocked Customers,";
+        for (int i = 0; i < numCustomers; ++i)
+            if (!finish[i]) *csv << "P" << i << " ";
+        *csv << "\n";
+
+        // Log missing resource causes
+        for (int i = 0; i < numCustomers; ++i) {
+            if (finish[i]) continue;
+            const int* needRow = need + (size_t)i * rowStride;
+            *csv << "P" << i << " needs:";
+            for (int j = 0; j < numResources; ++j) {
+                int needed = needRow[j] - (i == record.customer ? record.request[j] : 0);
+                if (needed > work[j]) *csv << " R" << j << "(" << needed << ")";
             }
+            *csv << "\n";
         }
+    }
+    string text = out.str();
+    return text.substr(0, text.size() - 1);
+}
 
-        // Shows who is holding each critical resource
-        cout << "\nResource holders:\n";
-        fullLog << "\nResource holders:\n";
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-            if (available[j] == 0) {
-                cout << "  - R" << j << " held by: ";
-                fullLog << "  - R" << j << " held by: ";
-                for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
-                    if (allocation[i][j] > 0) {
-                        cout << "P" << i << "(" << allocation[i][j] << ") ";
-                        fullLog << "P" << i << "(" << allocation[i][j] << ") ";
-                    }
-                }
-                cout << "\n";
-                fullLog << "\n";
-            }
-        }
+/**
+ * @brief Writes out every buffered unsafe denial: deadlock_log.csv lines, explain's diagnostics and the automatic
+ * savepoint.
+ *
+ * Runs before the next write to the matrices (see beginWrite()), when explain or a savepoint lookup needs it, when the
+ * buffer is full, and at the end of the session. Only the last denial is rendered for explain and saved as
+ * "auto_P3_deadlock", which each denial used to overwrite anyway.
+ */
+void Banker::flushDeadlockReports() {
+    if (pendingDeadlocks.empty()) return;
+    vector<DeadlockRecord> records;
+    records.swap(pendingDeadlocks);
+
+    // Append to deadlock_log.csv
+    ofstream dlog("logs/deadlock_log.csv", ios::app);
+    for (size_t k = 0; k + 1 < records.size(); ++k)
+        if (dlog.is_open()) renderDeadlock(records[k], &dlog);
+    const DeadlockRecord& last = records.back();
+    lastDeadlockReport = renderDeadlock(last, dlog.is_open() ? &dlog : NULL);
+    dlog.close();
+
+    // Auto-savepoint of the rejected state: the current one with the last denied grant applied
+    string autoLabel = "auto_P3_deadlock";
+    savepoint(autoLabel);
+    Savepoint& saved = savepoints[autoLabel];
+    int* savedAlloc = writableSavedRow(saved, last.customer);
+    for (int j = 0; j < numResources; ++j) {
+        saved.available[j] -= last.request[j];
+        savedAlloc[j] += last.request[j];
+    }
+    Logger::log("SAVEPOINT → Automatically saved as \"" + autoLabel + "\" before deadlock exit", Logger::INFO);
+}
 
-        cout << COLOR_RESET;
+/**
+ * @brief Prints the first 'count' entries of a safe sequence if safe sequence display is enabled.
+ */
+void Banker::printSafeSequence(const vector<int>& safeSequence, int idx) const {
+    if (!showSafeSequence) return;
+
+    cout << "[SAFE] Safe sequence: ";
+    fullLog << "[SAFE] Safe sequence: ";
+    for (int i = 0; i < idx; ++i) {
+        cout << "P" << safeSequence[i] << (i < idx - 1 ? " → " : "");
+        fullLog << "P" << safeSequence[i] << (i < idx - 1 ? " → " : "");
+    }
+    cout << endl;
+    fullLog << endl;
+}
 
-        // Append to deadlock_log.csv
-        ofstream dlog("logs/deadlock_log.csv", ios::app);
-        if (dlog.is_open()) {
-            time_t now = time(NULL);
-            dlog << "[" << ctime(&now);
-            dlog.seekp(-1, ios::cur); // Remove trailing newline from ctime
-            dlog << "] Blocked Customers,";
+/**
+ * @brief Caches a safe sequence proven for the current state.
+ *
+ * Stores the order together with each customer's position in it, so a later request can find where the requester sits
+ * in O(1).
+ */
+void Banker::rememberSafeOrder(const vector<int>& sequence) {
+    for (size_t t = 0; t < frontMoves.size(); ++t)
+        frontStamp[frontMoves[t]] = 0;
+    frontMoves.clear();
+    frontStamp.resize(numCustomers, 0);
+    safeOrder = sequence;
+    safeOrderPos.resize(numCustomers);
+    for (int t = 0; t < (int)safeOrder.size(); ++t)
+        safeOrderPos[safeOrder[t]] = t;
+    safeOrderValid = ((int)safeOrder.size() == numCustomers);
+}
 
-            // List blocked customers
-            for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
-                if (!finish[i]) dlog << "P" << i << " ";
-            }
-            dlog << "\n";
-
-            // Log missing resource causes
-            for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
-                if (!finish[i]) {
-                    dlog << "P" << i << " needs:";
-                    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-                        if (need[i][j] > available[j])
-                            dlog << " R" << j << "(" << need[i][j] << ")";
-                    }
-                    dlog << "\n";
-                }
-            }
+/**
+ * @brief Drops the cached safe sequence after a state change it cannot account for (reset, load, rollback, undo).
+ */
+void Banker::invalidateSafeOrder() {
+    safeOrderValid = false;
+}
 
-            dlog.close();
-        }
-        // Auto-savepoint before returning due to deadlock
-        string autoLabel = "auto_P3_deadlock";
-        savepoint(autoLabel);
-        Logger::log("SAVEPOINT → Automatically saved as \"" + autoLabel + "\" before deadlock exit", Logger::INFO);
-        return false;
+/**
+ * @brief O(m) sufficient condition for granting a request without a safety check.
+ *
+ * If the current state is known safe and the requester's remaining need fits in what is available now, then after the
+ * grant Need[c] - Request still fits in Available - Request. The requester can therefore finish first, returning
+ * Allocation[c] + Request, which leaves Work at Available + Allocation[c] - at least as much as at any point of the old
+ * safe sequence before c finished. Every other customer can then follow the old order, so the new state is safe.
+ *
+ * A zero request also passes trivially when the state is known safe, since nothing changes.
+ *
+ * @param customerNum Index of the requesting customer (request already checked against need and available).
+ * @param avail Available vector to test against (the live one, or a copy taken first under concurrent releases).
+ * @return true if the grant is provably safe; false if a more expensive check is needed.
+ */
+bool Banker::requesterCanFinishFirst(int customerNum, const int* avail) const {
+    if (!safeOrderValid) return false; // Only valid when the current state is known safe
+
+    return Kernels::rowFits(need + (size_t)customerNum * rowStride, avail, rowStride);
+}
+
+/**
+ * @brief Moves a customer to the front of the cached safe order after a fast-path grant.
+ *
+ * See requesterCanFinishFirst() for why the resulting order is a valid safe sequence. The move is only recorded in
+ * frontMoves, which is O(1); shifting the entries ahead of the customer would cost O(pos) on every fast-path grant.
+ * settleSafeOrder() applies the moves when the order itself is needed, or once there are as many as customers, so the
+ * amortized cost stays O(1).
+ */
+void Banker::moveToFrontOfSafeOrder(int customerNum) {
+    if ((int)frontMoves.size() >= numCustomers) settleSafeOrder();
+    frontMoves.push_back(customerNum);
+    frontStamp[customerNum] = (int)frontMoves.size();
+}
+
+/**
+ * @brief Rebuilds safeOrder and safeOrderPos with the recorded front moves applied: latest move first, then the rest
+ * of the old order. O(n + moves).
+ */
+void Banker::settleSafeOrder() {
+    if (frontMoves.empty()) return;
+    vector<int> order;
+    order.reserve(numCustomers);
+    for (int t = (int)frontMoves.size() - 1; t >= 0; --t)
+        if (frontStamp[frontMoves[t]] == t + 1) order.push_back(frontMoves[t]); // Only a customer's latest move
+    for (size_t t = 0; t < safeOrder.size(); ++t)
+        if (frontStamp[safeOrder[t]] == 0) order.push_back(safeOrder[t]);
+    for (size_t t = 0; t < frontMoves.size(); ++t)
+        frontStamp[frontMoves[t]] = 0;
+    frontMoves.clear();
+    safeOrder.swap(order);
+    for (int t = 0; t < (int)safeOrder.size(); ++t)
+        safeOrderPos[safeOrder[t]] = t;
+}
+
+/**
+ * @brief Re-verifies the cached safe sequence as if 'request' were granted to 'customerNum'.
+ *
+ * Granting Request to customer c only changes two things along the cached order S: Work is lower by Request at every
+ * step before c, and c's own need is lower by Request. At c's step both sides shrink by the same amount, and once c
+ * finishes Work is exactly what it was before (c returns Allocation[c] + Request). So only the customers ahead of c in
+ * S can be affected, and S stays valid iff each of them still fits in the reduced Work.
+ *
+ * This replays that prefix without mutating any state: O(pos(c) * m) instead of a full safety check, and O(m) when c is
+ * at the front of the order, plus O(n) to settle any front moves made since the last replay (see
+ * moveToFrontOfSafeOrder()).
+ *
+ * @param customerNum Index of the requesting customer.
+ * @param request Resource amounts requested (already checked against need and available).
+ * @param avail Available vector to start from (see requesterCanFinishFirst()).
+ * @return true if the cached order is still a safe sequence after the grant; false if a full check is required.
+ */
+bool Banker::cachedOrderStillSafe(int customerNum, const int request[], const int* avail) {
+    if (!safeOrderValid) return false;
+
+    settleSafeOrder();
+    int pos = safeOrderPos[customerNum];
+    orderWork.assign(rowStride, 0);
+    for (int j = 0; j < numResources; ++j)
+        orderWork[j] = avail[j] - request[j];
+
+    for (int t = 0; t < pos; ++t) {
+        int i = safeOrder[t];
+        if (!Kernels::rowFits(need + (size_t)i * rowStride, &orderWork[0], rowStride)) return false;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE); // Need before allocation (see releaseConcurrent())
+        Kernels::addRow(&orderWork[0], allocation + (size_t)i * rowStride, rowStride);
     }
+    return true;
+}
 
-    // Optionally print safe sequence if enabled
-    if (showSafeSequence) {
-        cout << "[SAFE] Safe sequence: ";
-        fullLog << "[SAFE] Safe sequence: ";
-        for (int i = 0; i < idx; ++i) {
-            cout << "P" << safeSequence[i] << (i < idx - 1 ? " → " : "");
-            fullLog << "P" << safeSequence[i] << (i < idx - 1 ? " → " : "");
-        }
-        cout << endl;
-        fullLog << endl;
+/**
+ * @brief Decides and commits one request without any console, log or statistics output.
+ *
+ * This is the decision core shared by request() and ConcurrentBanker: the need and available checks, the two O(m)
+ * fast paths, and otherwise a full safety check on a tentative view of the state (see tentativeView()). The matrices
+ * are only written once the grant is known to be safe, so a denial leaves the state untouched. Callers must serialize
+ * calls that may write (request, release, reset, ...).
+ *
+ * @param customerNum Index of the requesting customer (already validated).
+ * @param request Resource amounts requested (already validated as non-negative).
+ * @param path Receives how the decision was reached.
+ * @param sequence Receives the safe sequence when a full check ran.
+ * @param finish Receives, per customer, whether it could finish when a full check ran.
+ * @param finalWork If not null, receives the final Work vector when a full check ran.
+ * @return A RequestResult.
+ */
+int Banker::commitRequest(int customerNum, const int request[], CommitPath& path,
+                          vector<int>& sequence, vector<bool>& finish, vector<int>* finalWork) {
+    int* allocRow = allocation + (size_t)customerNum * rowStride;
+    int* needRow = need + (size_t)customerNum * rowStride;
+
+    // Copy the request into a zero-padded row so the kernels can work on whole rowStride rows
+    copy(request, request + numResources, requestRow);
+
+    // With lock-free releases running, read Available once before anything else. Releases only raise it, so every
+    // check below works on a state no better than the real one (see releaseConcurrent()).
+    const int* avail = available;
+    if (concurrentReleases) {
+        copyAtomically(liveAvailable, available, rowStride);
+        avail = liveAvailable;
     }
 
-    return true;
+    // Step 1: Check if request exceeds customer's declared need
+    path = PATH_VALIDATION;
+    if (!Kernels::rowFits(requestRow, needRow, rowStride))
+        return DENIED_NEED; // Equivalent to error conditions in ZyBook Section 8.6 Step 1
+
+    // Step 2: Check if request exceeds currently available resources
+    if (!Kernels::rowFits(requestRow, avail, rowStride))
+        return DENIED_AVAIL; // Equivalent to must wait in Zybook Section 8.6 Step 2
+
+    // Step 3a: Provably safe fast path - the requester can still finish first, so no safety check is needed
+    if (requesterCanFinishFirst(customerNum, avail)) {
+        path = PATH_FINISH_FIRST;
+        commitGrant(allocRow, needRow);
+        moveToFrontOfSafeOrder(customerNum);
+        return GRANTED;
+    }
+
+    // Step 3b: If the last proven safe order still holds after this grant, commit without a full safety check
+    if (cachedOrderStillSafe(customerNum, requestRow, avail)) {
+        path = PATH_ORDER_REPLAY;
+        commitGrant(allocRow, needRow);
+        return GRANTED;
+    }
+
+    // Step 4: Full safety check on the state as it would be after the grant
+    path = PATH_FULL_CHECK;
+    StateView base = currentView();
+    if (concurrentReleases) {
+        // Need before allocation, each after Available: the reverse of the order releases write them in
+        copyAtomically(snapNeed, need, (size_t)numCustomers * rowStride);
+        copyAtomically(snapAllocation, allocation, (size_t)numCustomers * rowStride);
+        base = StateView(liveAvailable, snapAllocation, snapNeed, numCustomers, numResources, rowStride);
+    }
+    if (!runSafetyEngine(tentativeView(base, customerNum, requestRow, tentativeRows), sequence, finish, finalWork))
+        return DENIED_UNSAFE; // Step 5: Nothing was written, so there is nothing to roll back
+
+    // Available -= Request, Allocation += Request, Need -= Request
+    commitGrant(allocRow, needRow);
+    rememberSafeOrder(sequence);
+    return GRANTED;
+}
+
+/**
+ * @brief Applies the request in 'requestRow' to Available and the requester's rows.
+ *
+ * Under concurrent releases every cell is updated with an atomic add, so a release of the same cells is never lost.
+ */
+void Banker::commitGrant(int* allocRow, int* needRow) {
+    WriteSection section(*this);
+    if (!concurrentReleases) {
+        Kernels::grantRow(available, allocRow, needRow, requestRow, rowStride);
+        return;
+    }
+    for (int j = 0; j < numResources; ++j) {
+        int q = requestRow[j];
+        if (q == 0) continue;
+        __atomic_sub_fetch(&available[j], q, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&allocRow[j], q, __ATOMIC_SEQ_CST);
+        __atomic_sub_fetch(&needRow[j], q, __ATOMIC_SEQ_CST);
+    }
 }
 
 /**
  * @brief Handles a resource request from a customer.
  *
- * Implements the Banker's resource-request algorithm:
+ * Implements the Banker's resource-request algorithm (see commitRequest()):
  *     1. Ensure that the request does not exceed the customer's declared need
  *     2. Ensure that the request does not exceed available resources
- *     3. Tentatively allocate the resources
- *     4. Call 'ifSafe()' to check whether the system remains in a safe state
- *     5. If not safe, roll back to the previous state
+ *     3. If a cheap sufficient condition proves the new state safe, commit directly (see requesterCanFinishFirst()
+ *        and cachedOrderStillSafe())
+ *     4. Otherwise check whether the state would remain safe with the resources allocated
+ *     5. If not safe, deny the request and record the blocked customers for explain (see recordDeadlock())
  *
  * @param customerNum Index of the requesting customer (0-based).
  * @param request Array of requested units for each resource type.
@@ -315,47 +728,207 @@ bool Banker::isSafe() {
  *         -3 if granting the request would make the system unsafe
  */
 int Banker::request(int customerNum, int request[]) {
-    // Step 1: Check if request exceeds customer's declared need
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-        if (request[j] > need[customerNum][j]) {
-            lastDenialReason = "Request denied: exceeds declared need.";
-            Logger::log(lastDenialReason, Logger::WARN);
-            return DENIED_NEED; // Equivalent to error conditions in ZyBook Section 8.6 Step 1
-        }
+    CommitPath path;
+    vector<int> safeSequence;
+    vector<bool> finish;
+    int result = commitRequest(customerNum, request, path, safeSequence, finish, &failureWork);
+    lastDenialHasReport = false;
+
+    if (result == DENIED_NEED) {
+        lastDenialReason = "Request denied: exceeds declared need.";
+        Logger::log(lastDenialReason, Logger::WARN);
+        return DENIED_NEED;
     }
-
-    // Step 2: Check if request exceeds currently available resources
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-        if (request[j] > available[j]) {
-            lastDenialReason = "Request denied: exceeds available resources.";
-            Logger::log(lastDenialReason, Logger::WARN);
-            return DENIED_AVAIL; // Equivalent to must wait in Zybook Section 8.6 Step 2
-        }
+    if (result == DENIED_AVAIL) {
+        lastDenialReason = "Request denied: exceeds available resources.";
+        Logger::log(lastDenialReason, Logger::WARN);
+        return DENIED_AVAIL;
     }
 
-    // Step 3: Tentatively allocate resources
-    snapshot(); // Save current state in case we need to roll back
-
-    // [CRITICAL SECTION START] Tentative allocation for safety check
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-        available[j] -= request[j];                      // Available -= Request
-        allocation[customerNum][j] += request[j];        // Allocation += Request
-        need[customerNum][j] -= request[j];             // Need -= Request
-    }
-    // [CRITICAL SECTION END] Tentative allocation
+    if (path == PATH_FINISH_FIRST) globalStats.fastPathHits++;
+    else if (path == PATH_ORDER_REPLAY) globalStats.orderReplayHits++;
+    else globalStats.fastPathMisses++; // Needed the full safety check
 
-    // Step 4: Check if the system remains in a safe state
-    if (isSafe()) {
-        lastActiveCustomer = customerNum; // Mark who made the request
-        lastDenialReason.clear();         // Clear previous denial
-        return GRANTED;
-    } else {
-        // Step 5: Roll back if unsafe
+    if (result == DENIED_UNSAFE) {
+        recordDeadlock(customerNum, finish);
         lastDenialReason = "Request denied: would lead to unsafe state.";
+        lastDenialHasReport = true;
         Logger::log(lastDenialReason, Logger::WARN);
-        restore();  // Restore system to state before tentative allocation
         return DENIED_UNSAFE;
     }
+
+    startUndoRecord();
+    addUndoRow(customerNum, request, 1);
+    commitUndoRecord();
+
+    if (showSafeSequence) settleSafeOrder();
+    printSafeSequence(safeOrder, (int)safeOrder.size());
+    lastActiveCustomer = customerNum; // Mark who made the request
+    lastDenialReason.clear();         // Clear previous denial
+    return GRANTED;
+}
+
+// Orders batch positions by total requested units, smallest first
+struct BatchSizeOrder {
+    const vector<Banker::BatchRequest>* batch;
+    explicit BatchSizeOrder(const vector<Banker::BatchRequest>& b) : batch(&b) {}
+    long total(int k) const {
+        long sum = 0;
+        const vector<int>& amounts = (*batch)[k].amounts;
+        for (size_t j = 0; j < amounts.size(); ++j) sum += amounts[j];
+        return sum;
+    }
+    bool operator()(int a, int b) const {
+        return total(a) < total(b);
+    }
+};
+
+/**
+ * @brief Decides a batch of requests, amortizing safety checks across them.
+ *
+ * The verdicts are exactly what calling request() on each entry in the chosen order would give. While the state is
+ * known safe, requests are decided one by one with the same O(m) fast paths as request(). The first one that needs a
+ * full safety check opens a window, and the check runs on the whole window of grants at once:
+ *     1. Apply every request in the window that passes the need and available checks, then run one safety check
+ *     2. If the combined state is safe, commit the window and double its size. Safety is monotone in the grants:
+ *        handing a request back raises Work before the requester finishes and changes nothing after, so every state
+ *        along the way was safe too and each grant would also have been made one at a time
+ *     3. Otherwise roll the window back and halve it. Requests ahead of the first applied one were denied against the
+ *        same state they will see again, so their verdicts are kept. A window holding a single grant that fails
+ *        denies that request as unsafe
+ *
+ * Rolling back releases the window's grants again, newest first, so it touches only Available and the rows that
+ * changed: O(window * m) rather than a copy of the whole state.
+ *
+ * A batch that fits costs one check. When most grants are unsafe the window shrinks to one request and the cost
+ * approaches the serial path (one check per request) plus O(log k).
+ *
+ * Entries must already be validated (customer in range, no negative amounts), as for request(). Denials inside a
+ * batch are quiet: no deadlock report or automatic savepoint is produced for them.
+ *
+ * @param batch Requests to decide.
+ * @param verdicts Receives one RequestResult per entry, in the order of 'batch'.
+ * @param order Order in which the requests are decided.
+ * @return Number of safety checks run.
+ */
+int Banker::requestBatch(const vector<BatchRequest>& batch, vector<int>& verdicts, BatchOrder order) {
+    WriteSection section(*this); // Readers see the batch all at once, never a window being tried
+    int total = (int)batch.size();
+    verdicts.assign(total, GRANTED);
+    vector<int> sequence(total);
+    for (int k = 0; k < total; ++k) sequence[k] = k;
+    if (order == BATCH_SMALLEST_FIRST)
+        stable_sort(sequence.begin(), sequence.end(), BatchSizeOrder(batch));
+
+    int checks = 0;
+    int pos = 0;
+    int window = total;
+    vector<int> safeSequence;
+    vector<bool> finish;
+    vector<int> appliedAt;  // Positions granted in the current window: its undo log
+    while (pos < total) {
+        // Fast paths while the state is known safe: deny on need/available, or grant when provably safe
+        while (pos < total && safeOrderValid) {
+            const BatchRequest& r = batch[sequence[pos]];
+            int* allocRow = allocation + (size_t)r.customer * rowStride;
+            int* needRow = need + (size_t)r.customer * rowStride;
+            copy(r.amounts.begin(), r.amounts.begin() + numResources, requestRow);
+
+            if (!Kernels::rowFits(requestRow, needRow, rowStride)) {
+                verdicts[sequence[pos]] = DENIED_NEED;
+            } else if (!Kernels::rowFits(requestRow, available, rowStride)) {
+                verdicts[sequence[pos]] = DENIED_AVAIL;
+            } else if (requesterCanFinishFirst(r.customer, available)) {
+                Kernels::grantRow(available, allocRow, needRow, requestRow, rowStride);
+                moveToFrontOfSafeOrder(r.customer);
+                verdicts[sequence[pos]] = GRANTED;
+            } else if (cachedOrderStillSafe(r.customer, requestRow, available)) {
+                Kernels::grantRow(available, allocRow, needRow, requestRow, rowStride);
+                verdicts[sequence[pos]] = GRANTED;
+            } else {
+                break; // Needs a full safety check
+            }
+            ++pos;
+        }
+        if (pos >= total) break;
+
+        int hi = min(total, pos + window);
+
+        // Step 1: Apply every request in the window that fits its need and what is available
+        appliedAt.clear();
+        for (int k = pos; k < hi; ++k) {
+            const BatchRequest& r = batch[sequence[k]];
+            int* allocRow = allocation + (size_t)r.customer * rowStride;
+            int* needRow = need + (size_t)r.customer * rowStride;
+            copy(r.amounts.begin(), r.amounts.begin() + numResources, requestRow);
+
+            if (!Kernels::rowFits(requestRow, needRow, rowStride)) {
+                verdicts[sequence[k]] = DENIED_NEED;
+            } else if (!Kernels::rowFits(requestRow, available, rowStride)) {
+                verdicts[sequence[k]] = DENIED_AVAIL;
+            } else {
+                Kernels::grantRow(available, allocRow, needRow, requestRow, rowStride);
+                verdicts[sequence[k]] = GRANTED;
+                appliedAt.push_back(k);
+            }
+        }
+        if (appliedAt.empty()) { // Nothing changed, so the state is still as safe as before
+            pos = hi;
+            continue;
+        }
+
+        // Step 2: One safety check for every grant in the window
+        ++checks;
+        if (runSafetyEngine(currentView(), safeSequence, finish)) {
+            rememberSafeOrder(safeSequence);
+            pos = hi;
+            window = min(total, window * 2);
+            continue;
+        }
+
+        // Step 3: Roll back and narrow the window
+        for (size_t u = appliedAt.size(); u-- > 0;) {
+            const BatchRequest& r = batch[sequence[appliedAt[u]]];
+            copy(r.amounts.begin(), r.amounts.begin() + numResources, requestRow);
+            Kernels::releaseRow(available, allocation + (size_t)r.customer * rowStride,
+                                need + (size_t)r.customer * rowStride, requestRow, rowStride);
+        }
+        int firstApplied = appliedAt[0];
+        if (appliedAt.size() == 1) {
+            verdicts[sequence[firstApplied]] = DENIED_UNSAFE;
+            pos = firstApplied + 1;
+        } else {
+            pos = firstApplied;
+            window = max(1, (hi - firstApplied) / 2);
+        }
+    }
+
+    // The granted entries are one operation for undo
+    startUndoRecord();
+    for (int k = 0; k < total; ++k)
+        if (verdicts[k] == GRANTED) addUndoRow(batch[k].customer, &batch[k].amounts[0], 1);
+    commitUndoRecord();
+
+    // Report the outcome of the last request decided, as request() would
+    lastDenialHasReport = false;
+    int lastGranted = -1;
+    for (int k = 0; k < total; ++k) {
+        int v = verdicts[sequence[k]];
+        if (v == GRANTED) lastGranted = sequence[k];
+        else if (v == DENIED_NEED) lastDenialReason = "Request denied: exceeds declared need.";
+        else if (v == DENIED_AVAIL) lastDenialReason = "Request denied: exceeds available resources.";
+        else lastDenialReason = "Request denied: would lead to unsafe state.";
+    }
+    if (total > 0 && verdicts[sequence[total - 1]] == GRANTED)
+        lastDenialReason.clear();
+    if (lastGranted >= 0) {
+        lastActiveCustomer = batch[lastGranted].customer;
+        if (safeOrderValid && showSafeSequence) {
+            settleSafeOrder();
+            printSafeSequence(safeOrder, (int)safeOrder.size());
+        }
+    }
+    return checks;
 }
 
 /**
@@ -367,14 +940,146 @@ int Banker::request(int customerNum, int request[]) {
  * @param customerNum Index of the releasing customer.
  * @param release Array of units being released for each resource type.
  */
-void Banker::release(int customerNum, int release[]) {
+void Banker::release(int customerNum, const int release[]) {
+    // A release can only make the state safer: every customer ahead of the releaser in the cached safe order sees more
+    // Work, and from the releaser onwards Work is unchanged, so the cached order stays valid.
     // [CRITICAL SECTION START] Releasing resources back to system
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-        allocation[customerNum][j] -= release[j];
-        available[j] += release[j];
-        need[customerNum][j] += release[j];
-    }
+    int* allocRow = allocation + (size_t)customerNum * rowStride;
+    int* needRow = need + (size_t)customerNum * rowStride;
+    copy(release, release + numResources, requestRow); // Zero-padded copy for the row kernel
+    WriteSection section(*this);
+    Kernels::releaseRow(available, allocRow, needRow, requestRow, rowStride);
     // [CRITICAL SECTION END] Release complete
+
+    startUndoRecord();
+    addUndoRow(customerNum, release, -1);
+    commitUndoRecord();
+}
+
+/**
+ * @brief Enables or disables lock-free releases through releaseConcurrent().
+ *
+ * Allocates the buffers commitRequest() copies the state into on first use. Must not be called while another thread
+ * is using the Banker.
+ */
+void Banker::setConcurrentReleases(bool enabled) {
+    if (enabled && liveAvailable == NULL) {
+        liveAvailable = allocVector();
+        snapAllocation = allocMatrix();
+        snapNeed = allocMatrix();
+    }
+    concurrentReleases = enabled;
+}
+
+/**
+ * @brief Releases resources without any lock, safe to call from many threads alongside one commitRequest() caller.
+ *
+ * Each column of the customer's allocation is taken with a compare-and-swap that fails if the customer holds less
+ * than it is releasing, in which case the columns already taken are put back and nothing else changes. Then the need
+ * row and finally Available are raised with atomic adds.
+ *
+ * commitRequest() reads in the opposite order (Available, then need, then allocation), so whatever mix of old and new
+ * values it sees is never better than the state after the release: at worst the released units are missing from
+ * Available, or appear in the need row before Available. A state that is safe without those units is also safe with
+ * them, so any grant it decides is still safe. The CAS loop retries only when another thread changed the same cell,
+ * so a release is lock-free but not strictly wait-free.
+ *
+ * @param customerNum Index of the releasing customer (already validated).
+ * @param release Units to release per resource type (already checked to be non-negative).
+ * @return true if the release was applied; false if it exceeds the current allocation.
+ */
+bool Banker::releaseConcurrent(int customerNum, const int release[]) {
+    int* allocRow = allocation + (size_t)customerNum * rowStride;
+    int* needRow = need + (size_t)customerNum * rowStride;
+    WriteSection section(*this);
+
+    int j = 0;
+    for (; j < numResources; ++j) {
+        if (release[j] == 0) continue;
+        int held = __atomic_load_n(&allocRow[j], __ATOMIC_RELAXED);
+        bool taken = false;
+        while (held >= release[j] &&
+               !(taken = __atomic_compare_exchange_n(&allocRow[j], &held, held - release[j], false,
+                                                     __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))) {
+            // 'held' now holds the current value; retry
+        }
+        if (!taken) break;
+    }
+
+    bool applied = (j == numResources);
+    if (!applied) {
+        while (--j >= 0) // Put back what was already taken
+            if (release[j] != 0) __atomic_add_fetch(&allocRow[j], release[j], __ATOMIC_SEQ_CST);
+    } else {
+        for (int k = 0; k < numResources; ++k)
+            if (release[k] != 0) __atomic_add_fetch(&needRow[k], release[k], __ATOMIC_SEQ_CST);
+        for (int k = 0; k < numResources; ++k)
+            if (release[k] != 0) __atomic_add_fetch(&available[k], release[k], __ATOMIC_SEQ_CST);
+    }
+    return applied;
+}
+
+/**
+ * @brief Marks the start of a write to Available, Allocation, Need or Maximum.
+ *
+ * Every writer brackets its changes with beginWrite()/endWrite(); readSnapshot() retries while any bracket is open or
+ * if one closed during its copy. Writers never wait for readers, and several writers (lock-free releases alongside a
+ * commit) may be inside at once.
+ */
+void Banker::beginWrite() {
+    // Buffered denials describe the state about to change (lock-free releases never see any: request() only)
+    if (!pendingDeadlocks.empty() && !concurrentReleases)
+        flushDeadlockReports();
+    __atomic_add_fetch(&writersActive, 1, __ATOMIC_SEQ_CST);
+}
+
+void Banker::endWrite() {
+    __atomic_add_fetch(&stateVersion, 1u, __ATOMIC_SEQ_CST);
+    __atomic_sub_fetch(&writersActive, 1, __ATOMIC_SEQ_CST);
+}
+
+unsigned Banker::getStateVersion() const {
+    return __atomic_load_n(&stateVersion, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief Copies the latest published state: one no write was part-way through.
+ *
+ * Seqlock-style: reads the version, copies, and retries if a write was open at either end or completed in between.
+ * Safe from any thread; the commit path only pays two atomic increments per write. 'snap' keeps its buffers between
+ * calls, so a reader that polls reuses them.
+ */
+void Banker::readSnapshot(StateSnapshot& snap) const {
+    size_t cells = (size_t)numCustomers * rowStride;
+    snap.available.resize(rowStride);
+    snap.maximum.resize(cells);
+    snap.allocation.resize(cells);
+    snap.need.resize(cells);
+    snap.numCustomers = numCustomers;
+    snap.numResources = numResources;
+    snap.rowStride = rowStride;
+
+    for (;;) {
+        unsigned version = __atomic_load_n(&stateVersion, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&writersActive, __ATOMIC_SEQ_CST) != 0) {
+            sched_yield();
+            continue;
+        }
+        copyAtomically(&snap.available[0], available, rowStride);
+        copyAtomically(&snap.maximum[0], maximum, cells);
+        copyAtomically(&snap.allocation[0], allocation, cells);
+        copyAtomically(&snap.need[0], need, cells);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&writersActive, __ATOMIC_SEQ_CST) == 0 &&
+            __atomic_load_n(&stateVersion, __ATOMIC_SEQ_CST) == version) {
+            snap.version = version;
+            return;
+        }
+    }
+}
+
+StateView Banker::StateSnapshot::view() const {
+    return StateView(&available[0], &allocation[0], &need[0], numCustomers, numResources, rowStride);
 }
 
 /**
@@ -383,15 +1088,16 @@ void Banker::release(int customerNum, int release[]) {
  * Outputs the `available`, `maximum`, `allocation`, and `need` matrices to both standard output and the `fullLog`
  * stream. Helpful for debugging and tracking resource distribution.
  */
-void Banker::printMatrix(const string& title, const int matrix[NUMBER_OF_CUSTOMERS][NUMBER_OF_RESOURCES]) const {
+void Banker::printMatrix(const string& title, const int* matrix) const {
     cout << COLOR_MAGENTA << "\n" << title << ":\n" << COLOR_RESET;
     fullLog << "\n" << title << ":\n";
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
+    for (int i = 0; i < numCustomers; ++i) {
+        const int* row = matrix + (size_t)i * rowStride;
         cout << "P" << i << (i == lastActiveCustomer ? "*: " : ": ");
         fullLog << "P" << i << (i == lastActiveCustomer ? "*: " : ": ");
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-            cout << matrix[i][j] << " ";
-            fullLog << matrix[i][j] << " ";
+        for (int j = 0; j < numResources; ++j) {
+            cout << row[j] << " ";
+            fullLog << row[j] << " ";
         }
         cout << endl;
         fullLog << endl;
@@ -413,23 +1119,33 @@ void Banker::printMatrix(const string& title, const int matrix[NUMBER_OF_CUSTOME
 * @ return true if the request is granted; false if denied due to safety or availability
 */
 void Banker::printState() const {
+    StateSnapshot snap;
+    readSnapshot(snap);
+    const int* available = &snap.available[0]; // Print the published copy, never a half-applied write
+
     cout << COLOR_CYAN << "\n=== SYSTEM STATE ===\n" << COLOR_RESET;
     fullLog << "\n=== SYSTEM STATE ===\n";
 
     // Print Available Resources
     cout << COLOR_MAGENTA << "\nAvailable:\n" << COLOR_RESET << "    ";
     fullLog << "\nAvailable:\n    ";
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
+    for (int j = 0; j < numResources; ++j) {
         cout << available[j] << " ";
         fullLog << available[j] << " ";
     }
-    cout << "\n    R0 R1 R2 R3\n";
-    fullLog << "\n    R0 R1 R2 R3\n";
+    cout << "\n   ";
+    fullLog << "\n   ";
+    for (int j = 0; j < numResources; ++j) {
+        cout << " R" << j;
+        fullLog << " R" << j;
+    }
+    cout << "\n";
+    fullLog << "\n";
 
     // Print the other matrices
-    printMatrix("Maximum", maximum);
-    printMatrix("Allocation", allocation);
-    printMatrix("Need", need);
+    printMatrix("Maximum", &snap.maximum[0]);
+    printMatrix("Allocation", &snap.allocation[0]);
+    printMatrix("Need", &snap.need[0]);
 
     cout << endl;
     fullLog << endl;
@@ -438,11 +1154,12 @@ void Banker::printState() const {
 /**
  * @brief Returns the current allocation matrix.
  *
- * Provides external access to the internal 2D allocation array, used for logging or testing purposes.
+ * Provides external access to the internal allocation buffer, used for logging or testing purposes. Row i starts at
+ * offset i * getRowStride().
  *
- * @return A pointer to the allocation matrix of size [NUMBER_OF_CUSTOMERS][NUMBER_OF_RESOURCES].
+ * @return A pointer to the row-major allocation matrix of getNumCustomers() rows.
  */
-const int (*Banker::getAllocation() const)[NUMBER_OF_RESOURCES] {
+const int* Banker::getAllocation() const {
     return allocation; // Return pointer to internal allocation matrix
 }
 
@@ -457,14 +1174,22 @@ const int (*Banker::getAllocation() const)[NUMBER_OF_RESOURCES] {
  * Output is written to both standard output and fullLog for traceability.
  */
 void Banker::printReport() const {
-    int totalAllocated[NUMBER_OF_RESOURCES] = {0};  // Tracks total allocated per resource
-    int totalNeeded[NUMBER_OF_RESOURCES] = {0};     // Tracks total remaining need per resource
+    StateSnapshot snap;
+    readSnapshot(snap);
+    const int* available = &snap.available[0];
+    const int* allocation = &snap.allocation[0];
+    const int* need = &snap.need[0];
+
+    vector<int> totalAllocated(numResources, 0);  // Tracks total allocated per resource
+    vector<int> totalNeeded(numResources, 0);     // Tracks total remaining need per resource
 
     // Compute column-wise totals from allocation and need matrices
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-            totalAllocated[j] += allocation[i][j];  // Sum allocated resources
-            totalNeeded[j] += need[i][j];           // Sum unmet needs
+    for (int i = 0; i < numCustomers; ++i) {
+        const int* allocRow = allocation + (size_t)i * rowStride;
+        const int* needRow = need + (size_t)i * rowStride;
+        for (int j = 0; j < numResources; ++j) {
+            totalAllocated[j] += allocRow[j];  // Sum allocated resources
+            totalNeeded[j] += needRow[j];      // Sum unmet needs
         }
     }
 
@@ -475,7 +1200,7 @@ void Banker::printReport() const {
     // Print available resources
     cout << "Available: ";
     fullLog << "Available: ";
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
+    for (int j = 0; j < numResources; ++j) {
         cout << available[j] << " ";
         fullLog << available[j] << " ";
     }
@@ -485,7 +1210,7 @@ void Banker::printReport() const {
     // Print total allocated resources
     cout << "Allocated: ";
     fullLog << "Allocated: ";
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
+    for (int j = 0; j < numResources; ++j) {
         cout << totalAllocated[j] << " ";
         fullLog << totalAllocated[j] << " ";
     }
@@ -495,7 +1220,7 @@ void Banker::printReport() const {
     // Print total remaining need
     cout << "Remaining Need: ";
     fullLog << "Remaining Need: ";
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
+    for (int j = 0; j < numResources; ++j) {
         cout << totalNeeded[j] << " ";
         fullLog << totalNeeded[j] << " ";
     }
@@ -508,29 +1233,32 @@ void Banker::printReport() const {
     // Output same data to CSV file
     ofstream csv("logs/report.csv");
     if (csv.is_open()) {
-        csv << "Type,R0,R1,R2,R3\n";
+        csv << "Type";
+        for (int j = 0; j < numResources; ++j)
+            csv << ",R" << j;
+        csv << "\n";
 
         // Available row
         csv << "Available,";
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
+        for (int j = 0; j < numResources; ++j) {
             csv << available[j];
-            if (j < NUMBER_OF_RESOURCES - 1) csv << ",";
+            if (j < numResources - 1) csv << ",";
         }
         csv << "\n";
 
         // Allocated row
         csv << "Allocated,";
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
+        for (int j = 0; j < numResources; ++j) {
             csv << totalAllocated[j];
-            if (j < NUMBER_OF_RESOURCES - 1) csv << ",";
+            if (j < numResources - 1) csv << ",";
         }
         csv << "\n";
 
         // Remaining need row
         csv << "RemainingNeed,";
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
+        for (int j = 0; j < numResources; ++j) {
             csv << totalNeeded[j];
-            if (j < NUMBER_OF_RESOURCES - 1) csv << ",";
+            if (j < numResources - 1) csv << ",";
         }
         csv << "\n";
 
@@ -549,76 +1277,77 @@ void Banker::printReport() const {
 * states.
 */
 void Banker::reset() {
-    // [CRITICAL SECTION START] Resetting system to initial snapshot state
-	// Restoring allocation and need matrices from snapshot
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-            allocation[i][j] = allocationSnapshot[i][j]; // restoring allocations
-            need[i][j] = needSnapshot[i][j];		     // restore needs
+    // Record the rows that change, so the reset itself can be undone
+    startUndoRecord();
+    vector<int> delta(numResources);
+    for (int i = 0; i < numCustomers; ++i) {
+        const int* allocRow = allocation + (size_t)i * rowStride;
+        const int* initialRow = allocationSnapshot + (size_t)i * rowStride;
+        bool changed = false;
+        for (int j = 0; j < numResources; ++j) {
+            delta[j] = initialRow[j] - allocRow[j];
+            changed = changed || delta[j] != 0;
         }
+        if (changed) addUndoRow(i, &delta[0], 1);
     }
+    setUndoAvailable(availableSnapshot);
+    commitUndoRecord();
+
+    // [CRITICAL SECTION START] Resetting system to initial snapshot state
+    beginWrite();
+	// Restoring allocation and need matrices from snapshot
+    copyMatrix(allocation, allocationSnapshot); // restoring allocations
+    copyMatrix(need, needSnapshot);		        // restore needs
 
 	// Restore available resource pool
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-        available[j] = availableSnapshot[j];
-    }
+    copyVector(available, availableSnapshot);
+    endWrite();
 
 	// Reset auxiliary state for tracking simulation behavior
     lastActiveCustomer = -1; // No customer is considered active anymore
     lastDenialReason.clear(); // Clear last denial resason
+    invalidateSafeOrder();    // Cached safe sequence belonged to the pre-reset state
 // [CRITICAL SECTION NEND] Reset complete
 }
 
 /**
- * @brief Saves the current system state for manual undo.
+ * @brief Marks the current point of the undo log for manual undo.
  *
- * This method captures the current available, allocation, and need matrices in temporary buffers. These can later be
- * restored via `restoreUndoSnapshot()` to manually revert the system state.
+ * Nothing is copied: restoreUndoSnapshot() undoes (or redoes) the operations recorded since, so the mark stays usable
+ * as long as they are still within the undo budget.
  */
 void Banker::saveUndoSnapshot() {
-	// Save available resource
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j)
-        undoAvailable[j] = available[j];
-
-	// Save allocation and need matrices
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i)
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-            undoAllocation[i][j] = allocation[i][j];
-            undoNeed[i][j] = need[i][j];
-        }
-
+    undoMarkSeq = undoFirstSeq + undoCount;
     hasUndoSnapshot = true; // Mark snapshot as available
     Logger::log("SNAPSHOT → Manual snapshot saved", Logger::INFO);
 }
 
 /**
-* @brief Restores the system state from the most manual undo snapshot.
+* @brief Restores the system state to the manual undo snapshot.
 *
-* This method is used to rollback the system to a previously save state captured by a manual snapshot (e.g., using the
-* 'snapshot' or 'savepoint' command). If no manual snapshot has been created, the operation fails with an error message.
+* This method is used to rollback the system to a previously save state captured by a manual snapshot (the 'snapshot'
+* command), by undoing every operation recorded since, or redoing them if they were undone past the mark. If no manual
+* snapshot has been created, or it has dropped out of the undo log, the operation fails with an error message.
 *
-* On successful restoration, the allocation, need, and available matrices are reset to the original snapshot. It also
-* clears any previously recorded denial reasons or customer availability to a neutral state.
+* @return true if the state is back at the snapshot.
 */
-void Banker::restoreUndoSnapshot() {
+bool Banker::restoreUndoSnapshot() {
 	// If no manual snapshot exists, log the failure and exit
-    if (!hasUndoSnapshot) {
+    if (undoMarkSeq < 0) {
         Logger::log("UNDO → Failed: No snapshot to restore", Logger::WARN);
-        cout << COLOR_RED << "[ERROR] No manual snapshot to restore.\n" << COLOR_RESET;
-        fullLog << "[ERROR] No manual snapshot to restore.\n";
-        return;
+        if (hasUndoSnapshot) {
+            cout << COLOR_RED << "[ERROR] The last snapshot is no longer in the undo history.\n" << COLOR_RESET;
+            fullLog << "[ERROR] The last snapshot is no longer in the undo history.\n";
+        } else {
+            cout << COLOR_RED << "[ERROR] No manual snapshot to restore.\n" << COLOR_RESET;
+            fullLog << "[ERROR] No manual snapshot to restore.\n";
+        }
+        return false;
     }
 
-	// Restpre available resources from undo snapshot
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j)
-        available[j] = undoAvailable[j];
-
-	// Restore allocation and need matrices for all customers
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i)
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-            allocation[i][j] = undoAllocation[i][j];
-            need[i][j] = undoNeed[i][j];
-        }
+    long current = undoFirstSeq + undoCount;
+    if (undoMarkSeq < current) undo((int)(current - undoMarkSeq));
+    else if (undoMarkSeq > current) redo((int)(undoMarkSeq - current));
 
 	// Log the successful restoration
     Logger::log("UNDO → Manual snapshot restored", Logger::INFO);
@@ -626,41 +1355,358 @@ void Banker::restoreUndoSnapshot() {
 	// Reset tracking states for diagnostics
     lastDenialReason.clear();	// Clear last denial explanation
     lastActiveCustomer = -1;	// Reset customer activity tracking
+    invalidateSafeOrder();		// Cached safe sequence no longer matches
+    return true;
+}
+
+/**
+ * @brief Starts building an undo record for one operation (see undo()).
+ */
+void Banker::startUndoRecord() {
+    undoScratch.assign(2 + numResources, 0);    // Size, row count, Available delta
+}
+
+/**
+ * @brief Adds sign * allocDelta to the record as customer's allocation change; Available changes by the opposite.
+ */
+void Banker::addUndoRow(int customer, const int* allocDelta, int sign) {
+    undoScratch[1]++;
+    undoScratch.push_back(customer);
+    for (int j = 0; j < numResources; ++j) {
+        undoScratch.push_back(sign * allocDelta[j]);
+        undoScratch[2 + j] -= sign * allocDelta[j];
+    }
+}
+
+/**
+ * @brief Sets the record's Available change outright, for operations that do not conserve units (reset, rollback).
+ * Call before Available is changed.
+ */
+void Banker::setUndoAvailable(const int* newAvailable) {
+    for (int j = 0; j < numResources; ++j)
+        undoScratch[2 + j] = newAvailable[j] - available[j];
+}
+
+/**
+ * @brief Appends the record built since startUndoRecord(), unless the operation changed nothing.
+ */
+void Banker::commitUndoRecord() {
+    bool changed = undoScratch[1] > 0;
+    for (int j = 0; j < numResources && !changed; ++j)
+        changed = undoScratch[2 + j] != 0;
+    if (!changed) return;
+    undoScratch[0] = (int)undoScratch.size() + 1;
+    undoScratch.push_back(undoScratch[0]);
+    appendUndoRecord(&undoScratch[0], undoScratch[0]);
+}
+
+/**
+ * @brief Appends one record at the cursor: drops the redoable records, then the oldest ones until it fits.
+ *
+ * A record larger than the whole budget cannot be kept, and nothing before it could be undone without it, so the log
+ * is emptied instead. The ring is allocated on first use.
+ */
+void Banker::appendUndoRecord(const int* record, int size) {
+    int capacity = (int)(undoBudget / sizeof(int));
+
+    // A new operation replaces whatever could have been redone
+    if (undoMarkSeq > undoFirstSeq + undoCount) undoMarkSeq = -1;
+    undoHead = undoCursor;
+    redoUsed = 0;
+    redoCount = 0;
+
+    if (size > capacity) {
+        undoEvicted += undoCount;
+        undoFirstSeq += undoCount + 1;
+        undoCount = 0;
+        undoUsed = 0;
+        undoTail = undoCursor = undoHead = 0;
+        if (undoMarkSeq >= 0 && undoMarkSeq < undoFirstSeq) undoMarkSeq = -1;
+        return;
+    }
+    if ((int)undoRing.size() != capacity) undoRing.resize(capacity);
+
+    while (undoUsed + size > capacity) {
+        int oldest = undoRing[undoTail];
+        undoTail = (undoTail + oldest) % capacity;
+        undoUsed -= oldest;
+        undoCount--;
+        undoFirstSeq++;
+        undoEvicted++;
+    }
+    if (undoMarkSeq >= 0 && undoMarkSeq < undoFirstSeq) undoMarkSeq = -1;
+
+    for (int k = 0; k < size; ++k)
+        undoRing[(undoHead + k) % capacity] = record[k];
+    undoHead = undoCursor = (undoHead + size) % capacity;
+    undoUsed += size;
+    undoCount++;
+}
+
+/**
+ * @brief Applies the record starting at 'start' forwards (sign 1, redo) or backwards (sign -1, undo). O(rows * m).
+ */
+void Banker::applyUndoRecord(int start, int sign) {
+    const int capacity = (int)undoRing.size();
+    int pos = start + 1;
+    int rows = undoRing[pos++ % capacity];
+    for (int j = 0; j < numResources; ++j)
+        available[j] += sign * undoRing[(pos + j) % capacity];
+    pos += numResources;
+    for (int r = 0; r < rows; ++r) {
+        int customer = undoRing[pos++ % capacity];
+        int* allocRow = allocation + (size_t)customer * rowStride;
+        int* needRow = need + (size_t)customer * rowStride;
+        for (int j = 0; j < numResources; ++j) {
+            int d = sign * undoRing[(pos + j) % capacity];
+            allocRow[j] += d;
+            needRow[j] -= d;
+        }
+        pos += numResources;
+    }
 }
+
+/**
+ * @brief Reverts the last 'count' operations (granted requests, releases, RQB batches, resets and rollbacks).
+ *
+ * Each one is undone from its record in the operation log: O(rows * m), a single row for a request or release,
+ * independent of the number of customers. Undone operations can be redone until the next operation is recorded.
+ *
+ * @param count Operations to undo.
+ * @return How many were undone (fewer if the log holds fewer).
+ */
+int Banker::undo(int count) {
+    int done = 0;
+    if (count <= 0 || undoCount == 0) return 0;
+    const int capacity = (int)undoRing.size();
+    {
+        WriteSection section(*this);
+        while (done < count && undoCount > 0) {
+            int size = undoRing[(undoCursor + capacity - 1) % capacity];   // Trailing size
+            int start = (undoCursor + capacity - size) % capacity;
+            applyUndoRecord(start, -1);
+            undoCursor = start;
+            undoUsed -= size;
+            redoUsed += size;
+            undoCount--;
+            redoCount++;
+            ++done;
+        }
+    }
+    lastDenialReason.clear();
+    lastActiveCustomer = -1;
+    invalidateSafeOrder();
+    return done;
+}
+
+/**
+ * @brief Re-applies up to 'count' operations reverted by undo().
+ *
+ * @return How many were redone.
+ */
+int Banker::redo(int count) {
+    int done = 0;
+    if (count <= 0 || redoCount == 0) return 0;
+    const int capacity = (int)undoRing.size();
+    {
+        WriteSection section(*this);
+        while (done < count && redoCount > 0) {
+            int size = undoRing[undoCursor];
+            applyUndoRecord(undoCursor, 1);
+            undoCursor = (undoCursor + size) % capacity;
+            undoUsed += size;
+            redoUsed -= size;
+            undoCount++;
+            redoCount--;
+            ++done;
+        }
+    }
+    lastDenialReason.clear();
+    lastActiveCustomer = -1;
+    invalidateSafeOrder();
+    return done;
+}
+
+/**
+ * @brief Changes the undo budget, keeping the newest undoable operations that fit. Redoable ones are dropped.
+ *
+ * @param bytes New budget; 0 turns recording off (ConcurrentBanker does, since its paths do not record).
+ */
+void Banker::setUndoBudget(size_t bytes) {
+    const int capacity = (int)undoRing.size();
+    vector<int> kept(undoUsed);
+    for (int k = 0; k < undoUsed; ++k)
+        kept[k] = undoRing[(undoTail + k) % capacity];
+    long current = undoFirstSeq + undoCount;
+    long mark = (undoMarkSeq <= current) ? undoMarkSeq : -1;
+
+    undoBudget = bytes;
+    vector<int>().swap(undoRing);
+    undoFirstSeq = current - undoCount;
+    undoTail = undoCursor = undoHead = 0;
+    undoUsed = redoUsed = 0;
+    undoCount = redoCount = 0;
+    undoMarkSeq = -1;
+    for (size_t k = 0; k < kept.size(); k += kept[k])
+        appendUndoRecord(&kept[k], kept[k]);
+    undoMarkSeq = (mark >= undoFirstSeq && mark <= undoFirstSeq + undoCount) ? mark : -1;
+}
+
+/**
+ * @brief Forgets every recorded operation and the snapshot mark, after a change that was not recorded (load, journal
+ * recovery, a new maximum or Available vector).
+ */
+void Banker::clearUndoHistory() {
+    undoFirstSeq += undoCount + redoCount + 1;
+    undoTail = undoCursor = undoHead = 0;
+    undoUsed = redoUsed = 0;
+    undoCount = redoCount = 0;
+    undoMarkSeq = -1;
+}
+
+Banker::UndoStats Banker::undoStats() const {
+    UndoStats stats;
+    stats.budgetBytes = undoBudget;
+    stats.usedBytes = (size_t)(undoUsed + redoUsed) * sizeof(int);
+    stats.undoable = undoCount;
+    stats.redoable = redoCount;
+    stats.evicted = undoEvicted;
+    stats.hasMark = undoMarkSeq >= 0;
+    return stats;
+}
+
 /**
 * @brief Creates a named savepoint of the current system state.
 *
-* This method stores a snapshot of the current allocation, need, and available resource matrices using the given name
-* as a key. These savepoints can be later be compared to or restored using commands like 'compare', 'diff', or 'load'.
+* This method stores a snapshot of the current available vector and allocation matrix using the given name as a key.
+* These savepoints can be later be compared to or restored using commands like 'compare', 'diff', or 'rollback'.
 *
-* Savepoints enable users to track and analyze how the system state changes over time and are essential for debugging,
-* rollback, and auditing purposes
+* The allocation matrix is stored in blocks of BANKER_SAVEPOINT_BLOCK_ROWS rows. Every block that still matches the
+* same block of the latest savepoint is shared with it instead of copied, so a run of savepoints between which only a
+* few customers changed costs little more than those customers' rows. Need is derived from maximum - allocation.
 *
 * @param name The unique identifyer used to store the snapshot
 */
 void Banker::savepoint(const string& name) {
-	// Store the current available vector under a given name
-    namedAvailable[name] = vector<int>(available, available + NUMBER_OF_RESOURCES);
-
-	// Create deep copies of current allocation and need matrices
-    vector<vector<int> > alloc(NUMBER_OF_CUSTOMERS, vector<int>(NUMBER_OF_RESOURCES));
-    vector<vector<int> > needM(NUMBER_OF_CUSTOMERS, vector<int>(NUMBER_OF_RESOURCES));
-
-	// Populate the temporary matrices with current system state
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i)
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-            alloc[i][j] = allocation[i][j];	// Copy allocation matrix
-            needM[i][j] = need[i][j];		// Copy need matrix
+    BinaryLog::record(BinaryLog::TYPE_SAVEPOINT, -1, 0, 0, 0, 0, 0, name);
+
+    const Savepoint* previous = NULL;
+    map<string, Savepoint>::const_iterator prev = savepoints.find(lastSavepoint);
+    if (prev != savepoints.end()) previous = &prev->second;
+
+    Savepoint fresh;
+    fresh.available.assign(available, available + numResources);
+    const int blockCount = (numCustomers + BANKER_SAVEPOINT_BLOCK_ROWS - 1) / BANKER_SAVEPOINT_BLOCK_ROWS;
+    fresh.blocks.resize(blockCount);
+    for (int b = 0; b < blockCount; ++b) {
+        const int first = b * BANKER_SAVEPOINT_BLOCK_ROWS;
+        const int rows = min(BANKER_SAVEPOINT_BLOCK_ROWS, numCustomers - first);
+
+        // Share the previous savepoint's block if none of its rows changed since
+        if (previous) {
+            SavepointBlock* candidate = previous->blocks[b];
+            bool same = true;
+            for (int r = 0; r < rows && same; ++r)
+                same = memcmp(&candidate->cells[(size_t)r * numResources],
+                              allocation + (size_t)(first + r) * rowStride, numResources * sizeof(int)) == 0;
+            if (same) {
+                candidate->refs++;
+                fresh.blocks[b] = candidate;
+                continue;
+            }
         }
 
-	// Save named copies into global savepoint maps
-    namedAllocation[name] = alloc;
-    namedNeed[name] = needM;
+        SavepointBlock* block = new SavepointBlock;
+        block->refs = 1;
+        block->cells.resize((size_t)rows * numResources);
+        for (int r = 0; r < rows; ++r) {
+            const int* allocRow = allocation + (size_t)(first + r) * rowStride;
+            copy(allocRow, allocRow + numResources, &block->cells[(size_t)r * numResources]);
+        }
+        fresh.blocks[b] = block;
+    }
+
+	// Replace any savepoint of the same name only now: 'fresh' may share its blocks
+    Savepoint& slot = savepoints[name];
+    releaseSavepoint(slot);
+    slot.available.swap(fresh.available);
+    slot.blocks.swap(fresh.blocks);
+    lastSavepoint = name;
 
 	// Log the savepoint creation event
     Logger::log("SAVEPOINT → Named savepoint \"" + name + "\" created", Logger::INFO);
 }
 
+/**
+ * @brief Drops a savepoint's references to its blocks, deleting those no other savepoint holds.
+ */
+void Banker::releaseSavepoint(Savepoint& sp) {
+    for (size_t b = 0; b < sp.blocks.size(); ++b)
+        if (--sp.blocks[b]->refs == 0) delete sp.blocks[b];
+    sp.blocks.clear();
+    sp.available.clear();
+}
+
+/**
+ * @brief Returns a savepoint's allocation row for one customer (numResources ints).
+ */
+const int* Banker::savedRow(const Savepoint& sp, int customer) const {
+    const SavepointBlock* block = sp.blocks[customer / BANKER_SAVEPOINT_BLOCK_ROWS];
+    return &block->cells[(size_t)(customer % BANKER_SAVEPOINT_BLOCK_ROWS) * numResources];
+}
+
+/**
+ * @brief Returns a savepoint's allocation row for one customer to modify, copying its block first if it is shared.
+ */
+int* Banker::writableSavedRow(Savepoint& sp, int customer) {
+    SavepointBlock*& block = sp.blocks[customer / BANKER_SAVEPOINT_BLOCK_ROWS];
+    if (block->refs > 1) {
+        SavepointBlock* own = new SavepointBlock;
+        own->refs = 1;
+        own->cells = block->cells;
+        block->refs--;
+        block = own;
+    }
+    return &block->cells[(size_t)(customer % BANKER_SAVEPOINT_BLOCK_ROWS) * numResources];
+}
+
+/**
+ * @brief Reports the memory each savepoint holds.
+ *
+ * A block held by k savepoints is charged 1/k to each of them. totalBytes counts every distinct block once;
+ * fullCopyBytes is what the same savepoints would take as full copies of available, allocation and need.
+ */
+void Banker::savepointUsage(vector<SavepointUsage>& usage, size_t& totalBytes, size_t& fullCopyBytes) {
+    flushDeadlockReports(); // Includes the automatic deadlock savepoint
+    usage.clear();
+    totalBytes = 0;
+    fullCopyBytes = 0;
+    set<const SavepointBlock*> counted;
+    for (map<string, Savepoint>::const_iterator it = savepoints.begin(); it != savepoints.end(); ++it) {
+        const Savepoint& sp = it->second;
+        SavepointUsage u;
+        u.name = it->first;
+        u.blocks = (int)sp.blocks.size();
+        u.sharedBlocks = 0;
+        u.ownBytes = sp.available.capacity() * sizeof(int) + sp.blocks.capacity() * sizeof(SavepointBlock*);
+        u.sharedBytes = 0;
+        totalBytes += u.ownBytes;
+        for (size_t b = 0; b < sp.blocks.size(); ++b) {
+            const SavepointBlock* block = sp.blocks[b];
+            const size_t bytes = sizeof(SavepointBlock) + block->cells.capacity() * sizeof(int);
+            if (block->refs > 1) {
+                u.sharedBlocks++;
+                u.sharedBytes += bytes / block->refs;
+            } else {
+                u.ownBytes += bytes;
+            }
+            if (counted.insert(block).second) totalBytes += bytes;
+        }
+        fullCopyBytes += (size_t)numResources * sizeof(int) * (1 + 2 * (size_t)numCustomers);
+        usage.push_back(u);
+    }
+}
+
 /**
 * @brief Restores the system state to a previously named savepoint
 *
@@ -673,35 +1719,59 @@ void Banker::savepoint(const string& name) {
 * @ return true if rollback succeeded, false if the savepoint does not exist
 */
 bool Banker::rollback(const string& name) {
+    flushDeadlockReports(); // May be rolling back to the automatic deadlock savepoint
 	// Check if the savepoint exists
-    if (namedAvailable.find(name) == namedAvailable.end()) {
+    map<string, Savepoint>::const_iterator found = savepoints.find(name);
+    if (found == savepoints.end()) {
         Logger::log("ROLLBACK → Failed: No savepoint \"" + name + "\"", Logger::WARN);
         cout << COLOR_RED << "[ERROR] No savepoint named \"" << name << "\" exists.\n" << COLOR_RESET;
         fullLog << "[ERROR] No savepoint named \"" << name << "\" exists.\n";
         return false;
     }
 
-	// Reference the saved matrices for efficiency
-    vector<int>& savedAvail = namedAvailable[name];
-    vector<vector<int> >& savedAlloc = namedAllocation[name];
-    vector<vector<int> >& savedNeed = namedNeed[name];
+    const Savepoint& saved = found->second;
+
+	// Record the rows that change, so the rollback itself can be undone
+    startUndoRecord();
+    vector<int> delta(numResources);
+    for (int i = 0; i < numCustomers; ++i) {
+        const int* savedAlloc = savedRow(saved, i);
+        const int* allocRow = allocation + (size_t)i * rowStride;
+        bool changed = false;
+        for (int j = 0; j < numResources; ++j) {
+            delta[j] = savedAlloc[j] - allocRow[j];
+            changed = changed || delta[j] != 0;
+        }
+        if (changed) addUndoRow(i, &delta[0], 1);
+    }
+    setUndoAvailable(&saved.available[0]);
+    commitUndoRecord();
 
 	// Restore available matrices
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j)
-        available[j] = savedAvail[j];
-
-	// Restore allocation and need matrices
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i)
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-            allocation[i][j] = savedAlloc[i][j];
-            need[i][j] = savedNeed[i][j];
+    beginWrite();
+    for (int j = 0; j < numResources; ++j)
+        available[j] = saved.available[j];
+
+	// Restore allocation, and need from it
+    for (int i = 0; i < numCustomers; ++i) {
+        const int* savedAlloc = savedRow(saved, i);
+        const int* maxRow = maximum + (size_t)i * rowStride;
+        int* allocRow = allocation + (size_t)i * rowStride;
+        int* needRow = need + (size_t)i * rowStride;
+        for (int j = 0; j < numResources; ++j) {
+            allocRow[j] = savedAlloc[j];
+            needRow[j] = maxRow[j] - savedAlloc[j];
         }
+    }
+    endWrite();
+    lastSavepoint = name;   // The state matches it again, so the next savepoint can share its blocks
 
     Logger::log("ROLLBACK → Reverted to savepoint \"" + name + "\"", Logger::INFO);
 
 	// Restore status flags
     lastDenialReason.clear();
     lastActiveCustomer = -1;
+    invalidateSafeOrder();
 
     return true;
 }
@@ -724,6 +1794,50 @@ bool Banker::isSafeSequenceEnabled() const {
     return showSafeSequence;
 }
 
+/**
+* @brief Selects which safety engine request() and simulateSequence() use.
+*
+* Selecting ENGINE_PARALLEL starts its worker pool (see setSafetyThreads()) if it is not running yet.
+*
+* @param engine ENGINE_CLASSIC (rescanning loop), ENGINE_INDEXED (sorted per-resource columns), ENGINE_VERIFY (run
+*               both and report any verdict mismatch), or ENGINE_PARALLEL (classic rounds on a worker pool)
+*/
+void Banker::setSafetyEngine(SafetyEngine engine) {
+    if (engine == ENGINE_PARALLEL && safetyPool == NULL) {
+        Kernels::init(); // Resolve the row kernels before the workers race on their first use
+        safetyPool = new ThreadPool(safetyThreads);
+    }
+    safetyEngine = engine;
+}
+
+/**
+* @brief Sets the number of ENGINE_PARALLEL workers, restarting the pool if it is running.
+*
+* @param threads Worker threads including the caller; less than 1 means one per online CPU.
+*/
+void Banker::setSafetyThreads(int threads) {
+    safetyThreads = threads;
+    if (safetyPool != NULL) {
+        delete safetyPool;
+        safetyPool = new ThreadPool(threads);
+    }
+}
+
+/**
+* @brief Returns the number of workers ENGINE_PARALLEL uses (or would use once selected).
+*/
+int Banker::getSafetyThreads() const {
+    if (safetyPool != NULL) return safetyPool->size();
+    return safetyThreads < 1 ? ThreadPool::hardwareThreads() : safetyThreads;
+}
+
+/**
+* @brief Returns the safety engine currently in use.
+*/
+Banker::SafetyEngine Banker::getSafetyEngine() const {
+    return safetyEngine;
+}
+
 /**
 * @brief Retrieves the reason why the last resource was denied.
 *
@@ -736,6 +1850,20 @@ string Banker::getLastDenialReason() const {
     return lastDenialReason.empty() ? "No request has been denied yet." : lastDenialReason;
 }
 
+/**
+* @brief Returns the last denial reason; for an unsafe denial by request(), followed by its diagnostics.
+*
+* The diagnostics (blocked customers, what each still needs, who holds it) are rendered here from the compact record
+* kept at denial time, not on the denial path itself.
+*/
+string Banker::explainLastDenial() {
+    flushDeadlockReports();
+    string reason = getLastDenialReason();
+    if (lastDenialHasReport && !lastDeadlockReport.empty())
+        reason += "\n" + lastDeadlockReport;
+    return reason;
+}
+
 /**
 * @brief Saves the current system state to a file.
 *
@@ -753,25 +1881,27 @@ void Banker::saveState(const string& filename) const {
 
     // Save the available resource vector
     out << "Available:";
-    for (int i = 0; i < NUMBER_OF_RESOURCES; ++i)
+    for (int i = 0; i < numResources; ++i)
         out << " " << available[i];
     out << "\n";
 
     // Save the maximum resource demands per process
     out << "Maximum:\n";
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
+    for (int i = 0; i < numCustomers; ++i) {
+        const int* maxRow = maximum + (size_t)i * rowStride;
         out << "P" << i << ":"; // Label each process row
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j)
-            out << " " << maximum[i][j];
+        for (int j = 0; j < numResources; ++j)
+            out << " " << maxRow[j];
         out << "\n";
     }
 
     // Save the currently allocated resources per process
     out << "Allocation:\n";
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
+    for (int i = 0; i < numCustomers; ++i) {
+        const int* allocRow = allocation + (size_t)i * rowStride;
         out << "P" << i << ":";
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j)
-            out << " " << allocation[i][j];
+        for (int j = 0; j < numResources; ++j)
+            out << " " << allocRow[j];
         out << "\n";
     }
     out.close(); // Finalize file write
@@ -798,56 +1928,307 @@ bool Banker::loadState(const string& filename) {
 
     string line;
 
+    // Parse into scratch buffers so a malformed or mis-sized file leaves the current state untouched
+    vector<int> availIn(numResources);
+    vector<int> maxIn((size_t)numCustomers * numResources);
+    vector<int> allocIn((size_t)numCustomers * numResources);
+
 	// Read available line
     getline(in, line);  // Line format: Available: x, y, z....
     stringstream ss(line);
     string label;
     ss >> label;  // skip "Available:"
-    for (int i = 0; i < NUMBER_OF_RESOURCES; ++i)
-        ss >> available[i]; // Load available resources
+    for (int i = 0; i < numResources; ++i)
+        if (!(ss >> availIn[i])) return false; // Load available resources
 
 	// Read maximum matrix
     getline(in, line);  // Skip line "Maximum:"
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
+    for (int i = 0; i < numCustomers; ++i) {
         getline(in, line); // Line format: "P0: x, y, z..."
         stringstream cs(line);
         cs >> label; // Skip "P#"
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j)
-            cs >> maximum[i][j]; // Load maximum resource demand
+        for (int j = 0; j < numResources; ++j)
+            if (!(cs >> maxIn[(size_t)i * numResources + j])) return false; // Load maximum resource demand
     }
 
 	// Read allocation matrix
     getline(in, line);  // Skip line "Allocation:"
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
+    for (int i = 0; i < numCustomers; ++i) {
         getline(in, line); // Line format: "P0: x, y, z..."
         stringstream cs(line);
         cs >> label; // Skip "P#"
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j)
-            cs >> allocation[i][j]; // Load allocated resources
+        for (int j = 0; j < numResources; ++j)
+            if (!(cs >> allocIn[(size_t)i * numResources + j])) return false; // Load allocated resources
     }
 
+    // Commit the parsed state into the padded buffers
+    WriteSection section(*this);
+    for (int j = 0; j < numResources; ++j)
+        available[j] = availIn[j];
+    for (int i = 0; i < numCustomers; ++i)
+        for (int j = 0; j < numResources; ++j) {
+            maximum[(size_t)i * rowStride + j] = maxIn[(size_t)i * numResources + j];
+            allocation[(size_t)i * rowStride + j] = allocIn[(size_t)i * numResources + j];
+        }
+
     // Compute need matrix
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i)
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j)
-            need[i][j] = maximum[i][j] - allocation[i][j];
+    calculateNeed();
+    invalidateSafeOrder();
+    clearUndoHistory(); // The maximum claims may have changed too
 
     return true; // Successfully loaded all data
 }
 
+// Fixed 64-byte header of a binary checkpoint; the arrays follow at the given offsets, each on a cache line
+struct CheckpointHeader {
+    char magic[8];                      // BANKER_CHECKPOINT_MAGIC
+    unsigned int version;               // BANKER_CHECKPOINT_VERSION
+    unsigned int customers;
+    unsigned int resources;
+    unsigned int rowStride;             // Ints per row in the file (rows are stored padded, as in memory)
+    unsigned long long availableOffset; // Bytes from the start of the file
+    unsigned long long maximumOffset;
+    unsigned long long allocationOffset;
+    unsigned long long checksum;        // checkpointChecksum() of the header (with this field 0) and the arrays
+};
+
+static size_t alignToCacheLine(size_t bytes) {
+    return (bytes + BANKER_CACHE_LINE - 1) / BANKER_CACHE_LINE * BANKER_CACHE_LINE;
+}
+
+// Fletcher-style checksum over 32-bit words with two 64-bit running sums; continues from 'sums'
+static void checkpointChecksum(unsigned long long sums[2], const void* data, size_t bytes) {
+    const unsigned int* p = (const unsigned int*)data;
+    unsigned long long a = sums[0], b = sums[1];
+    for (size_t k = 0, words = bytes / 4; k < words; ++k) {
+        a += p[k];
+        b += a;
+    }
+    sums[0] = a;
+    sums[1] = b;
+}
+
+static bool writeFully(int fd, const void* data, size_t bytes) {
+    const char* p = (const char*)data;
+    while (bytes > 0) {
+        ssize_t n = ::write(fd, p, bytes);
+        if (n <= 0) return false;
+        p += n;
+        bytes -= n;
+    }
+    return true;
+}
+
+/**
+ * @brief Saves Available, the maximum and the allocation matrix as a binary checkpoint.
+ *
+ * The arrays are written straight from the padded buffers (one write() each), after a header with the dimensions,
+ * the array offsets and a checksum. The file is written under filename + ".tmp", synced and renamed over 'filename',
+ * so a crash leaves either the old checkpoint or the new one. Need is not stored; loadBinary() recomputes it.
+ *
+ * @param filename Checkpoint to write (e.g. logs/save.bin).
+ * @return true if the checkpoint was written and renamed into place.
+ */
+bool Banker::saveBinary(const string& filename) const {
+    size_t vectorBytes = (size_t)rowStride * sizeof(int);
+    size_t matrixBytes = (size_t)numCustomers * rowStride * sizeof(int);
+    CheckpointHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, BANKER_CHECKPOINT_MAGIC, sizeof(h.magic));
+    h.version = BANKER_CHECKPOINT_VERSION;
+    h.customers = numCustomers;
+    h.resources = numResources;
+    h.rowStride = rowStride;
+    h.availableOffset = alignToCacheLine(sizeof(h));
+    h.maximumOffset = alignToCacheLine(h.availableOffset + vectorBytes);
+    h.allocationOffset = alignToCacheLine(h.maximumOffset + matrixBytes);
+
+    unsigned long long sums[2] = { 0, 0 };
+    checkpointChecksum(sums, &h, sizeof(h));
+    checkpointChecksum(sums, available, vectorBytes);
+    checkpointChecksum(sums, maximum, matrixBytes);
+    checkpointChecksum(sums, allocation, matrixBytes);
+    h.checksum = sums[0] ^ (sums[1] << 1);
+
+    string tmp = filename + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    static const char zeros[BANKER_CACHE_LINE] = { 0 };
+    bool ok = writeFully(fd, &h, sizeof(h))
+              && writeFully(fd, zeros, h.availableOffset - sizeof(h))
+              && writeFully(fd, available, vectorBytes)
+              && writeFully(fd, zeros, h.maximumOffset - h.availableOffset - vectorBytes)
+              && writeFully(fd, maximum, matrixBytes)
+              && writeFully(fd, zeros, h.allocationOffset - h.maximumOffset - matrixBytes)
+              && writeFully(fd, allocation, matrixBytes)
+              && fsync(fd) == 0;
+    ok = (::close(fd) == 0) && ok;
+    if (!ok || rename(tmp.c_str(), filename.c_str()) != 0) {
+        remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Loads a checkpoint written by saveBinary().
+ *
+ * The file is mmap()ed read-only and validated (magic, version, dimensions, offsets and checksum) before anything
+ * changes. The arrays are then copied into the live buffers with one memcpy() each (row by row if the file was
+ * written with a different row padding) and need is recomputed with the vectorized row kernel.
+ *
+ * @param filename Checkpoint to read (e.g. logs/save.bin).
+ * @return true if loaded; false, with the state untouched, if the file is missing, damaged or for other dimensions.
+ */
+bool Banker::loadBinary(const string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CheckpointHeader)) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = st.st_size;
+    void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return false;
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    const char* base = (const char*)map;
+    CheckpointHeader h;
+    memcpy(&h, base, sizeof(h));
+    size_t fileStride = h.rowStride;
+    size_t vectorBytes = fileStride * sizeof(int);
+    size_t matrixBytes = (size_t)h.customers * fileStride * sizeof(int);
+    bool ok = memcmp(h.magic, BANKER_CHECKPOINT_MAGIC, sizeof(h.magic)) == 0
+              && h.version == BANKER_CHECKPOINT_VERSION
+              && (int)h.customers == numCustomers && (int)h.resources == numResources
+              && fileStride >= (size_t)numResources
+              && h.availableOffset % BANKER_CACHE_LINE == 0 && h.availableOffset + vectorBytes <= size
+              && h.maximumOffset % BANKER_CACHE_LINE == 0 && h.maximumOffset + matrixBytes <= size
+              && h.allocationOffset % BANKER_CACHE_LINE == 0 && h.allocationOffset + matrixBytes <= size;
+    if (ok) {
+        unsigned long long stored = h.checksum;
+        h.checksum = 0;
+        unsigned long long sums[2] = { 0, 0 };
+        checkpointChecksum(sums, &h, sizeof(h));
+        checkpointChecksum(sums, base + h.availableOffset, vectorBytes);
+        checkpointChecksum(sums, base + h.maximumOffset, matrixBytes);
+        checkpointChecksum(sums, base + h.allocationOffset, matrixBytes);
+        ok = (sums[0] ^ (sums[1] << 1)) == stored;
+    }
+    if (!ok) {
+        munmap(map, size);
+        return false;
+    }
+
+    const int* fileAvailable = (const int*)(base + h.availableOffset);
+    const int* fileMaximum = (const int*)(base + h.maximumOffset);
+    const int* fileAllocation = (const int*)(base + h.allocationOffset);
+    {
+        WriteSection section(*this);
+        copy(fileAvailable, fileAvailable + numResources, available);
+        if (fileStride == (size_t)rowStride) {
+            memcpy(maximum, fileMaximum, matrixBytes);
+            memcpy(allocation, fileAllocation, matrixBytes);
+        } else {
+            for (int i = 0; i < numCustomers; ++i) {
+                copy(fileMaximum + i * fileStride, fileMaximum + i * fileStride + numResources,
+                     maximum + (size_t)i * rowStride);
+                copy(fileAllocation + i * fileStride, fileAllocation + i * fileStride + numResources,
+                     allocation + (size_t)i * rowStride);
+            }
+        }
+        calculateNeed();
+    }
+    munmap(map, size);
+    invalidateSafeOrder();
+    clearUndoHistory(); // The maximum claims may have changed too
+    return true;
+}
+
+/**
+ * @brief Re-applies a request that was granted before a restart (journal recovery).
+ *
+ * The safety check is not repeated: the request was safe against the same state when it was first decided. Only the
+ * bounds are checked, so a journal replayed onto the wrong base state stops instead of corrupting the matrices.
+ *
+ * @return true if applied; false (nothing changed) if it exceeds the customer's need or the available units.
+ */
+bool Banker::replayRequest(int customerNum, const int request[]) {
+    if (customerNum < 0 || customerNum >= numCustomers) return false;
+    int* allocRow = allocation + (size_t)customerNum * rowStride;
+    int* needRow = need + (size_t)customerNum * rowStride;
+    for (int j = 0; j < numResources; ++j)
+        if (request[j] < 0 || request[j] > needRow[j] || request[j] > available[j]) return false;
+    copy(request, request + numResources, requestRow);
+    commitGrant(allocRow, needRow);
+    invalidateSafeOrder();
+    clearUndoHistory(); // Not recorded, so nothing before it can be undone
+    return true;
+}
+
+/**
+ * @brief Re-applies a release from before a restart (journal recovery).
+ *
+ * @return true if applied; false (nothing changed) if it exceeds the customer's allocation.
+ */
+bool Banker::replayRelease(int customerNum, const int rel[]) {
+    if (customerNum < 0 || customerNum >= numCustomers) return false;
+    const int* allocRow = allocation + (size_t)customerNum * rowStride;
+    for (int j = 0; j < numResources; ++j)
+        if (rel[j] < 0 || rel[j] > allocRow[j]) return false;
+    copy(rel, rel + numResources, requestRow);
+    {
+        WriteSection section(*this);
+        Kernels::releaseRow(available, allocation + (size_t)customerNum * rowStride,
+                            need + (size_t)customerNum * rowStride, requestRow, rowStride);
+    }
+    clearUndoHistory(); // Not recorded, so nothing before it can be undone; the cached safe order stays valid
+    return true;
+}
+
+/**
+ * @brief Replaces Available, the allocation matrix and the maximum claims (journal recovery of reset, undo, redo,
+ * rollback and load).
+ *
+ * @param avail numResources units.
+ * @param alloc numCustomers rows of numResources units, without padding.
+ * @param max numCustomers rows of numResources units, without padding.
+ */
+void Banker::replaceState(const int avail[], const int alloc[], const int max[]) {
+    {
+        WriteSection section(*this);
+        copy(avail, avail + numResources, available);
+        for (int i = 0; i < numCustomers; ++i) {
+            copy(alloc + (size_t)i * numResources, alloc + (size_t)(i + 1) * numResources,
+                 allocation + (size_t)i * rowStride);
+            copy(max + (size_t)i * numResources, max + (size_t)(i + 1) * numResources,
+                 maximum + (size_t)i * rowStride);
+        }
+        calculateNeed();                // Nested: readers never see the old need with the new allocation
+    }
+    invalidateSafeOrder();
+    clearUndoHistory();
+}
+
 /**
  * @brief Checks if a resource request can be granted.
  *
  * Validates that the request does not exceed the customer's remaining need
  * or the currently available resources. This does not check for system safety.
  *
+ * @param base State to check against (a snapshot from readSnapshot(), or currentView()).
  * @param customerNum Index of the requesting customer.
  * @param request Resource amounts requested per type.
  * @return true if request is valid and grantable; false otherwise.
  */
-bool Banker::wouldGrantRequest(int customerNum, const int request[]) const {
-    for (int i = 0; i < NUMBER_OF_RESOURCES; ++i) {
+bool Banker::wouldGrantRequest(const StateView& base, int customerNum, const int request[]) const {
+    const int* needRow = base.needRow(customerNum);
+    const int* available = base.available;
+    for (int i = 0; i < numResources; ++i) {
 		// Check 1: Does request exceed remaining need?
-        if (request[i] > need[customerNum][i])
+        if (request[i] > needRow[i])
             return false; // request exceeds declared need
 
 		// Check 2: Does request exceed what is available?
@@ -863,64 +2244,98 @@ bool Banker::wouldGrantRequest(int customerNum, const int request[]) const {
 * This method simulates granting a resource request and runs the Banker's safety check to dtermine if the system would
 * still be in a safe state.
 *
+* @param base State to simulate from (a snapshot from readSnapshot(), or currentView()).
 * @param customerNum Index of the customer making the request
 * @param request Resource amounts requested.
 * @return A vector representing a safe state sequence of customer execution. Returns an empty vector if the system
 * 		  would be unsafe
 */
-vector<int> Banker::simulateSequence(int customerNum, const int request[]) {
-    int work[NUMBER_OF_RESOURCES]; // Temporary resource tracker
-    bool finish[NUMBER_OF_CUSTOMERS]; // Tracks which process can finish
-    int allocCopy[NUMBER_OF_CUSTOMERS][NUMBER_OF_RESOURCES]; // Simulated allocations
-    int needCopy[NUMBER_OF_CUSTOMERS][NUMBER_OF_RESOURCES]; // Simulated needs
-
-    // Clone current system state
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-            allocCopy[i][j] = allocation[i][j];
-            needCopy[i][j] = need[i][j];
-        }
-        finish[i] = false;
-    }
+vector<int> Banker::simulateSequence(const StateView& base, int customerNum, const int request[]) {
+    TentativeRows rows;  // Simulated available vector and the requester's rows
+    vector<bool> finish; // Tracks which process can finish
+    vector<int> safeSeq;
 
-	// Simulate the request
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-        allocCopy[customerNum][j] += request[j];
-        needCopy[customerNum][j] -= request[j];
-    }
+	// Try to build a safe sequence with the selected engine, as if the request were granted
+    if (!runSafetyEngine(tentativeView(base, customerNum, request, rows), safeSeq, finish))
+        return vector<int>(); // return empty vector if not safe
 
-    vector<int> safeSeq;
+    return safeSeq; // safe sequence found
+}
 
-	// Try to build a safe sequence
-    bool progress = true;
-    while (progress) {
-        progress = false;
-        for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
-            if (!finish[i]) {
-                bool canFinish = true;
-                for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-                    if (needCopy[i][j] > work[j]) {
-                        canFinish = false;
-                        break;
-                    }
-                }
-                if (canFinish) {
-                    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j)
-                        work[j] += allocCopy[i][j]; // Release resources
-                    finish[i] = true;
-                    safeSeq.push_back(i); // Add to safe sequence
-                    progress = true;
-                }
-            }
-        }
-    }
+/**
+* @brief Side-effect-free version of wouldGrantRequest() + simulateSequence() for concurrent readers.
+*
+* Uses its own scratch rows and the pure safety kernel, so any number of threads may call it at once while no thread
+* is writing the state behind 'base'.
+*
+* @param base State to evaluate against (currentView() or a consistent copy).
+* @param customerNum Index of the customer making the request.
+* @param request Resource amounts requested.
+* @param sequence Receives the safe sequence if the request would be granted.
+* @return The RequestResult request() would return, without changing anything.
+*/
+int Banker::previewRequest(const StateView& base, int customerNum, const int request[], vector<int>& sequence) const {
+    TentativeRows rows;
+    vector<bool> finish;
+    return previewWith(base, customerNum, request, sequence, rows, finish);
+}
 
-	// If any process is not finished, system is not safe
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i)
-        if (!finish[i])
-            return vector<int>(); // return empty vector if not safe
+// previewRequest() with caller-owned scratch, so repeated previews allocate nothing once the scratch has grown
+int Banker::previewWith(const StateView& base, int customerNum, const int request[], vector<int>& sequence,
+                        TentativeRows& rows, vector<bool>& finish) const {
+    sequence.clear();
+    const int* needRow = base.needRow(customerNum);
+    for (int j = 0; j < numResources; ++j)
+        if (request[j] > needRow[j]) return DENIED_NEED;
+    for (int j = 0; j < numResources; ++j)
+        if (request[j] > base.available[j]) return DENIED_AVAIL;
+
+    return evaluateSafety(tentativeView(base, customerNum, request, rows), sequence, finish) ? GRANTED : DENIED_UNSAFE;
+}
 
-    return safeSeq; // safe sequence found
+struct Banker::PreviewJob {
+    const Banker* banker;
+    const StateView* base;
+    const vector<BatchRequest>* candidates;
+    vector<int>* verdicts;
+    vector<vector<int> >* sequences;
+    vector<PreviewScratch> scratch;     // One per pool worker
+};
+
+void Banker::previewTask(void* arg, long index, int worker) {
+    PreviewJob* job = static_cast<PreviewJob*>(arg);
+    const BatchRequest& candidate = (*job->candidates)[index];
+    PreviewScratch& scratch = job->scratch[worker];
+    (*job->verdicts)[index] = job->banker->previewWith(*job->base, candidate.customer, &candidate.amounts[0],
+                                                       (*job->sequences)[index], scratch.rows, scratch.finish);
+}
+
+/**
+ * @brief Previews a whole file's worth of candidate requests in parallel.
+ *
+ * Every candidate is checked against the same read-only base view, as if it were the only request, so candidates are
+ * independent and can run in any order. Each worker overlays candidates with its own scratch rows instead of copying
+ * the matrices, and the pool's work stealing evens out candidates whose safety checks take very different times.
+ *
+ * @param base The state to evaluate against (e.g. a readSnapshot() view); must not change during the call.
+ * @param candidates Validated requests (customer in range, one non-negative amount per resource).
+ * @param verdicts Receives one RequestResult per candidate.
+ * @param sequences Receives the safe sequence of each candidate that would be granted (empty otherwise).
+ * @param pool Workers to spread the candidates over.
+ */
+void Banker::previewMany(const StateView& base, const vector<BatchRequest>& candidates, vector<int>& verdicts,
+                         vector<vector<int> >& sequences, ThreadPool& pool) const {
+    verdicts.assign(candidates.size(), INVALID_REQUEST);
+    sequences.assign(candidates.size(), vector<int>());
+
+    PreviewJob job;
+    job.banker = this;
+    job.base = &base;
+    job.candidates = &candidates;
+    job.verdicts = &verdicts;
+    job.sequences = &sequences;
+    job.scratch.resize(pool.size());
+    pool.parallelFor((long)candidates.size(), previewTask, &job);
 }
 
 /**
@@ -934,43 +2349,55 @@ vector<int> Banker::simulateSequence(int customerNum, const int request[]) {
  *         false if the savepoint is missing.
  */
 bool Banker::compareToSavepoint(const string& name) {
-	// Check if savepoint exists in all 3 stored maps
-    if (namedAvailable.find(name) == namedAvailable.end() ||
-        namedAllocation.find(name) == namedAllocation.end() ||
-        namedNeed.find(name) == namedNeed.end()) {
+    flushDeadlockReports();
+	// Check if savepoint exists
+    map<string, Savepoint>::const_iterator found = savepoints.find(name);
+    if (found == savepoints.end()) {
         cout << "[COMPARE] Savepoint \"" << name << "\" not found.\n";
         return false;
         }
+    const Savepoint& saved = found->second;
+
+    StateSnapshot snap;
+    readSnapshot(snap); // Compare against the published copy
+    const int* available = &snap.available[0];
+    const int* allocation = &snap.allocation[0];
+    const int* maximum = &snap.maximum[0];
+    const int* need = &snap.need[0];
 
     bool changes = false; // Tracks if any mismatch is found
 
     // Comparing allocation matrix
-    const vector<vector<int> >& savedAlloc = namedAllocation[name];
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-            if (allocation[i][j] != savedAlloc[i][j]) {
+    for (int i = 0; i < numCustomers; ++i) {
+        const int* allocRow = allocation + (size_t)i * rowStride;
+        const int* savedAlloc = savedRow(saved, i);
+        for (int j = 0; j < numResources; ++j) {
+            if (allocRow[j] != savedAlloc[j]) {
                 cout << "Allocation mismatch P" << i << " R" << j
-                     << ": now " << allocation[i][j]
-                     << ", was " << savedAlloc[i][j] << "\n";
+                     << ": now " << allocRow[j]
+                     << ", was " << savedAlloc[j] << "\n";
                 changes = true;
             }
         }
     }
     // Comparing need matrix
-    const vector<vector<int> >& savedNeed = namedNeed[name];
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-            if (need[i][j] != savedNeed[i][j]) {
+    for (int i = 0; i < numCustomers; ++i) {
+        const int* needRow = need + (size_t)i * rowStride;
+        const int* maxRow = maximum + (size_t)i * rowStride;
+        const int* savedAlloc = savedRow(saved, i);
+        for (int j = 0; j < numResources; ++j) {
+            const int savedNeed = maxRow[j] - savedAlloc[j];
+            if (needRow[j] != savedNeed) {
                 cout << "Need mismatch P" << i << " R" << j
-                     << ": now " << need[i][j]
-                     << ", was " << savedNeed[i][j] << "\n";
+                     << ": now " << needRow[j]
+                     << ", was " << savedNeed << "\n";
                 changes = true;
             }
         }
     }
     // Comparing available matrix
-    const vector<int>& savedAvail = namedAvailable[name];
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
+    const vector<int>& savedAvail = saved.available;
+    for (int j = 0; j < numResources; ++j) {
         if (available[j] != savedAvail[j]) {
             cout << "Available mismatch R" << j
                  << ": now " << available[j]
@@ -997,50 +2424,62 @@ bool Banker::compareToSavepoint(const string& name) {
  * @return true if comparison was performed (savepoint exists), false if savepoint not found.
  */
 bool Banker::diffFromSavepoint(const string& name, bool display) {
-	// Validating savepoint existence in all three tracked maps
-    if (namedAvailable.find(name) == namedAvailable.end() ||
-        namedAllocation.find(name) == namedAllocation.end() ||
-        namedNeed.find(name) == namedNeed.end()) {
+    flushDeadlockReports();
+	// Validating savepoint existence
+    map<string, Savepoint>::const_iterator found = savepoints.find(name);
+    if (found == savepoints.end()) {
         if (display) {
             cout << COLOR_RED << "[DIFF] Savepoint \"" << name << "\" not found.\n" << COLOR_RESET;
             fullLog << "[DIFF] Savepoint \"" << name << "\" not found.\n";
         }
         return false;
     }
+    const Savepoint& saved = found->second;
+
+    StateSnapshot snap;
+    readSnapshot(snap); // Compare against the published copy
+    const int* available = &snap.available[0];
+    const int* allocation = &snap.allocation[0];
+    const int* maximum = &snap.maximum[0];
+    const int* need = &snap.need[0];
 
     bool changes = false;
 
     if (display) cout << COLOR_CYAN << "[DIFF] Comparing to savepoint \"" << name << "\"\n" << COLOR_RESET;
 
 	// Diff allocation
-    const vector<vector<int> >& savedAlloc = namedAllocation[name];
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-            if (allocation[i][j] != savedAlloc[i][j]) {
+    for (int i = 0; i < numCustomers; ++i) {
+        const int* allocRow = allocation + (size_t)i * rowStride;
+        const int* savedAlloc = savedRow(saved, i);
+        for (int j = 0; j < numResources; ++j) {
+            if (allocRow[j] != savedAlloc[j]) {
                 if (display)
                     cout << "  Allocation P" << i << " R" << j
-                         << " → now " << allocation[i][j]
-                         << ", was " << savedAlloc[i][j] << "\n";
+                         << " → now " << allocRow[j]
+                         << ", was " << savedAlloc[j] << "\n";
                 changes = true;
             }
         }
     }
 	// Diff need
-    const vector<vector<int> >& savedNeed = namedNeed[name];
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
-            if (need[i][j] != savedNeed[i][j]) {
+    for (int i = 0; i < numCustomers; ++i) {
+        const int* needRow = need + (size_t)i * rowStride;
+        const int* maxRow = maximum + (size_t)i * rowStride;
+        const int* savedAlloc = savedRow(saved, i);
+        for (int j = 0; j < numResources; ++j) {
+            const int savedNeed = maxRow[j] - savedAlloc[j];
+            if (needRow[j] != savedNeed) {
                 if (display)
                     cout << "  Need P" << i << " R" << j
-                         << " → now " << need[i][j]
-                         << ", was " << savedNeed[i][j] << "\n";
+                         << " → now " << needRow[j]
+                         << ", was " << savedNeed << "\n";
                 changes = true;
             }
         }
     }
 	// Diff available
-    const vector<int>& savedAvail = namedAvailable[name];
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) {
+    const vector<int>& savedAvail = saved.available;
+    for (int j = 0; j < numResources; ++j) {
         if (available[j] != savedAvail[j]) {
             if (display)
                 cout << "  Available R" << j
@@ -6,87 +6,323 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <ctime>
+#include <iosfwd>
+#include "safety.h"
+#include "thread_pool.h"
 
-#define NUMBER_OF_CUSTOMERS 5
-#define NUMBER_OF_RESOURCES 4
+// Matrix rows are padded to a multiple of BANKER_ROW_ALIGN ints and every buffer starts on a cache line.
+// BANKER_ROW_ALIGN must be a multiple of KERNEL_LANES (kernels.h) so the SIMD row kernels never need a scalar tail.
+#define BANKER_CACHE_LINE 64
+#define BANKER_ROW_ALIGN 8
+#define BANKER_DEADLOCK_PENDING_MAX 64  // Unsafe denials buffered before their diagnostics are written out
+#define BANKER_CHECKPOINT_MAGIC "ZBCHKPT1"
+#define BANKER_CHECKPOINT_VERSION 1
+#define BANKER_SAVEPOINT_BLOCK_ROWS 8   // Allocation rows per copy-on-write savepoint block
+#define BANKER_UNDO_BUDGET (1 << 20)    // Default bytes for the undo/redo operation log
 
 class Banker {
 public:
-    Banker();                                          // Constructor: initializes all source metrics and arrays to be 0
-    void setAvailable(int res[]);                      // Loads minimum demand matrix from input file
+    Banker(int customers, int resources);              // Constructor: sizes all matrices and initializes them to 0
+    ~Banker();                                         // Releases the aligned matrix buffers
+
+    static int countDemandRows(const std::string& filename);  // Counts customer rows in a max demand file (-1 on error)
+
+    int getNumCustomers() const;                              // Number of customers (rows)
+    int getNumResources() const;                              // Number of resource types (columns)
+    int getRowStride() const;                                 // Ints between the start of consecutive rows
+
+    void setAvailable(const int res[]);                       // Loads minimum demand matrix from input file
     bool loadMaximumFromFile(const std::string& filename);    // Loads max demand matrix from input file
     void calculateNeed();                                     // Computes the need matrix from input file
     int request(int customerNum, int request[]);              // Attempts to allocate requested resources if safe
-    void release(int customerNum, int release[]);             // Releases held resources back to the system
-    void snapshot();                                          // Saves a backup of current status state
-    void restore();                                           // Restores system state from last snapshot
+    void release(int customerNum, const int release[]);           // Releases held resources back to the system
     void reset();
     void printState() const;                                  // Displays current state: available, max, alloc, need
     void printReport() const;                                 // Prints system resource report
     void toggleSafeSequence();                                // Toggles the display of safe sequence
     bool isSafeSequenceEnabled() const;                       // Returns whether safe sequence is enabled
 
-	// Utility to print formatted matrix
-    void printMatrix(const std::string& title, const int matrix[NUMBER_OF_CUSTOMERS][NUMBER_OF_RESOURCES]) const;
+    enum SafetyEngine {
+        ENGINE_CLASSIC = 0,     // Rescan every unfinished customer until no progress: O(n^2 * m)
+        ENGINE_INDEXED = 1,     // Per-resource need orderings with blocking counts: O(n * m * log n)
+        ENGINE_VERIFY = 2,      // Run both on the same state and report verdict mismatches
+        ENGINE_PARALLEL = 3     // Rounds of classic passes split across a worker pool
+    };
+    void setSafetyEngine(SafetyEngine engine);                // Selects the engine used by request()/simulateSequence()
+    SafetyEngine getSafetyEngine() const;                     // Returns the engine currently in use
+    void setSafetyThreads(int threads);                       // Workers for ENGINE_PARALLEL (< 1: one per CPU)
+    int getSafetyThreads() const;
+
+	// Utility to print formatted matrix (row-major, getRowStride() ints per row)
+    void printMatrix(const std::string& title, const int* matrix) const;
 
-    void saveUndoSnapshot();                                  // Called on `snapshot` command
-    void restoreUndoSnapshot();                               // Called on `undo` command
+    void saveUndoSnapshot();                                  // Called on `snapshot` command: marks the undo log
+    bool restoreUndoSnapshot();                               // Called on `undo` command: undoes/redoes to the mark
+
+    // Multi-level undo over an operation log. Every granted request, release, RQB batch, reset and rollback is kept
+    // as the change it made to Available and to the allocation rows it touched, in a ring capped at the budget; the
+    // oldest operations are dropped to make room. Loads, and anything else that replaces the state, clear it.
+    int undo(int count);                                      // Reverts up to count operations; returns how many
+    int redo(int count);                                      // Re-applies up to count undone operations
+    void setUndoBudget(size_t bytes);                         // Keeps the newest operations that fit; 0 turns it off
+    struct UndoStats {
+        size_t budgetBytes;
+        size_t usedBytes;           // Undoable and redoable operations
+        int undoable;
+        int redoable;
+        long evicted;               // Dropped to stay within the budget
+        bool hasMark;               // A snapshot mark is still reachable
+    };
+    UndoStats undoStats() const;
     void savepoint(const std::string& name);                  // Savepoint command
     bool rollback(const std::string& name);                  // Rollback to savepoint
     bool compareToSavepoint (const std::string& name);		 // Compares current state to savepoint (prints diffs)
     bool diffFromSavepoint(const std::string& name, bool display = true); // Diffs & optionally displays results
 
-    const int (*getAllocation() const) [NUMBER_OF_RESOURCES]; // Getter for allocation matrix (used externally)
+    // Memory held by one savepoint. Blocks shared with other savepoints are charged to each holder by share.
+    struct SavepointUsage {
+        std::string name;
+        int blocks;                 // Allocation blocks referenced
+        int sharedBlocks;           // ... of which other savepoints also reference
+        size_t ownBytes;            // Available plus the blocks only this savepoint holds
+        size_t sharedBytes;         // Its share of the shared blocks
+    };
+    void savepointUsage(std::vector<SavepointUsage>& usage, size_t& totalBytes, size_t& fullCopyBytes);
+
+    const int* getAllocation() const; // Getter for allocation matrix (row-major, getRowStride() ints per row)
 
     enum RequestResult {
         GRANTED = 0,
         DENIED_NEED = -1,		// Rejected due to exceeding declared max need
         DENIED_AVAIL = -2,		// Rejected due to insufficient available resources
-        DENIED_UNSAFE = -3		// Rejected due to unsafe system state
+        DENIED_UNSAFE = -3,		// Rejected due to unsafe system state
+        INVALID_REQUEST = -4	// Rejected before any check: bad customer ID or negative values (ConcurrentBanker)
     };
 
     std::string getLastDenialReason() const; // Explanation of last rejected request
+    std::string explainLastDenial();         // Same, plus the blocked customers for an unsafe denial
+    void flushDeadlockReports();             // Writes buffered unsafe denials to deadlock_log.csv and the auto savepoint
 
     void saveState(const std::string& filename) const; // Dumps system state to file
     bool loadState(const std::string& filename);	   // Loads system from file
+    bool saveBinary(const std::string& filename) const; // Binary checkpoint, written to a temp file then renamed
+    bool loadBinary(const std::string& filename);       // mmap()s a saveBinary() file; false (state untouched) if invalid
 
-	bool wouldGrantRequest(int customerNum, const int request[]) const; // Pre-checks if request is valid
-	std::vector<int> simulateSequence(int customerNum, const int request[]); // Simulates safe sequence if granted req
+    // Journal replay (see journal.h): re-applies operations that were already decided, checking only the bounds
+    bool replayRequest(int customerNum, const int request[]);  // false (nothing changed) if over need or available
+    bool replayRelease(int customerNum, const int release[]);  // false (nothing changed) if over the allocation
+    void replaceState(const int avail[], const int alloc[], const int max[]); // Packed numResources ints per row; need recomputed
+
+	bool wouldGrantRequest(const StateView& base, int customerNum, const int request[]) const; // Pre-checks request
+	std::vector<int> simulateSequence(const StateView& base, int customerNum, const int request[]); // Safe sequence if granted
+    int previewRequest(const StateView& base, int customerNum, const int request[],
+                       std::vector<int>& sequence) const;              // Pure, thread-safe
+
+    // How commitRequest() reached its decision
+    enum CommitPath {
+        PATH_VALIDATION = 0,    // Denied by the need or available check
+        PATH_FINISH_FIRST = 1,  // Granted because the requester can still finish first
+        PATH_ORDER_REPLAY = 2,  // Granted by re-verifying the cached safe order
+        PATH_FULL_CHECK = 3     // Decided by a full safety check
+    };
+    // Silent decision core of request(): no output or stats; callers must serialize writers
+    int commitRequest(int customerNum, const int request[], CommitPath& path,
+                      std::vector<int>& sequence, std::vector<bool>& finish, std::vector<int>* finalWork = 0);
+
+    StateView currentView() const;                             // Read-only view of the live matrices
+    bool evaluateSafety(const StateView& view, std::vector<int>& sequence, std::vector<bool>& finish,
+                        std::vector<int>* finalWork = 0) const; // Pure
+
+    // Lock-free releases: while enabled, releaseConcurrent() may run on any number of threads alongside one
+    // commitRequest() caller. Toggle only while no other thread is using the Banker.
+    void setConcurrentReleases(bool enabled);
+    bool releaseConcurrent(int customerNum, const int release[]);   // false (nothing changed) if more than held
+
+    // Consistent copy of the state for readers (padded like the live buffers, getRowStride() ints per row)
+    struct StateSnapshot {
+        std::vector<int> available;
+        std::vector<int> maximum;
+        std::vector<int> allocation;
+        std::vector<int> need;
+        unsigned version;                   // getStateVersion() the copy was taken at
+        int numCustomers;
+        int numResources;
+        int rowStride;
+        StateView view() const;
+    };
+    void readSnapshot(StateSnapshot& snap) const;   // Never blocks writers; retries while one is mid-write
+    unsigned getStateVersion() const;               // Bumped after every completed write
+
+    // One entry of a batch request: the customer and one amount per resource type
+    struct BatchRequest {
+        int customer;
+        std::vector<int> amounts;
+    };
+    enum BatchOrder {
+        BATCH_FIFO = 0,             // Decide requests in the order given
+        BATCH_SMALLEST_FIRST = 1    // Decide smaller requests (fewest total units) first; ties keep their order
+    };
+    // Decides a whole batch with as few safety checks as possible; verdicts[k] is a RequestResult for batch[k].
+    // Returns the number of safety checks run.
+    int requestBatch(const std::vector<BatchRequest>& batch, std::vector<int>& verdicts,
+                     BatchOrder order = BATCH_FIFO);
+    // Previews every candidate against the same base state, spread over pool's workers. verdicts[k] is a
+    // RequestResult for candidates[k] and sequences[k] the safe sequence if it would be granted. Candidates must
+    // already be validated. Pure, thread-safe.
+    void previewMany(const StateView& base, const std::vector<BatchRequest>& candidates, std::vector<int>& verdicts,
+                     std::vector<std::vector<int> >& sequences, ThreadPool& pool) const;
 
 private:
+    Banker(const Banker&);                  // Not copyable: owns raw aligned buffers
+    Banker& operator=(const Banker&);
+
+    int* allocVector() const;               // Zeroed, cache-aligned buffer of rowStride ints
+    int* allocMatrix() const;               // Zeroed, cache-aligned buffer of numCustomers * rowStride ints
+    void copyVector(int* dst, const int* src) const;
+    void copyMatrix(int* dst, const int* src) const;
+
+	// Dimensions
+    int numCustomers;                       // Rows: one per customer
+    int numResources;                       // Columns: one per resource type
+    int rowStride;                          // numResources rounded up to BANKER_ROW_ALIGN
+
 	// Core matrices
-    int available[NUMBER_OF_RESOURCES];                       // Currently available units per source
-    int maximum[NUMBER_OF_CUSTOMERS][NUMBER_OF_RESOURCES];    // Max demand per customer
-    int allocation[NUMBER_OF_CUSTOMERS][NUMBER_OF_RESOURCES]; // Currently allocated units
-    int need[NUMBER_OF_CUSTOMERS][NUMBER_OF_RESOURCES];       // Remaining need per customer
+    int* available;                         // Currently available units per source
+    int* maximum;                           // Max demand per customer
+    int* allocation;                        // Currently allocated units
+    int* need;                              // Remaining need per customer
 
-	// Backup snapshot used by 'snapshot()' / 'restore()'
-    int backupAvailable[NUMBER_OF_RESOURCES];                        // Snapshot: available
-    int backupAllocation[NUMBER_OF_CUSTOMERS][NUMBER_OF_RESOURCES];  // Snapshot: allocation
-    int backupNeed[NUMBER_OF_CUSTOMERS][NUMBER_OF_RESOURCES];        // Snapshot: need
+    // Unsafe denial from request(), kept compact so a denial costs no more than its safety check. The diagnostics,
+    // the deadlock CSV line and the automatic savepoint are rendered from it later (see flushDeadlockReports()).
+    struct DeadlockRecord {
+        int customer;               // Requester whose grant would have been unsafe
+        std::vector<int> request;
+        std::vector<bool> finish;   // Who could still finish with the grant applied
+        std::vector<int> work;      // Work once nobody else could
+        time_t when;
+    };
+    std::vector<DeadlockRecord> pendingDeadlocks;   // Not written out yet; all describe the current state
+    std::string lastDeadlockReport;                 // Rendered diagnostics of the latest unsafe denial
+    bool lastDenialHasReport;                       // lastDenialReason came from that denial
+    std::vector<int> failureWork;                   // Scratch for request()'s final Work vector
+    void recordDeadlock(int customerNum, const std::vector<bool>& finish);
+    std::string renderDeadlock(const DeadlockRecord& record, std::ostream* csv) const;
+    void printSafeSequence(const std::vector<int>& safeSequence, int count) const;
 
-    bool isSafe();                  // Internal safety check using Banker's Algorithm
+    // Last safe sequence proven for the current state, used to re-verify requests incrementally
+    std::vector<int> safeOrder;     // Customers in finishing order
+    std::vector<int> safeOrderPos;  // safeOrderPos[i] = index of customer i in safeOrder
+    bool safeOrderValid;            // False after reset/load/rollback/undo until the next full check
+    std::vector<int> frontMoves;    // Customers moved to the front since safeOrder was settled, latest last
+    std::vector<int> frontStamp;    // frontStamp[i] = 1 + index of customer i's latest move in frontMoves, or 0
+    std::vector<int> orderWork;     // Scratch Work vector for cachedOrderStillSafe()
+    void rememberSafeOrder(const std::vector<int>& sequence);
+    void invalidateSafeOrder();
+    bool cachedOrderStillSafe(int customerNum, const int request[], const int* avail);
+    bool requesterCanFinishFirst(int customerNum, const int* avail) const;
+    void moveToFrontOfSafeOrder(int customerNum);
+    void settleSafeOrder();         // Applies frontMoves to safeOrder and safeOrderPos
     bool showSafeSequence;          // Controls whether safe sequence is printed
+    SafetyEngine safetyEngine;      // Engine used by isSafe() and simulateSequence()
+    int safetyThreads;              // Requested ENGINE_PARALLEL workers (< 1: one per CPU)
+    ThreadPool* safetyPool;         // Created when ENGINE_PARALLEL is first selected
+
+    // Safety checks run through the pure kernel in safety.h; this adds the ENGINE_VERIFY cross-check and its logging
+    bool runSafetyEngine(const StateView& view, std::vector<int>& sequence, std::vector<bool>& finish,
+                         std::vector<int>* finalWork = 0) const;
+
+    // Available vector and one customer's rows as they would be after a grant, overlaid by tentativeView()
+    struct TentativeRows {
+        std::vector<int> available;
+        std::vector<int> allocation;
+        std::vector<int> need;
+    };
+    StateView tentativeView(const StateView& base, int customerNum, const int request[], TentativeRows& rows) const;
+    TentativeRows tentativeRows;    // Scratch for commitRequest() (writers are serialized)
+    int previewWith(const StateView& base, int customerNum, const int request[], std::vector<int>& sequence,
+                    TentativeRows& rows, std::vector<bool>& finish) const;
+
+    // previewMany() state: one scratch per worker, reused for every candidate that worker takes
+    struct PreviewScratch {
+        TentativeRows rows;
+        std::vector<bool> finish;
+    };
+    struct PreviewJob;
+    static void previewTask(void* job, long index, int worker);
 
 	int lastActiveCustomer;        // Set to -1 initially (nobody yet)
     bool hasUndoSnapshot;		   // True if a manual undo snapshot is available
     bool hasSavepoint;			   // Unused in logic but is researved for potential extensions
 
     // Snapshot of the initial state for the reset feature
-    int allocationSnapshot[NUMBER_OF_CUSTOMERS][NUMBER_OF_RESOURCES];
-    int needSnapshot[NUMBER_OF_CUSTOMERS][NUMBER_OF_RESOURCES];
-    int availableSnapshot[NUMBER_OF_RESOURCES];
+    int* allocationSnapshot;
+    int* needSnapshot;
+    int* availableSnapshot;
+
+    // Undo log (see undo()): a ring of undoBudget bytes holding one record per operation,
+    //     size, row count, Available delta (numResources ints), row count x (customer, allocation delta), size
+    // The size at both ends lets undo() walk back from the cursor and redo() forward. Records between undoTail and
+    // undoCursor can be undone, those between undoCursor and undoHead redone.
+    std::vector<int> undoRing;
+    size_t undoBudget;
+    int undoTail, undoCursor, undoHead;     // Offsets into undoRing
+    int undoUsed, redoUsed;                 // Ints held by each side
+    int undoCount, redoCount;               // Records on each side
+    long undoFirstSeq;                      // Operation number of the record at undoTail
+    long undoMarkSeq;                       // Operation number the snapshot mark is at, or -1
+    long undoEvicted;
+    std::vector<int> undoScratch;           // Record being built
+    void startUndoRecord();
+    void addUndoRow(int customer, const int* allocDelta, int sign);
+    void setUndoAvailable(const int* newAvailable);
+    void commitUndoRecord();
+    void appendUndoRecord(const int* record, int size);
+    void applyUndoRecord(int start, int sign);
+    void clearUndoHistory();
+
+    int* requestRow;                        // Zero-padded copy of the current request/release for the row kernels
+    void commitGrant(int* allocRow, int* needRow);  // Applies requestRow, atomically under concurrent releases
+
+    // Seqlock publishing the state to readers (see readSnapshot())
+    int writersActive;                      // Writes currently part-way through (nested and concurrent ones count)
+    unsigned stateVersion;                  // Bumped after every completed write
+    void beginWrite();
+    void endWrite();
 
-    // Manual undo snapshot
-    int undoAvailable[NUMBER_OF_RESOURCES];
-    int undoAllocation[NUMBER_OF_CUSTOMERS][NUMBER_OF_RESOURCES];
-    int undoNeed[NUMBER_OF_CUSTOMERS][NUMBER_OF_RESOURCES];
+    // Brackets a write with beginWrite()/endWrite() on every return path
+    class WriteSection {
+    public:
+        explicit WriteSection(Banker& b) : banker(b) { banker.beginWrite(); }
+        ~WriteSection() { banker.endWrite(); }
+    private:
+        Banker& banker;
+    };
+    friend class WriteSection;
+
+    // Concurrent release state (see releaseConcurrent())
+    bool concurrentReleases;                // Releases may run while commitRequest() reads the state
+    int* liveAvailable;                     // commitRequest()'s copy of Available, taken before any other read
+    int* snapAllocation;                    // commitRequest()'s copies for a full safety check
+    int* snapNeed;
 
-    // Savepoint system
-    std::map<std::string, std::vector<int> > namedAvailable;					// Savepoint: Available
-    std::map<std::string, std::vector<std::vector<int> > > namedAllocation;		// Savepoint: Allocation
-    std::map<std::string, std::vector<std::vector<int> > > namedNeed;			// Savepoint: Need
+    // Savepoint system. Allocation is kept in blocks of BANKER_SAVEPOINT_BLOCK_ROWS rows (numResources ints each,
+    // unpadded); a new savepoint shares every block that still matches the previous savepoint's, and a shared block
+    // is copied before it is changed. Need is maximum - allocation, so it is not stored.
+    struct SavepointBlock {
+        int refs;                               // Savepoints holding this block
+        std::vector<int> cells;
+    };
+    struct Savepoint {
+        std::vector<int> available;
+        std::vector<SavepointBlock*> blocks;
+    };
+    std::map<std::string, Savepoint> savepoints;
+    std::string lastSavepoint;                  // Latest one saved or rolled back to: the candidate for sharing
+    const int* savedRow(const Savepoint& sp, int customer) const;
+    int* writableSavedRow(Savepoint& sp, int customer);    // Copies the row's block first if it is shared
+    static void releaseSavepoint(Savepoint& sp);
 
     std::string lastDenialReason; // Reason for last denied request
 };
-#endif //BANKER_H
\ No newline at end of file
+#endif //BANKER_H
@@ -0,0 +1,252 @@
+// Calla Chen
+// Source Code File 23/23 for EECS 111 Project #3
+#include "binary_log.h"
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+using namespace std;
+
+#define BINARY_LOG_MAX_RECORD (1 << 26) // Readers of a stream of unknown length reject longer payloads as corrupt
+
+// Writer state; the log is written from the command thread only
+static int logFd = -1;
+static string logFilePath;
+static unsigned char buffer[BINARY_LOG_BUFFER];
+static size_t used = 0;
+static vector<unsigned char> scratch;  // One encoded payload, grown to the largest record so far
+static size_t scratchUsed = 0;
+static long long lastStamp = 0;
+static unsigned long records = 0;
+static unsigned long bytes = 0;
+
+static long long wallMicros() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return (long long)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static unsigned long zigzag(long value) {
+    return ((unsigned long)value << 1) ^ (unsigned long)(value >> (sizeof(long) * 8 - 1));
+}
+
+static void writeAll(const unsigned char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = ::write(logFd, data, length);
+        if (n <= 0) return;             // Disk full or closed: drop the rest rather than stall the bank
+        data += n;
+        length -= n;
+    }
+}
+
+// Encodes into 'out' (at least 10 bytes free); returns bytes used
+static size_t encodeVarint(unsigned char* out, unsigned long value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (unsigned char)value;
+    return n;
+}
+
+void BinaryLog::putVarint(unsigned long value) {
+    scratchUsed += encodeVarint(&scratch[scratchUsed], value);
+}
+
+void BinaryLog::putSigned(long value) {
+    putVarint(zigzag(value));
+}
+
+bool BinaryLog::open(const std::string& path) {
+    close();
+    mkdir("logs", 0755);
+    logFd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (logFd < 0) return false;
+    logFilePath = path;
+    records = 0;
+    lastStamp = wallMicros();
+    memcpy(buffer, BINARY_LOG_MAGIC, 4);
+    buffer[4] = BINARY_LOG_VERSION;
+    used = 5 + encodeVarint(buffer + 5, (unsigned long)lastStamp);
+    bytes = used;
+    return true;
+}
+
+void BinaryLog::flush() {
+    if (logFd < 0 || used == 0) return;
+    writeAll(buffer, used);
+    used = 0;
+}
+
+void BinaryLog::close() {
+    if (logFd < 0) return;
+    flush();
+    ::close(logFd);
+    logFd = -1;
+}
+
+bool BinaryLog::isOpen() {
+    return logFd >= 0;
+}
+
+void BinaryLog::record(Type type, int customer, const int* values, int count, int result,
+                       const int* extras, int extraCount, const std::string& text) {
+    if (logFd < 0) return;
+    // Worst case is 10 bytes per varint: a deadlock with every customer blocked or a request over thousands of
+    // resource types still fits in one record
+    size_t worst = 40 + 10 * ((size_t)count + extraCount) + text.size();
+    if (scratch.size() < worst) scratch.resize(worst);
+    long long now = wallMicros();
+    scratchUsed = 0;
+    scratch[scratchUsed++] = (unsigned char)type;
+    putSigned((long)(now - lastStamp));
+    putSigned(customer);
+    putSigned(result);
+    putVarint(count);
+    for (int i = 0; i < count; ++i) putSigned(values[i]);
+    putVarint(extraCount);
+    for (int i = 0; i < extraCount; ++i) putSigned(extras[i]);
+    putVarint(text.size());
+    if (!text.empty()) memcpy(&scratch[scratchUsed], text.data(), text.size());
+    scratchUsed += text.size();
+    lastStamp = now;
+
+    unsigned char prefix[10];
+    size_t prefixLength = encodeVarint(prefix, scratchUsed);
+    if (used + prefixLength + scratchUsed > sizeof(buffer)) flush();
+    if (prefixLength + scratchUsed > sizeof(buffer)) {
+        writeAll(prefix, prefixLength);     // Larger than the whole buffer: write it straight through
+        writeAll(&scratch[0], scratchUsed);
+    } else {
+        memcpy(buffer + used, prefix, prefixLength);
+        used += prefixLength;
+        memcpy(buffer + used, &scratch[0], scratchUsed);
+        used += scratchUsed;
+    }
+    bytes += prefixLength + scratchUsed;
+    ++records;
+}
+
+unsigned long BinaryLog::recordCount() {
+    return records;
+}
+
+unsigned long BinaryLog::byteCount() {
+    return bytes;
+}
+
+const std::string& BinaryLog::path() {
+    return logFilePath;
+}
+
+BinaryLogReader::BinaryLogReader(FILE* f) : file(f), headerOk(false), torn(false), clock(0), fileSize(-1) {
+    struct stat st;
+    if (fstat(fileno(file), &st) == 0 && S_ISREG(st.st_mode)) fileSize = (long long)st.st_size;
+    char magic[5];
+    if (fread(magic, 1, 5, file) != 5) return;
+    if (memcmp(magic, BINARY_LOG_MAGIC, 4) != 0 || magic[4] != BINARY_LOG_VERSION) return;
+    unsigned long start;
+    if (!readVarint(start)) return;
+    clock = (long long)start;
+    headerOk = true;
+}
+
+bool BinaryLogReader::valid() const {
+    return headerOk;
+}
+
+bool BinaryLogReader::truncated() const {
+    return torn;
+}
+
+bool BinaryLogReader::readVarint(unsigned long& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = fgetc(file);
+        if (c == EOF) return false;
+        value |= (unsigned long)(c & 0x7f) << shift;
+        if (!(c & 0x80)) return true;
+    }
+    return false;
+}
+
+bool BinaryLogReader::parseVarint(const unsigned char*& p, const unsigned char* end, unsigned long& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        unsigned char c = *p++;
+        value |= (unsigned long)(c & 0x7f) << shift;
+        if (!(c & 0x80)) return true;
+    }
+    return false;
+}
+
+bool BinaryLogReader::parseSigned(const unsigned char*& p, const unsigned char* end, long& value) {
+    unsigned long raw;
+    if (!parseVarint(p, end, raw)) return false;
+    value = (long)(raw >> 1) ^ -(long)(raw & 1);
+    return true;
+}
+
+bool BinaryLogReader::next(Record& record) {
+    torn = false;
+    if (!headerOk) return false;
+    int first = fgetc(file);
+    if (first == EOF) return false;     // Clean end of the file
+    ungetc(first, file);
+    unsigned long length;
+    bool haveLength = readVarint(length);
+    // A length past the end of the file (or implausibly large, for a pipe) is a torn or corrupt record
+    long long limit = fileSize >= 0 ? fileSize - (long long)ftell(file) : BINARY_LOG_MAX_RECORD;
+    if (!haveLength || length == 0 || (long long)length > limit) {
+        torn = true;
+        return false;
+    }
+    payload.resize(length);
+    if (fread(&payload[0], 1, length, file) != length) {
+        torn = true;
+        return false;
+    }
+
+    const unsigned char* p = &payload[0];
+    const unsigned char* end = p + length;
+    long delta, customer, result, value;
+    unsigned long count, textLength;
+    record.type = *p++;
+    bool ok = parseSigned(p, end, delta) && parseSigned(p, end, customer) && parseSigned(p, end, result)
+              && parseVarint(p, end, count) && count <= length;
+    record.values.clear();
+    for (unsigned long i = 0; ok && i < count; ++i) {
+        ok = parseSigned(p, end, value);
+        record.values.push_back((int)value);
+    }
+    ok = ok && parseVarint(p, end, count) && count <= length;
+    record.extras.clear();
+    for (unsigned long i = 0; ok && i < count; ++i) {
+        ok = parseSigned(p, end, value);
+        record.extras.push_back((int)value);
+    }
+    ok = ok && parseVarint(p, end, textLength) && textLength <= (unsigned long)(end - p);
+    if (!ok) {
+        torn = true;
+        return false;
+    }
+    record.text.assign((const char*)p, textLength);
+    clock += delta;
+    record.timeMicros = clock;
+    record.customer = (int)customer;
+    record.result = (int)result;
+    return true;
+}
+
+const char* BinaryLogReader::typeName(int type) {
+    switch (type) {
+        case BinaryLog::TYPE_REQUEST: return "RQ";
+        case BinaryLog::TYPE_RELEASE: return "RL";
+        case BinaryLog::TYPE_DEADLOCK: return "DEADLOCK";
+        case BinaryLog::TYPE_SAVEPOINT: return "SAVEPOINT";
+        default: return "UNKNOWN";
+    }
+}
@@ -0,0 +1,81 @@
+// Calla Chen
+// Source Code File 22/23 for EECS 111 Project #3
+#ifndef BINARY_LOG_H
+#define BINARY_LOG_H
+
+#include <string>
+#include <vector>
+#include <cstdio>
+
+// Compact binary event log (logs/events.bin), decoded offline by zotbank-logdump.
+//
+// File: the magic "ZBLG", a format version byte and the wall-clock start time (varint microseconds since the epoch).
+// Then one record per event: a varint payload length followed by the payload
+//     type (1 byte), microseconds since the previous record, customer, result (zigzag varints),
+//     value count and values, extra count and extras (zigzag varints), text length and bytes.
+// The length prefix lets readers skip record types they do not know and detect a torn last record.
+#define BINARY_LOG_MAGIC "ZBLG"
+#define BINARY_LOG_VERSION 1
+#define BINARY_LOG_BUFFER 65536         // Bytes buffered before one write()
+
+class BinaryLog {
+public:
+    enum Type {
+        TYPE_REQUEST = 1,               // values: amounts; result: Banker::RequestResult
+        TYPE_RELEASE = 2,               // values: amounts; result: 0 released, -4 invalid
+        TYPE_DEADLOCK = 3,              // values: the rejected request; extras: blocked customers; result: their count
+        TYPE_SAVEPOINT = 4              // text: savepoint name
+    };
+
+    // Single-threaded, like Logger's synchronous mode: call from the command thread only
+    static bool open(const std::string& path = "logs/events.bin"); // Truncates; false if it cannot be created
+    static void close();                                            // Flushes and closes
+    static bool isOpen();
+    static void flush();
+
+    static void record(Type type, int customer, const int* values, int count, int result,
+                       const int* extras = 0, int extraCount = 0, const std::string& text = std::string());
+
+    static unsigned long recordCount();                 // Since open()
+    static unsigned long byteCount();                   // Encoded bytes since open(), header included
+    static const std::string& path();
+
+private:
+    static void putVarint(unsigned long value);
+    static void putSigned(long value);
+};
+
+// Streaming decoder for files written by BinaryLog
+class BinaryLogReader {
+public:
+    struct Record {
+        int type;
+        long long timeMicros;           // Wall clock, microseconds since the epoch
+        int customer;
+        int result;
+        std::vector<int> values;
+        std::vector<int> extras;
+        std::string text;
+    };
+
+    explicit BinaryLogReader(FILE* file);   // Reads the header; check valid()
+    bool valid() const;                     // Header was present and understood
+    bool next(Record& record);              // false at the end of the file or on a torn/corrupt record
+    bool truncated() const;                 // The last next() stopped at a torn or corrupt record
+
+    static const char* typeName(int type);  // "RQ", "RL", "DEADLOCK", "SAVEPOINT" or "UNKNOWN"
+
+private:
+    bool readVarint(unsigned long& value);
+    static bool parseVarint(const unsigned char*& p, const unsigned char* end, unsigned long& value);
+    static bool parseSigned(const unsigned char*& p, const unsigned char* end, long& value);
+
+    FILE* file;
+    bool headerOk;
+    bool torn;
+    long long clock;                        // Time of the previous record
+    long long fileSize;                     // -1 when not a regular file
+    std::vector<unsigned char> payload;
+};
+
+#endif //BINARY_LOG_H
@@ -4,54 +4,98 @@
 #include <sstream>
 #include <iostream>
 #include <string>
-#include <map>
 #include <fstream>
 #include <cstdlib>
 #include <dirent.h>
+#include <sys/time.h>
 #include "logger.h"
+#include "binary_log.h"
+#include "command_parser.h"
+#include "customer_log.h"
+#include "journal.h"
 #include "log_global.h"
+#include "replay.h"
 #include "validator.h"
 
 bool exitAfterTest = false; // Flag for terminating test mode after file execution
 
 using namespace std;
 
-// Initializing alias map to handle alternate forms of commands
-static map<string, string> initAliasMap() {
-    map<string, string> m;
-    m["req"] = "RQ"; m["rq"] = "RQ";
-    m["rel"] = "RL"; m["rl"] = "RL";
-    m["rep"] = "report"; m["sum"] = "summary";
-    m["xpl"] = "explain"; m["hist"] = "history";
-    m["snap"] = "snapshot"; m["undo!"] = "undo";
-    m["v"] = "verbose"; m["c"] = "color";
-    m["sp"] = "savepoint"; m["rb"] = "rollback";
-    m["q"] = "exit"; m["hm"] = "heatmap";
-	m["pre"] = "preview"; m["cmp"] = "compare"; m["df"] = "diff";
-    return m;
+// Resolves a command alias to its canonical name (e.g. "req" -> "RQ"); anything else is returned unchanged
+string resolveAlias(const string& cmd) {
+    CommandParser::CommandId id = CommandParser::lookup(cmd.data(), cmd.size());
+    return (id != CommandParser::CMD_UNKNOWN) ? string(CommandParser::name(id)) : cmd;
 }
 
-// Global alias map during command processing
-static const map<string, string> aliasMap = initAliasMap();
+// Amounts parsed from RQ/RL, reused between commands so the request path does not allocate
+static vector<int> amountBuffer;
 
-// Resource alias map used during command processing
-string resolveAlias(const string& cmd) {
-    map<string, string>::const_iterator it = aliasMap.find(cmd);
-    return (it != aliasMap.end()) ? it->second : cmd;
+static int* amountRow(int count) {
+    if ((int)amountBuffer.size() < count) amountBuffer.resize(count);
+    return &amountBuffer[0];
+}
+
+// Parses "<cust> r0 r1 ... r(count-1)" strictly, ignoring a trailing '#' comment.
+// On malformed input returns false and says why in 'error'; cust and amounts are then not to be used.
+static bool parseCustomerRow(CommandParser::Tokenizer& args, int& cust, int* amounts, int count, string& error) {
+    CommandParser::Token token;
+    int found = 0;
+    for (;; ++found) {
+        int value = 0;
+        CommandParser::IntResult parsed = args.nextInt(value, token);
+        if (parsed == CommandParser::INT_END) break;
+        if (parsed != CommandParser::INT_OK) {
+            error = "'" + string(token.text, token.length) + "' is not "
+                  + (parsed == CommandParser::INT_RANGE ? "in range" : "an integer");
+            return false;
+        }
+        if (found == 0) cust = value;
+        else if (found <= count) amounts[found - 1] = value;
+    }
+    if (found != count + 1) {
+        stringstream msg;
+        msg << "expected a customer ID and " << count << " amounts, got " << found << " value" << (found == 1 ? "" : "s");
+        error = msg.str();
+        return false;
+    }
+    return true;
+}
+
+// Updates per-customer and session totals for one decided request (Banker::RequestResult)
+static void recordRequestStats(int cust, int result) {
+    if (result == Banker::GRANTED) {
+        int now = time(NULL);
+        customerWaitTimes[cust] = now - customerArrivalTimes[cust];
+        customerTurnaround[cust] = customerWaitTimes[cust];
+        globalStats.safeRequests++;
+    } else {
+        customerRetryCounts[cust]++;
+        globalStats.unsafeRequests++;
+        globalStats.totalDenied++;
+        if (result == Banker::DENIED_NEED) globalStats.deniedNeed++;
+        else if (result == Banker::DENIED_AVAIL) globalStats.deniedAvailability++;
+        else globalStats.deniedUnsafe++;
+    }
+    globalStats.totalRequests++;
 }
 
 // Main command interpreter: parses input and invokes matching functionality
 CommandHandler::Result CommandHandler::process(const std::string& input, Banker& banker) {
+    return process(input.data(), input.size(), banker);
+}
+
+CommandHandler::Result CommandHandler::process(const char* line, size_t length, Banker& banker) {
     Result res = { CONTINUE, false, false, false, false, false, false };
 
-    string trimmed = input;
-    trimmed.erase(0, trimmed.find_first_not_of(" \t\r\n"));
-    trimmed.erase(trimmed.find_last_not_of(" \t\r\n") + 1);
-    if (trimmed.empty()) return res;
+    // Work on spans of the input; the line is only copied for commands other than RQ and RL
+    const char* lineBegin = line;
+    const char* lineEnd = line + length;
+    CommandParser::trim(lineBegin, lineEnd);
+    if (lineBegin == lineEnd) return res;
 
     // Handle history recall (!N)
-    if (trimmed[0] == '!' && trimmed.length() > 1) {
-    int index = atoi(trimmed.substr(1).c_str());
+    if (lineBegin[0] == '!' && lineEnd - lineBegin > 1) {
+    int index = atoi(string(lineBegin + 1, lineEnd).c_str());
     if (index > 0 && index <= (int)commandHistory.size()) {
         string recalled = commandHistory[index - 1];
 
@@ -74,18 +118,26 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
         }
     }
 
-    stringstream iss(trimmed);
-	vector<string> parts;
-	string token;
-	while (iss >> token) {
-    	parts.push_back(token);
-	}
-
-	if (parts.empty()) return res;
-
-	string cmd = resolveAlias(parts[0]);
+    // Resolve the command word (or alias) through the perfect-hash dispatch table
+    CommandParser::Tokenizer args(lineBegin, lineEnd);
+    CommandParser::Token word;
+    args.next(word);
+    const CommandParser::CommandId id = CommandParser::lookup(word.text, word.length);
+    const char* argsBegin = args.position();
+    CommandParser::trim(argsBegin, lineEnd);
+
+    // Every other command takes the trimmed line and its words as strings
+    string trimmed;
+    vector<string> parts;
+    if (id != CommandParser::CMD_RQ && id != CommandParser::CMD_RL) {
+        trimmed.assign(lineBegin, lineEnd);
+        parts.push_back(string(word.text, word.length));
+        CommandParser::Tokenizer rest = args;
+        for (CommandParser::Token token; rest.next(token); )
+            parts.push_back(string(token.text, token.length));
+    }
 
-    if (cmd == "*") {
+    if (id == CommandParser::CMD_STAR) {
 		// Handle '*' command displays current system matrices (Available, Allocation, Need, Max)
         globalStats.countStar++;			// Track how many times '*' has been called
         banker.printState();
@@ -93,47 +145,59 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
             fullLog << "[VERBOSE] System matrix printed (command '*')\n"; // log action if verbose is on
         return res;
     }
-    else if (cmd == "RQ") {
+    else if (id == CommandParser::CMD_RQ) {
 		// Handle resource request from a customer
         globalStats.countRQ++;				// Track RQ usage count
         globalStats.commandUsage["RQ"]++;	// Record usage in detailed command app
         res.isRequest = true;
 
-        int cust, req[NUMBER_OF_RESOURCES]; // Array to store requested resources
-        stringstream ss(trimmed.substr(3)); // Parse after "RQ"
-        ss >> cust;
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) ss >> req[j];
+        const int numCustomers = banker.getNumCustomers();
+        const int numResources = banker.getNumResources();
+        int cust = -1;
+        int* req = amountRow(numResources); // Array to store requested resources
+        string parseError;
+        bool wellFormed = parseCustomerRow(args, cust, req, numResources, parseError);
 
 		// Track per-customer request count
-        if (cust >= 0 && cust < NUMBER_OF_CUSTOMERS) {
+        if (wellFormed && cust >= 0 && cust < numCustomers) {
             globalStats.requestCount[cust]++;
-        }
 
-        // Track first arrival time if this is the customer's first appearance
-        if (customerArrivalTimes[cust] == -1)
-            customerArrivalTimes[cust] = time(NULL);
+            // Track first arrival time if this is the customer's first appearance
+            if (customerArrivalTimes[cust] == -1)
+                customerArrivalTimes[cust] = time(NULL);
+        }
 
-		// Validate the request: valid customer and no negative values
-        if (!Validator::isValidCustomer(cust) || !Validator::isValidRequest(req)) {
-            string msg = "Invalid request: bad customer ID or negative values.\n";
+		// Validate the request: well-formed, valid customer and no negative values
+        if (!wellFormed || !Validator::isValidCustomer(cust, numCustomers) || !Validator::isValidRequest(req, numResources)) {
+            string msg = wellFormed ? string("Invalid request: bad customer ID or negative values.\n")
+                                    : "Invalid request: " + parseError + ".\n";
             cout << msg;
             fullLog << msg;
-            Logger::log("RQ " + trimmed.substr(3) + " → INVALID", Logger::WARN);
-
-            if (verboseMode)
-                fullLog << "[VERBOSE] RQ " << trimmed.substr(3) << "  → INVALID input\n";
+            Logger::log("RQ " + string(argsBegin, lineEnd) + " → INVALID", Logger::WARN);
+            BinaryLog::record(BinaryLog::TYPE_REQUEST, cust, req, wellFormed ? numResources : 0, Banker::INVALID_REQUEST);
+            globalStats.invalidRequests++;
+
+            if (verboseMode) {
+                fullLog << "[VERBOSE] RQ ";
+                fullLog.write(argsBegin, lineEnd - argsBegin);
+                fullLog << "  → INVALID input\n";
+            }
 
             res.wasDenied = true;
             return res;
         }
 
 		// Attempt to grant the request using Banker's Algorithm
-        bool granted = (banker.request(cust, req) == Banker::GRANTED);
+        int verdict = banker.request(cust, req);
+        bool granted = (verdict == Banker::GRANTED);
+        BinaryLog::record(BinaryLog::TYPE_REQUEST, cust, req, numResources, verdict);
+        if (granted)
+            Journal::logRequest(cust, req, numResources);
 
 		// Verbose logging output
         if (verboseMode) {
             fullLog << "[VERBOSE] RQ " << cust << " ";
-            for (int i = 0; i < NUMBER_OF_RESOURCES; ++i)
+            for (int i = 0; i < numResources; ++i)
                 fullLog << req[i] << " ";
             fullLog << "→ " << (granted ? "GRANTED" : "DENIED") << "\n";
         }
@@ -158,22 +222,19 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
         string statusStr = (result == Banker::GRANTED) ? "GRANTED" : "DENIED";
         string outputMsg = "Request " + string(result == Banker::GRANTED ? "granted.\n" : "denied.\n");
 
-        Logger::log("RQ " + trimmed.substr(3) + " → " + statusStr,
-                result == Banker::GRANTED ? Logger::INFO : Logger::ERROR);
+        Logger::event(Logger::EVENT_REQUEST, cust, req, numResources,
+                      result == Banker::GRANTED ? "GRANTED" : "DENIED",
+                      result == Banker::GRANTED ? Logger::INFO : Logger::ERROR);
 
         cout << (result == Banker::GRANTED ? COLOR_GREEN : COLOR_RED)
              << outputMsg << COLOR_RESET;
         fullLog << outputMsg;
 
-		// Log to per-customer CSV if open
-        if (cust >= 0 && cust < 10 && customerLogs[cust].is_open()) {
-            customerLogs[cust] << "[" << currentTimestamp() << "] ";
-            customerLogs[cust] << trimmed << " → " << statusStr << "\n";
-            customerLogs[cust].flush();
-        }
+		// Add to the customer's history (group-committed to logs/customers.seg)
+        CustomerLog::append(cust, currentTimestamp() + " " + string(lineBegin, lineEnd) + " → " + statusStr);
 
 		// Record wait and turnaround time if request was granted
-        if (result == Banker::GRANTED && cust >= 0 && cust < 10) {
+        if (result == Banker::GRANTED) {
             int now = time(NULL);
             customerWaitTimes[cust] = now - customerArrivalTimes[cust];
             customerTurnaround[cust] = customerWaitTimes[cust];
@@ -193,51 +254,61 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
 
         return res;
     }
-    else if (cmd == "RL") {
+    else if (id == CommandParser::CMD_RL) {
 		// Handles resource request from customer
         globalStats.countRL++; 				// Track global RL usage count
         globalStats.commandUsage["RL"]++;	// Track usage in detailed command map
         res.isRelease = true;
 
-        int cust, rel[NUMBER_OF_RESOURCES]; // rel[] holds release amounts for each resource
-        stringstream ss(trimmed.substr(3));	// Prase after "RL "
-        ss >> cust;
-        for (int j = 0; j < NUMBER_OF_RESOURCES; ++j) ss >> rel[j];
+        const int numCustomers = banker.getNumCustomers();
+        const int numResources = banker.getNumResources();
+        int cust = -1;
+        int* rel = amountRow(numResources); // rel[] holds release amounts for each resource
+        string parseError;
+        bool wellFormed = parseCustomerRow(args, cust, rel, numResources, parseError);
 
 		// Track now how many times this customer has released resources
-        if (cust >= 0 && cust < NUMBER_OF_CUSTOMERS) {
+        if (wellFormed && cust >= 0 && cust < numCustomers) {
             globalStats.releaseCount[cust]++;
         }
 
 		// Validate customer and release vector using current allocation
-        const int (*alloc)[NUMBER_OF_RESOURCES] = banker.getAllocation();
-        bool valid = Validator::isValidCustomer(cust) &&
-             Validator::isValidRelease(rel, alloc, cust);
+        const int* alloc = banker.getAllocation();
+        bool valid = wellFormed && Validator::isValidRelease(rel, alloc, banker.getRowStride(), numResources,
+                                                             cust, numCustomers);
 
-        if (verboseMode) {
+        if (verboseMode && wellFormed) {
 			// verbose log for release command
             fullLog << "[VERBOSE] RL " << cust << " ";
-            for (int i = 0; i < NUMBER_OF_RESOURCES; ++i)
+            for (int i = 0; i < numResources; ++i)
                 fullLog << rel[i] << " ";
             fullLog << "→ " << (valid ? "RELEASED" : "INVALID") << "\n";
+        } else if (verboseMode) {
+            fullLog << "[VERBOSE] RL ";
+            fullLog.write(argsBegin, lineEnd - argsBegin);
+            fullLog << "  → INVALID input\n";
         }
 
 		// Showing error and log if release is invalid
-        if (!Validator::isValidCustomer(cust) || !Validator::isValidRelease(rel, alloc, cust)) {
-            string msg = "Invalid release: too much released or bad customer ID.\n";
+        if (!valid) {
+            string msg = wellFormed ? string("Invalid release: too much released or bad customer ID.\n")
+                                    : "Invalid release: " + parseError + ".\n";
             cout << msg;
             fullLog << msg;
-            Logger::log("RL " + trimmed.substr(3) + " → INVALID", Logger::WARN);
+            Logger::log("RL " + string(argsBegin, lineEnd) + " → INVALID", Logger::WARN);
+            BinaryLog::record(BinaryLog::TYPE_RELEASE, cust, rel, wellFormed ? numResources : 0, Banker::INVALID_REQUEST);
             return res;
         }
 
 		// Perform the release
         banker.release(cust, rel);
-        Logger::log("RL " + trimmed.substr(3) + " → RELEASED", Logger::INFO);
+        Journal::logRelease(cust, rel, numResources);
+        Logger::event(Logger::EVENT_RELEASE, cust, rel, numResources, "RELEASED", Logger::INFO);
+        BinaryLog::record(BinaryLog::TYPE_RELEASE, cust, rel, numResources, 0);
 		globalStats.totalReleases++;
 
         // Update turnaround time if arrival is known
-        if (cust >= 0 && cust < 10 && customerArrivalTimes[cust] != -1) {
+        if (customerArrivalTimes[cust] != -1) {
             customerTurnaround[cust] = time(NULL) - customerArrivalTimes[cust];
         }
 
@@ -246,15 +317,118 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
         cout << msg;
         fullLog << msg;
 
-		// Append release to per-customer log if open
-        if (cust >= 0 && cust < 10 && customerLogs[cust].is_open()) {
-            customerLogs[cust] << "[" << currentTimestamp() << "] ";
-            customerLogs[cust] << trimmed << " → RELEASED\n";
-            customerLogs[cust].flush();
+		// Append the release to the customer's history
+        CustomerLog::append(cust, currentTimestamp() + " " + string(lineBegin, lineEnd) + " → RELEASED");
+        return res;
+    }
+    else if (id == CommandParser::CMD_RQB) {
+		// Batch request: RQB [fifo/small] <cust> r0 r1 ... ; <cust> r0 r1 ... ; ...
+        globalStats.countRQB++;
+        globalStats.commandUsage["RQB"]++;
+        res.isRequest = true;
+
+        const int numCustomers = banker.getNumCustomers();
+        const int numResources = banker.getNumResources();
+        string body = trimmed.substr(parts[0].size());
+        Banker::BatchOrder order = Banker::BATCH_FIFO;
+        if (parts.size() > 1 && (parts[1] == "fifo" || parts[1] == "small")) {
+            order = (parts[1] == "small") ? Banker::BATCH_SMALLEST_FIRST : Banker::BATCH_FIFO;
+            body = body.substr(body.find(parts[1]) + parts[1].size());
+        }
+
+        // Parse every ';'-separated entry as strictly as RQ; invalid ones are reported and left out of the batch
+        vector<string> entries;
+        vector<bool> entryValid;
+        vector<Banker::BatchRequest> batch;
+        stringstream es(body);
+        string entry;
+        while (getline(es, entry, ';')) {
+            entry.erase(0, entry.find_first_not_of(" \t"));
+            entry.erase(entry.find_last_not_of(" \t") + 1);
+            if (entry.empty()) continue;
+
+            Banker::BatchRequest r;
+            r.customer = -1;
+            r.amounts.assign(numResources, 0);
+            CommandParser::Tokenizer fields(entry.data(), entry.data() + entry.size());
+            string parseError;
+            bool wellFormed = parseCustomerRow(fields, r.customer, &r.amounts[0], numResources, parseError);
+
+            bool valid = wellFormed && Validator::isValidCustomer(r.customer, numCustomers) &&
+                         Validator::isValidRequest(&r.amounts[0], numResources);
+            if (!valid) {
+                string msg = wellFormed ? string("Invalid request: bad customer ID or negative values.\n")
+                                        : "Invalid request: " + parseError + ".\n";
+                cout << msg;
+                fullLog << msg;
+                BinaryLog::record(BinaryLog::TYPE_REQUEST, r.customer, &r.amounts[0], wellFormed ? numResources : 0, Banker::INVALID_REQUEST);
+                globalStats.invalidRequests++;
+            } else {
+                globalStats.requestCount[r.customer]++;
+                if (customerArrivalTimes[r.customer] == -1)
+                    customerArrivalTimes[r.customer] = time(NULL);
+                batch.push_back(r);
+            }
+            entries.push_back(entry);
+            entryValid.push_back(valid);
+        }
+
+        if (entries.empty()) {
+            cout << COLOR_RED << "[ERROR] Usage: RQB [fifo/small] <cust> r0 r1 ... ; <cust> r0 r1 ... ; ...\n" << COLOR_RESET;
+            fullLog << "[ERROR] Empty batch request\n";
+            res.wasDenied = true;
+            return res;
+        }
+
+		// Decide the whole batch with as few safety checks as possible
+        vector<int> verdicts;
+        timeval start, end;
+        gettimeofday(&start, NULL);
+        int checks = banker.requestBatch(batch, verdicts, order);
+        gettimeofday(&end, NULL);
+        long elapsedUs = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+
+        int granted = 0;
+        for (size_t e = 0, k = 0; e < entries.size(); ++e) {
+            string statusStr = "INVALID";
+            if (entryValid[e]) {
+                int cust = batch[k].customer;
+                int result = verdicts[k];
+                BinaryLog::record(BinaryLog::TYPE_REQUEST, cust, &batch[k].amounts[0], numResources, result);
+                if (result == Banker::GRANTED) // Grants only add, so journal order need not match decision order
+                    Journal::logRequest(cust, &batch[k].amounts[0], numResources);
+                ++k;
+                recordRequestStats(cust, result);
+                if (result == Banker::GRANTED) { statusStr = "GRANTED"; ++granted; }
+                else if (result == Banker::DENIED_NEED) statusStr = "DENIED (need)";
+                else if (result == Banker::DENIED_AVAIL) statusStr = "DENIED (available)";
+                else statusStr = "DENIED (unsafe)";
+
+                CustomerLog::append(cust, currentTimestamp() + " RQ " + entries[e] + " → " + statusStr);
+            }
+            Logger::log("RQB " + entries[e] + " → " + statusStr,
+                        statusStr == "GRANTED" ? Logger::INFO : (entryValid[e] ? Logger::ERROR : Logger::WARN));
         }
+        globalStats.batchRequests += (int)batch.size();
+        globalStats.batchSafetyChecks += checks;
+
+        // Throughput against the serial path, which needs up to one safety check per request
+        stringstream msg;
+        msg << "Batch: " << granted << "/" << entries.size() << " granted, " << checks << " safety check"
+            << (checks == 1 ? "" : "s") << " (serial: up to " << batch.size() << ")";
+        if (verboseMode) {
+            msg << ", " << elapsedUs << " us";
+            if (elapsedUs > 0) msg << " (" << (long)(batch.size() * 1000000.0 / elapsedUs) << " req/s)";
+        }
+        msg << "\n";
+        cout << COLOR_CYAN << msg.str() << COLOR_RESET;
+        fullLog << msg.str();
+
+        res.wasDenied = (granted < (int)entries.size());
+        res.status = res.wasDenied ? DENIED : CONTINUE;
         return res;
     }
-    else if (cmd == "safety") {
+    else if (id == CommandParser::CMD_SAFETY) {
 		// Toggles the visibility of safe sequence output after resource requests
         globalStats.countSafety++;				// Increment command usage stats
         globalStats.commandUsage["safety"]++;
@@ -275,12 +449,224 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
             fullLog << "[INFO] Safety sequence toggled to " << (enabled ? "ON" : "OFF") << "\n";
         return res;
     }
-    else if (cmd == "reset") {
+    else if (id == CommandParser::CMD_ENGINE) {
+		// Selects the safety engine used for requests and previews
+        globalStats.countEngine++;				// Track engine command usage
+        globalStats.commandUsage["engine"]++;
+
+        if (parts.size() >= 2) {
+            string mode = parts[1];
+            if (mode == "classic") banker.setSafetyEngine(Banker::ENGINE_CLASSIC);
+            else if (mode == "indexed") banker.setSafetyEngine(Banker::ENGINE_INDEXED);
+            else if (mode == "verify") banker.setSafetyEngine(Banker::ENGINE_VERIFY);
+            else if (mode == "parallel") {
+                if (parts.size() >= 3) {
+                    int threads = atoi(parts[2].c_str());
+                    if (threads < 1) {
+                        cout << COLOR_RED << "[ERROR] Usage: engine parallel [threads >= 1]\n" << COLOR_RESET;
+                        fullLog << "[ERROR] Invalid thread count: " << parts[2] << "\n";
+                        return res;
+                    }
+                    banker.setSafetyThreads(threads);
+                }
+                banker.setSafetyEngine(Banker::ENGINE_PARALLEL);
+            }
+            else {
+                cout << COLOR_RED << "[ERROR] Usage: engine [classic/indexed/parallel/verify]\n" << COLOR_RESET;
+                fullLog << "[ERROR] Invalid engine: " << mode << "\n";
+                return res;
+            }
+        }
+
+        Banker::SafetyEngine engine = banker.getSafetyEngine();
+        string name = (engine == Banker::ENGINE_CLASSIC) ? "classic"
+                    : (engine == Banker::ENGINE_INDEXED) ? "indexed"
+                    : (engine == Banker::ENGINE_PARALLEL) ? "parallel" : "verify";
+        if (engine == Banker::ENGINE_PARALLEL) {
+            stringstream threads;
+            threads << " (" << banker.getSafetyThreads() << " threads)";
+            name += threads.str();
+        }
+        string msg = "Safety engine: " + name + "\n";
+
+        cout << COLOR_CYAN << msg << COLOR_RESET;
+        fullLog << msg;
+        Logger::log("ENGINE → " + name, Logger::INFO);
+
+        if (verboseMode)
+            fullLog << "[INFO] Safety engine set to " << name << "\n";
+        return res;
+    }
+    else if (id == CommandParser::CMD_LOG) {
+		// Selects how events.log is written: log [sync/async [interval ms]/stats]
+        globalStats.countLog++;
+        globalStats.commandUsage["log"]++;
+
+        string mode = (parts.size() >= 2) ? parts[1] : "stats";
+        stringstream msg;
+        if (mode == "async") {
+            int interval = LOGGER_FLUSH_INTERVAL_MS;
+            if (parts.size() >= 3) {
+                interval = atoi(parts[2].c_str());
+                if (interval < 1) {
+                    cout << COLOR_RED << "[ERROR] Usage: log async [interval ms >= 1]\n" << COLOR_RESET;
+                    fullLog << "[ERROR] Invalid flush interval: " << parts[2] << "\n";
+                    return res;
+                }
+            }
+            Logger::stopAsync(); // Restart with the new interval if already asynchronous
+            if (!Logger::startAsync(interval)) {
+                cout << COLOR_RED << "[ERROR] Could not start asynchronous logging.\n" << COLOR_RESET;
+                fullLog << "[ERROR] Could not start asynchronous logging.\n";
+                return res;
+            }
+            msg << "Event log: asynchronous (flush every " << interval << " ms, "
+                << Logger::asyncStats().capacity << "-record ring)\n";
+        }
+        else if (mode == "sync") {
+            Logger::AsyncStats s = Logger::stopAsync();
+            msg << "Event log: synchronous";
+            if (s.capacity > 0)
+                msg << " (" << s.written << " records written in " << s.batches << " batch"
+                    << (s.batches == 1 ? "" : "es") << ", " << s.dropped << " dropped)";
+            msg << "\n";
+        }
+        else if (mode == "stats") {
+            if (Logger::isAsync()) {
+                Logger::AsyncStats s = Logger::asyncStats();
+                msg << "Event log: asynchronous, " << s.queued << " queued, " << s.written << " written in "
+                    << s.batches << " batch" << (s.batches == 1 ? "" : "es") << " (" << s.bytes << " bytes), "
+                    << s.dropped << " dropped\n";
+            } else {
+                msg << "Event log: synchronous\n";
+            }
+        }
+        else {
+            cout << COLOR_RED << "[ERROR] Usage: log [sync/async [interval ms]/stats]\n" << COLOR_RESET;
+            fullLog << "[ERROR] Invalid log mode: " << mode << "\n";
+            return res;
+        }
+
+        cout << COLOR_CYAN << msg.str() << COLOR_RESET;
+        fullLog << msg.str();
+        Logger::log("LOG → " + string(Logger::isAsync() ? "asynchronous" : "synchronous"), Logger::INFO);
+        return res;
+    }
+    else if (id == CommandParser::CMD_BINLOG) {
+		// Compact binary event log for zotbank-logdump: binlog [on [path]/off/stats]
+        globalStats.countBinlog++;
+        globalStats.commandUsage["binlog"]++;
+
+        string mode = (parts.size() >= 2) ? parts[1] : "stats";
+        stringstream msg;
+        if (mode == "on") {
+            string path = (parts.size() >= 3) ? parts[2] : "logs/events.bin";
+            if (!BinaryLog::open(path)) {
+                cout << COLOR_RED << "[ERROR] Could not create binary log: " << path << "\n" << COLOR_RESET;
+                fullLog << "[ERROR] Could not create binary log: " << path << "\n";
+                return res;
+            }
+            msg << "Binary event log: recording to " << path << " (decode with ./zotbank-logdump " << path << ")\n";
+        }
+        else if (mode == "off" || mode == "stats") {
+            if (!BinaryLog::isOpen()) {
+                msg << "Binary event log: off\n";
+            } else {
+                unsigned long records = BinaryLog::recordCount();
+                unsigned long bytes = BinaryLog::byteCount();
+                msg << "Binary event log: " << records << " record" << (records == 1 ? "" : "s") << ", " << bytes
+                    << " bytes in " << BinaryLog::path();
+                if (records > 0)
+                    msg << " (" << (double)bytes / records << " bytes/record)";
+                msg << "\n";
+                if (mode == "off") {
+                    BinaryLog::close();
+                    msg << "Binary event log: off\n";
+                }
+            }
+        }
+        else {
+            cout << COLOR_RED << "[ERROR] Usage: binlog [on [path]/off/stats]\n" << COLOR_RESET;
+            fullLog << "[ERROR] Invalid binlog mode: " << mode << "\n";
+            return res;
+        }
+
+        cout << COLOR_CYAN << msg.str() << COLOR_RESET;
+        fullLog << msg.str();
+        Logger::log("BINLOG → " + string(BinaryLog::isOpen() ? BinaryLog::path() : "off"), Logger::INFO);
+        return res;
+    }
+    else if (id == CommandParser::CMD_CUSTLOG) {
+		// One customer's RQ/RL history from the segment index: custlog <cust> [last N], or custlog for totals
+        globalStats.countCustlog++;
+        globalStats.commandUsage["custlog"]++;
+
+        stringstream msg;
+        if (parts.size() < 2) {
+            CustomerLog::Stats s = CustomerLog::stats();
+            msg << "Customer log: " << s.entries << " entries, " << s.bytes << " bytes in " << s.commits << " commit"
+                << (s.commits == 1 ? "" : "s") << " to " << CustomerLog::path() << " (" << s.pending
+                << " bytes pending)\n";
+            cout << COLOR_CYAN << msg.str() << COLOR_RESET;
+            fullLog << msg.str();
+            return res;
+        }
+
+        int cust = -1, limit = 0;
+        bool ok = (stringstream(parts[1]) >> cust) && cust >= 0 && cust < banker.getNumCustomers();
+        if (ok && parts.size() >= 3)
+            ok = (stringstream(parts[2]) >> limit) && limit > 0;
+        vector<string> lines;
+        if (!ok || !CustomerLog::read(cust, lines, limit)) {
+            cout << COLOR_RED << "[ERROR] Usage: custlog [<cust> [N]]\n" << COLOR_RESET;
+            fullLog << "[ERROR] Invalid custlog arguments: " << trimmed << "\n";
+            return res;
+        }
+
+        unsigned long total = CustomerLog::entryCount(cust);
+        msg << "P" << cust << ": " << total << " entr" << (total == 1 ? "y" : "ies");
+        if (lines.size() < total) msg << " (last " << lines.size() << " shown)";
+        msg << "\n";
+        for (size_t i = 0; i < lines.size(); ++i)
+            msg << "  " << lines[i] << "\n";
+        cout << msg.str();
+        fullLog << msg.str();
+        Logger::log("CUSTLOG → P" + parts[1], Logger::INFO);
+        return res;
+    }
+    else if (id == CommandParser::CMD_JOURNAL) {
+		// Write-ahead journal status (enabled at startup with --journal=<policy>): journal [stats/sync]
+        globalStats.countJournal++;
+        globalStats.commandUsage["journal"]++;
+
+        string mode = (parts.size() >= 2) ? parts[1] : "stats";
+        if (mode != "stats" && mode != "sync") {
+            cout << COLOR_RED << "[ERROR] Usage: journal [stats/sync]\n" << COLOR_RESET;
+            fullLog << "[ERROR] Invalid journal mode: " << mode << "\n";
+            return res;
+        }
+        stringstream msg;
+        if (!Journal::isOpen()) {
+            msg << "Journal: off (start with --journal=always|ms:N|ops:N|none to enable)\n";
+        } else {
+            if (mode == "sync")
+                Journal::sync();
+            Journal::Stats s = Journal::stats();
+            msg << "Journal: " << Journal::path() << ", " << Journal::describe(Journal::options()) << "; "
+                << s.records << " record" << (s.records == 1 ? "" : "s") << " (" << s.bytes << " bytes), "
+                << s.syncs << " fsync" << (s.syncs == 1 ? "" : "s") << " this session\n";
+        }
+        cout << COLOR_CYAN << msg.str() << COLOR_RESET;
+        fullLog << msg.str();
+        return res;
+    }
+    else if (id == CommandParser::CMD_RESET) {
 		// Reset system state to initial snapshot taken at program start
         globalStats.countReset++;				// Track reset command usage
         globalStats.commandUsage["reset"]++;
 
         banker.reset(); 							// Restore available, allocation, need from snapshot
+        Journal::logState(banker);
 
 		string msg = "System state reset.\n";
 
@@ -295,7 +681,7 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
             fullLog << "[INFO] System state reset.\n";
         return res;
     }
-    else if (cmd == "report") {
+    else if (id == CommandParser::CMD_REPORT) {
 		// Outputs a detailed summary of system resources (allocation, need, etc.)
         globalStats.countReport++;				// Incrementing report usage sats
         globalStats.commandUsage["report"]++;
@@ -307,11 +693,11 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
         Logger::log("REPORT → System resource summary printed", Logger::INFO); // persistent log entry
         return res;
     }
-    else if (cmd == "explain") {
+    else if (id == CommandParser::CMD_EXPLAIN) {
         globalStats.countExplain++;					// Track explain command usage
         globalStats.commandUsage["explain"]++;
 
-        string reason = banker.getLastDenialReason(); // Retrieve denial reason from Banker
+        string reason = banker.explainLastDenial(); // Retrieve denial reason (and any deadlock diagnostics) from Banker
 
         cout << COLOR_YELLOW << reason << COLOR_RESET << endl;	// Show reason in yellow in terminal
         fullLog << reason << endl;								// Log session to log
@@ -322,7 +708,7 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
             fullLog << "[INFO] Explain command output: " << reason << "\n";
         return res;
     }
-	else if (cmd == "preview") {
+	else if (id == CommandParser::CMD_PREVIEW) {
     	globalStats.countPreview++; // Increment usage count for analytics
     	vector<int> tokens;
 		// Parse numerical arguments from input
@@ -339,8 +725,9 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
         	}
     	}
 
-		// Validate argument count: <cust> + NUMBER_OF_RESOURCES
-    	if (tokens.size() != NUMBER_OF_RESOURCES + 1) {
+		// Validate argument count: <cust> + one value per resource
+    	const int numResources = banker.getNumResources();
+    	if ((int)tokens.size() != numResources + 1) {
         	cout << "[PREVIEW] Usage: preview <cust> r0 r1 r2 r3\n";
         	if (verboseMode)
             	fullLog << "[PREVIEW] Incorrect usage: preview <cust> r0 r1 r2 r3\n";
@@ -349,7 +736,7 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
 
     	int cust = tokens[0];
 		// Validate customer number
-    	if (cust < 0 || cust >= NUMBER_OF_CUSTOMERS) {
+    	if (!Validator::isValidCustomer(cust, banker.getNumCustomers())) {
         	cout << "[PREVIEW] Invalid customer number: P" << cust << "\n";
         	if (verboseMode)
             	fullLog << "[PREVIEW] Invalid customer number: P" << cust << "\n";
@@ -357,12 +744,12 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
     	}
 
 		// Extract request factor
-    	int req[NUMBER_OF_RESOURCES];
-    	for (int i = 0; i < NUMBER_OF_RESOURCES; ++i)
-        	req[i] = tokens[i + 1];
+    	vector<int> req(tokens.begin() + 1, tokens.end());
 
-		// Check if request would be granted based on current state
-    	if (!banker.wouldGrantRequest(cust, req)) {
+		// Check if request would be granted based on the latest published state
+    	Banker::StateSnapshot snap;
+    	banker.readSnapshot(snap);
+    	if (!banker.wouldGrantRequest(snap.view(), cust, &req[0])) {
 			globalStats.countDeniedPreview++; // Log denial
         	cout << "[PREVIEW] Request would be denied.\n";
         	if (verboseMode)
@@ -371,7 +758,7 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
 			globalStats.deniedAvailability++;
     	} else {
 			// Simulate to find a safe sequence
-        	vector<int> safeSeq = banker.simulateSequence(cust, req);
+        	vector<int> safeSeq = banker.simulateSequence(snap.view(), cust, &req[0]);
         	if (safeSeq.empty()) {
 				globalStats.countUnsafePreview++;
             	cout << "[PREVIEW] Unsafe request. No valid safe sequence.\n";
@@ -403,7 +790,120 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
 
     	return res;
 	}
-    else if (cmd == "snapshot") {
+	else if (id == CommandParser::CMD_PREVIEW_FILE) {
+		// Bulk what-if: preview-file <file> [csv], one "<cust> r0 r1 ..." candidate per line
+    	globalStats.countPreviewFile++;
+    	globalStats.commandUsage["preview-file"]++;
+    	if (parts.size() < 2 || parts.size() > 3) {
+        	cout << COLOR_RED << "[ERROR] Usage: preview-file <file> [csv]\n" << COLOR_RESET;
+        	fullLog << "[ERROR] Usage: preview-file <file> [csv]\n";
+        	return res;
+    	}
+    	string csvPath = (parts.size() == 3) ? parts[2] : "logs/preview_file.csv";
+    	ifstream in(parts[1].c_str());
+    	if (!in) {
+        	cout << COLOR_RED << "[ERROR] Cannot open candidate file: " << parts[1] << "\n" << COLOR_RESET;
+        	fullLog << "[ERROR] Cannot open candidate file: " << parts[1] << "\n";
+        	return res;
+    	}
+
+		// Parse every candidate as strictly as RQ; blank lines and '#' comments are skipped, malformed lines are
+		// reported with the reason and listed as INVALID
+    	const int numCustomers = banker.getNumCustomers();
+    	const int numResources = banker.getNumResources();
+    	vector<int> lineNumbers;
+    	vector<string> entries;
+    	vector<bool> entryValid;
+    	vector<Banker::BatchRequest> candidates;
+    	string line;
+    	for (int lineNo = 1; getline(in, line); ++lineNo) {
+        	if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+        	line.erase(0, line.find_first_not_of(" \t"));
+        	line.erase(line.find_last_not_of(" \t") + 1);
+        	if (line.empty() || line[0] == '#') continue;
+
+        	Banker::BatchRequest r;
+        	r.customer = -1;
+        	r.amounts.assign(numResources, 0);
+        	CommandParser::Tokenizer fields(line.data(), line.data() + line.size());
+        	string parseError;
+        	bool wellFormed = parseCustomerRow(fields, r.customer, &r.amounts[0], numResources, parseError);
+        	bool valid = wellFormed && Validator::isValidCustomer(r.customer, numCustomers) &&
+                     	 Validator::isValidRequest(&r.amounts[0], numResources);
+        	if (valid) candidates.push_back(r);
+        	else {
+            	stringstream msg;
+            	msg << "Invalid request on line " << lineNo << ": "
+                	<< (wellFormed ? string("bad customer ID or negative values") : parseError) << ".\n";
+            	cout << msg.str();
+            	fullLog << msg.str();
+        	}
+        	lineNumbers.push_back(lineNo);
+        	entries.push_back(line);
+        	entryValid.push_back(valid);
+    	}
+
+		// Evaluate all candidates against one consistent snapshot, spread over every CPU
+    	Banker::StateSnapshot snap;
+    	banker.readSnapshot(snap);
+    	ThreadPool pool(0);
+    	vector<int> verdicts;
+    	vector<vector<int> > sequences;
+    	timeval start, end;
+    	gettimeofday(&start, NULL);
+    	banker.previewMany(snap.view(), candidates, verdicts, sequences, pool);
+    	gettimeofday(&end, NULL);
+    	long elapsedUs = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+    	globalStats.previewFileCandidates += (int)candidates.size();
+
+    	ofstream csv(csvPath.c_str());
+    	if (!csv) {
+        	cout << COLOR_RED << "[ERROR] Cannot write preview results to " << csvPath << "\n" << COLOR_RESET;
+        	fullLog << "[ERROR] Cannot write preview results to " << csvPath << "\n";
+        	return res;
+    	}
+    	csv << "line,customer,request,verdict,safe_sequence\n";
+    	int safe = 0, unsafe = 0, denied = 0, invalid = 0;
+    	for (size_t e = 0, k = 0; e < entries.size(); ++e) {
+        	if (!entryValid[e]) {
+            	++invalid;
+            	csv << lineNumbers[e] << ",,\"" << entries[e] << "\",INVALID,\n";
+            	continue;
+        	}
+        	const Banker::BatchRequest& r = candidates[k];
+        	int verdict = verdicts[k];
+        	const vector<int>& seq = sequences[k++];
+        	const char* verdictStr = "DENIED_UNSAFE";
+        	if (verdict == Banker::GRANTED) { verdictStr = "GRANTED"; ++safe; }
+        	else if (verdict == Banker::DENIED_NEED) { verdictStr = "DENIED_NEED"; ++denied; }
+        	else if (verdict == Banker::DENIED_AVAIL) { verdictStr = "DENIED_AVAIL"; ++denied; }
+        	else ++unsafe;
+
+        	csv << lineNumbers[e] << ",P" << r.customer << ",";
+        	for (int j = 0; j < numResources; ++j)
+            	csv << (j ? " " : "") << r.amounts[j];
+        	csv << "," << verdictStr << ",";
+        	for (size_t i = 0; i < seq.size(); ++i)
+            	csv << (i ? " " : "") << "P" << seq[i];
+        	csv << "\n";
+    	}
+
+    	stringstream msg;
+    	msg << "[PREVIEW-FILE] " << entries.size() << " candidate" << (entries.size() == 1 ? "" : "s") << ": "
+        	<< safe << " safe, " << unsafe << " unsafe, " << denied << " denied, " << invalid << " invalid → "
+        	<< csvPath;
+    	if (verboseMode) {
+        	msg << " (" << elapsedUs << " us on " << pool.size() << " thread" << (pool.size() == 1 ? "" : "s");
+        	if (elapsedUs > 0) msg << ", " << (long)(candidates.size() * 1000000.0 / elapsedUs) << " candidates/s";
+        	msg << ")";
+    	}
+    	msg << "\n";
+    	cout << COLOR_CYAN << msg.str() << COLOR_RESET;
+    	fullLog << msg.str();
+    	Logger::log("PREVIEW-FILE " + parts[1] + " → " + csvPath, Logger::INFO);
+    	return res;
+	}
+    else if (id == CommandParser::CMD_SNAPSHOT) {
         globalStats.countSnapshot++;			// Records how many times 'snapshot' has been used
         globalStats.commandUsage["snapshot"]++; // Record frequency for analytics
         banker.saveUndoSnapshot();				// Save current system state for manual undo
@@ -413,10 +913,59 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
             fullLog << "[INFO] Manual snapshot saved.\n";
         return res;
     }
-    else if (cmd == "undo") {
+    else if (id == CommandParser::CMD_UNDO) {
         globalStats.countUndo++;			// Increment total 'undo' command counter
         globalStats.commandUsage["undo"]++; // track usage frequency for analytics
-        banker.restoreUndoSnapshot();		// Restore system state from last manual snapshot
+
+		// undo [N | stats | budget <KB>]: N operations from the undo log; without N, back to the last snapshot
+        stringstream msg;
+        if (parts.size() >= 2 && parts[1] == "stats") {
+            Banker::UndoStats s = banker.undoStats();
+            msg << "Undo log: " << s.undoable << " undoable, " << s.redoable << " redoable operation"
+                << (s.redoable == 1 ? "" : "s") << ", " << s.usedBytes << " of " << s.budgetBytes << " bytes; "
+                << s.evicted << " dropped for the budget" << (s.hasMark ? "; snapshot reachable" : "") << "\n";
+            cout << COLOR_CYAN << msg.str() << COLOR_RESET;
+            fullLog << msg.str();
+            return res;
+        }
+        if (parts.size() >= 2 && parts[1] == "budget") {
+            long kb = -1;
+            if (parts.size() < 3 || !(stringstream(parts[2]) >> kb) || kb < 0 || kb > 1048576) {
+                cout << COLOR_RED << "[ERROR] Usage: undo budget <KB> (0 turns the undo log off)\n" << COLOR_RESET;
+                fullLog << "[ERROR] Invalid undo budget: " << trimmed << "\n";
+                return res;
+            }
+            banker.setUndoBudget((size_t)kb * 1024);
+            Banker::UndoStats s = banker.undoStats();
+            msg << "[INFO] Undo budget set to " << kb << " KB (" << s.undoable << " operation"
+                << (s.undoable == 1 ? "" : "s") << " kept).\n";
+            cout << COLOR_CYAN << msg.str() << COLOR_RESET;
+            fullLog << msg.str();
+            Logger::log("UNDO → Budget " + parts[2] + " KB", Logger::INFO);
+            return res;
+        }
+        if (parts.size() >= 2) {
+            int count = 0;
+            if (!(stringstream(parts[1]) >> count) || count <= 0) {
+                cout << COLOR_RED << "[ERROR] Usage: undo [N | stats | budget <KB>]\n" << COLOR_RESET;
+                fullLog << "[ERROR] Invalid undo arguments: " << trimmed << "\n";
+                return res;
+            }
+            int done = banker.undo(count);
+            if (done > 0) Journal::logState(banker);
+            Banker::UndoStats s = banker.undoStats();
+            msg << "[INFO] Undid " << done << " operation" << (done == 1 ? "" : "s") << " (" << s.undoable
+                << " more can be undone, " << s.redoable << " redone).\n";
+            cout << COLOR_YELLOW << msg.str() << COLOR_RESET;
+            fullLog << msg.str();
+            Logger::log("UNDO → " + parts[1] + " operation(s) requested", Logger::INFO);
+            if (done > 0) banker.printState();
+            return res;
+        }
+
+        if (!banker.restoreUndoSnapshot())	// Undo (or redo) back to the last manual snapshot
+            return res;
+        Journal::logState(banker);
 
         cout << COLOR_YELLOW << "[INFO] System restored to last snapshot.\n" << COLOR_RESET;
         fullLog << "[INFO] System restored to last snapshot.\n";
@@ -426,7 +975,30 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
             fullLog << "[INFO] Undo snapshot restored.\n";
         return res;
     }
-    else if (cmd == "test") {
+    else if (id == CommandParser::CMD_REDO) {
+		// Re-applies operations reverted by undo: redo [N]
+        globalStats.countRedo++;
+        globalStats.commandUsage["redo"]++;
+
+        int count = 1;
+        if (parts.size() >= 2 && (!(stringstream(parts[1]) >> count) || count <= 0)) {
+            cout << COLOR_RED << "[ERROR] Usage: redo [N]\n" << COLOR_RESET;
+            fullLog << "[ERROR] Invalid redo arguments: " << trimmed << "\n";
+            return res;
+        }
+        int done = banker.redo(count);
+        if (done > 0) Journal::logState(banker);
+        Banker::UndoStats s = banker.undoStats();
+        stringstream msg;
+        msg << "[INFO] Redid " << done << " operation" << (done == 1 ? "" : "s") << " (" << s.redoable
+            << " more can be redone).\n";
+        cout << COLOR_YELLOW << msg.str() << COLOR_RESET;
+        fullLog << msg.str();
+        Logger::log("REDO → " + string(parts.size() >= 2 ? parts[1] : "1") + " operation(s) requested", Logger::INFO);
+        if (done > 0) banker.printState();
+        return res;
+    }
+    else if (id == CommandParser::CMD_TEST) {
         stringstream ss(trimmed.substr(5));	// Parse filename (in tests directory) from input
         string filename;
         ss >> filename;
@@ -465,22 +1037,7 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
                 break;  // End test mode early so summary prints
             }
 
-			// Track request statistics (inputed in any of the test files)
-            if (result.isRequest) {
-                globalStats.totalRequests++;
-                if (result.wasDenied) {
-                    globalStats.unsafeRequests++;
-                    globalStats.totalDenied++;
-                    if (result.exceedsNeed) globalStats.deniedNeed++;
-                    if (result.exceedsAvail) globalStats.deniedAvailability++;
-                    if (result.wasUnsafe) globalStats.deniedUnsafe++;
-                } else {
-                    globalStats.safeRequests++;
-                }
-            }
-			// Track release statistics
-            if (result.isRelease)
-                globalStats.totalReleases++;
+			// Request/release statistics were already recorded by process(), once per decided request
 
             if (result.status == EXIT)
                 break;
@@ -500,7 +1057,37 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
             fullLog << "[VERBOSE] Processed " << count << " commands in test mode from " << filename << "\n";
         return res;
     }
-    else if (cmd == "history") {
+    else if (id == CommandParser::CMD_REPLAY) {
+        // Replays a script or trace without per-command output, then reports throughput and latency
+        globalStats.countReplay++;
+        globalStats.commandUsage["replay"]++;
+        if (parts.size() != 2) {
+            cout << COLOR_RED << "[ERROR] Usage: replay <file>\n" << COLOR_RESET;
+            fullLog << "[ERROR] Usage: replay <file>\n";
+            return res;
+        }
+        cout << COLOR_CYAN << "[REPLAY] Running commands from: " << parts[1] << "\n" << COLOR_RESET;
+        fullLog << "[REPLAY] Running commands from: " << parts[1] << "\n";
+        Replay::Stats stats = Replay::run(parts[1], banker);
+        if (!stats.error.empty()) {
+            cout << COLOR_RED << "[ERROR] " << stats.error << "\n" << COLOR_RESET;
+            fullLog << "[ERROR] " << stats.error << "\n";
+            Logger::log("REPLAY → " + stats.error, Logger::ERROR);
+            return res;
+        }
+        string report = Replay::describe(stats);
+        cout << COLOR_CYAN << report << COLOR_RESET;
+        fullLog << report;
+        fullLog.flush();
+        stringstream count;
+        count << stats.commands;
+        Logger::log("REPLAY → " + count.str() + " commands executed from " + parts[1], Logger::INFO);
+
+        if (stats.exited)
+            exitAfterTest = true;   // The script ended the session, as in test mode
+        return res;
+    }
+    else if (id == CommandParser::CMD_HISTORY) {
         globalStats.countHistory++; 			// Incremement history command counter
         string header = "\033[35m\nCommand History:\033[0m\n"; // Purple colored header
         cout << header;
@@ -523,7 +1110,7 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
 
         return res;
     }
-	else if (cmd == "recap") {
+	else if (id == CommandParser::CMD_RECAP) {
 		globalStats.countRecap++; // Track usage of 'recap' command
 		vector<string> filtered; // Store up to 5 most recent meaningful commands
 
@@ -537,7 +1124,7 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
 			head = resolveAlias(head); // Resolve command aliases if any
 
 			// Skip commands that are not user-actionable
-			if (head == "test" || head == "help" || head == "recap" || head == "history" || head == "*") continue;
+			if (head == "test" || head == "replay" || head == "help" || head == "recap" || head == "history" || head == "*") continue;
 			filtered.push_back(entry); // Valid user command found
 		}
 		if (filtered.empty()) {
@@ -555,7 +1142,7 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
 		}
 		return res;
 	}
-	else if (cmd == "help") {
+	else if (id == CommandParser::CMD_HELP) {
     globalStats.countHelp++;
     globalStats.commandUsage["help"]++;
     stringstream ss(trimmed);
@@ -606,17 +1193,43 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
             }
         } else { // Output descriptions per each individual command when help topic is specified
             if (topic == "RQ") {
-                cout << "RQ <cust> r0 r1 r2 r3  - Request resources for customer <cust>.\n";
+                cout << "RQ <cust> r0 r1 r2 r3  - Request resources for customer <cust>. Values must be plain integers;\n"
+                     << "    a trailing '# comment' is ignored.\n";
+            } else if (topic == "RQB") {
+                cout << "RQB [fifo/small] <cust> r0 r1 r2 r3 ; <cust> r0 r1 r2 r3 ; ...  - Decide a batch of requests "
+                        "with as few safety checks as possible (small = fewest total units first).\n";
             } else if (topic == "RL") {
                 cout << "RL <cust> r0 r1 r2 r3  - Release resources held by <cust>.\n";
             } else if (topic == "*") {
                 cout << "*  - Print all resource matrices: Available, Max, Alloc, Need\n";
             } else if (topic == "safety") {
                 cout << "safety  - Toggle safety sequence output on/off.\n";
+            } else if (topic == "engine") {
+                cout << "engine [classic/indexed/parallel [threads]/verify]  - Select the safety check engine (verify runs\n"
+                     << "    classic and indexed and compares; parallel splits each pass across worker threads).\n";
+            } else if (topic == "log") {
+                cout << "log [sync/async [interval ms]/stats]  - Write events.log on this thread, or from a background\n"
+                     << "    thread that batches fixed-size records from a lock-free ring (no console echo, flushed every\n"
+                     << "    interval, default 100 ms). stats shows queued, written and dropped records.\n";
+            } else if (topic == "binlog") {
+                cout << "binlog [on [path]/off/stats]  - Also record RQ, RL, deadlock and savepoint events as compact\n"
+                     << "    varint records (default logs/events.bin); decode offline with zotbank-logdump.\n";
+            } else if (topic == "journal") {
+                cout << "journal [stats/sync]  - Show the write-ahead journal's policy and counters, or fsync it now.\n"
+                     << "    Start with --journal=always|ms:N|ops:N|none to journal every committed RQ, RL, reset,\n"
+                     << "    undo, redo, rollback and load; the next start replays it on top of logs/save.txt.\n";
+            } else if (topic == "custlog") {
+                cout << "custlog [<cust> [N]]  - Show customer <cust>'s RQ/RL history (the last N entries if given), read\n"
+                     << "    from logs/customers.seg through its index; without arguments, show the segment totals.\n";
             } else if (topic == "snapshot") {
                 cout << "snapshot  - Save a manual undo snapshot.\n";
             } else if (topic == "undo") {
-                cout << "undo  - Revert system to last snapshot.\n";
+                cout << "undo [N | stats | budget <KB>]  - Revert the last N operations (granted requests, releases, RQB\n"
+                     << "    batches, resets and rollbacks), or all of them since the last snapshot if N is omitted.\n"
+                     << "    The undo log keeps each operation as the rows it changed, newest first, within the budget\n"
+                     << "    (1024 KB by default); loads clear it.\n";
+            } else if (topic == "redo") {
+                cout << "redo [N]  - Re-apply the last N undone operations (1 if omitted), until a new one is made.\n";
             } else if (topic == "report") {
                 cout << "report  - Print current available, allocation, and need totals.\n";
             } else if (topic == "summary") {
@@ -625,10 +1238,16 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
                 cout << "explain  - Show reason for last denied request.\n";
             } else if (topic == "test") {
 				cout << "test <file> - run commands from a file in auto-tested.\n";
+			} else if (topic == "replay") {
+				cout << "replay <file> - Run a long script or trace as fast as possible: the file is mapped into memory,\n"
+				     << "    nothing is printed per command and the event log is written in batches. Reports commands\n"
+				     << "    per second and latency percentiles at the end. Lines are not added to the history.\n";
 			} else if (topic == "save") {
-				cout << "save - Save current system to logs/save.txt.\n";
+				cout << "save [bin [file]] - Save current system to logs/save.txt, or as a binary checkpoint (default\n"
+				     << "    logs/save.bin).\n";
 			} else if (topic == "load") {
-				cout << "load - Load previously saved system state from logs/save.txt.\n";
+				cout << "load [bin [file]] - Load previously saved system state from logs/save.txt, or from a binary\n"
+				     << "    checkpoint (default logs/save.bin).\n";
 			} else if (topic == "history") {
 				cout << "history - Print previously entered commands.\n";
 			} else if (topic == "recap") {
@@ -647,24 +1266,39 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
                 cout << "savepoint  - Saves a recovery state to rollback to later.\n";
             } else if (topic == "rollback") {
                 cout << "rollback - Restores state to last saved savepoint.\n";
+            } else if (topic == "savepoints") {
+                cout << "savepoints  - List every savepoint with the memory it holds. Savepoints share the allocation\n"
+                     << "    blocks that did not change between them; a shared block is charged to each by share.\n";
             } else if (topic == "heatmap") {
                 cout << "heatmap - Logs request heatmap for all customers to CSV.\n";
             } else if (topic == "preview") {
     			cout << "preview <cust> r0 r1 r2 r3  - Show safe sequence if request is made (but do NOT apply).\n";
+			} else if (topic == "preview-file") {
+    			cout << "preview-file <file> [csv]  - Preview every \"<cust> r0 r1 ...\" line of <file> against the current\n"
+                     << "    state on all CPUs (nothing is applied); writes verdicts and safe sequences to [csv]\n"
+                     << "    (default logs/preview_file.csv).\n";
 			} else if (topic == "compare") {
                 cout << "compare <name> - Compare current system with a savepoint\n";
             } else if (topic == "all") { // Displaying summary list of ALL available commands for "help all"
 			    cout << "\nCOMMAND HELP OVERVIEW:\n"
                      << "  RQ <cust> r0 r1 r2 r3  		- Request resources for customer <cust>\n"
+                     << "  RQB [fifo/small] <cust> r0 r1 r2 r3 ; ... - Request a batch of resources\n"
                      << "  RL <cust> r0 r1 r2 r3  		- Release resources held by <cust>\n"
                      << "  *                      		- Print all resource matrices\n"
                      << "  safety                 		- Toggle safe sequence display\n"
+                     << "  engine [classic/indexed/parallel/verify] - Select the safety check engine\n"
+                     << "  log [sync/async [ms]/stats]  - Synchronous or batched background event logging\n"
+                     << "  binlog [on [path]/off/stats] - Compact binary event log (zotbank-logdump decodes it)\n"
+                     << "  custlog [<cust> [N]]         - Show one customer's RQ/RL history\n"
+                     << "  journal [stats/sync]         - Write-ahead journal status (--journal=<policy>)\n"
                      << "  snapshot               		- Save a manual undo snapshot\n"
-                     << "  undo                   		- Revert system to last snapshot\n"
+                     << "  undo [N | stats | budget <KB>] - Revert N operations, or to the last snapshot\n"
+                     << "  redo [N]                     - Re-apply undone operations\n"
                      << "  report                 		- Show current resource usage\n"
                      << "  explain                		- Show last denial reason\n"
                      << "  summary                		- Show command usage counts\n"
                      << "  test <file>            		- Execute commands from file\n"
+                     << "  replay <file>                - Replay a script or trace quietly; reports commands/s and latency\n"
                      << "  history                		- Display command history\n"
 				     << "  recap 						- Show the last 5 meaningful commands\n"
                      << "  !N                    		- Replay the Nth command from history\n"
@@ -673,8 +1307,10 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
                      << "  color [on/off]         		- Toggle color-coded output\n"
                      << "  savepoint <name>       		- Create named system snapshot\n"
                      << "  rollback <name>        		- Restore system to a savepoint\n"
+                     << "  savepoints                   - List savepoints and the memory each one holds\n"
                      << "  heatmap                		- Log current RQ/RL heatmap\n"
 					 << "  preview <cust> r0 r1 r2 r3   - Show save sequence if request is made (but do NOT apply)\n"
+                     << "  preview-file <file> [csv]    - Preview every request in a file in parallel, verdicts to CSV\n"
                      << "  compare <name>               - Compare current system with a savepoint\n"
 					 << "  diff <savepoint name> 		- View differences from savepoint\n"
                      << "  exit                   		- Exit ZotBank\n\n";
@@ -687,17 +1323,24 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
         return res;
     }
     // Summary command: prints the current running totals
-    else if (cmd == "summary") {
+    else if (id == CommandParser::CMD_SUMMARY) {
         globalStats.countSummary++;
         stringstream ss;
         ss << "Command Usage Breakdown:\n"
            << "  RQ:         " << globalStats.countRQ << "\n"
+           << "  RQB:        " << globalStats.countRQB << "\n"
            << "  RL:         " << globalStats.countRL << "\n"
            << "  safety:     " << globalStats.countSafety << "\n"
+           << "  engine:     " << globalStats.countEngine << "\n"
+           << "  log:        " << globalStats.countLog << "\n"
+           << "  binlog:     " << globalStats.countBinlog << "\n"
+           << "  custlog:    " << globalStats.countCustlog << "\n"
+           << "  journal:    " << globalStats.countJournal << "\n"
            << "  reset:      " << globalStats.countReset << "\n"
            << "  report:     " << globalStats.countReport << "\n"
            << "  explain:    " << globalStats.countExplain << "\n"
            << "  undo:       " << globalStats.countUndo << "\n"
+           << "  redo:       " << globalStats.countRedo << "\n"
            << "  snapshot:   " << globalStats.countSnapshot << "\n"
            << "  history:    " << globalStats.countHistory << "\n"
 		   << "  recap:      " << globalStats.countRecap << "\n"
@@ -705,12 +1348,26 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
            << "  verbose:    " << globalStats.countVerbose << "\n"
            << "  color:      " << globalStats.countColor << "\n"
            << "  savepoint:  " << globalStats.countSavepoint << "\n"
+           << "  savepoints: " << globalStats.countSavepoints << "\n"
            << "  rollback:   " << globalStats.countRollback << "\n"
            << "  preview:    " << globalStats.countPreview << "\n"
+           << "  preview-file: " << globalStats.countPreviewFile << "\n"
            << "  compare:    " << globalStats.countCompare << "\n"
 		   << "  diff:       " << globalStats.countDiff << "\n"
+           << "  replay:     " << globalStats.countReplay << "\n"
            << "  unknown:    " << globalStats.countUnknown << "\n";
 
+        if (globalStats.countRQB > 0)
+            ss << "\nBatch Requests (RQB):\n"
+               << " - Batches:                      " << globalStats.countRQB << "\n"
+               << " - Requests decided:             " << globalStats.batchRequests << "\n"
+               << " - Safety checks:                " << globalStats.batchSafetyChecks << "\n";
+
+        ss << "\nSafety Check Paths (RQ):\n"
+           << " - Fast path (can finish first): " << globalStats.fastPathHits << "\n"
+           << " - Cached order re-verified:     " << globalStats.orderReplayHits << "\n"
+           << " - Full safety check:            " << globalStats.fastPathMisses << "\n";
+
         if (globalStats.countPreview > 0) {
             ss << "\nPreview Outcome Summary:\n"
                << " - Denied (invalid/exceeds): " << globalStats.countDeniedPreview << "\n"
@@ -718,13 +1375,18 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
                << " - safe (not applied):       " << globalStats.countSafePreview << "\n";
         }
 
+        if (globalStats.countPreviewFile > 0)
+            ss << "\nBulk Previews (preview-file):\n"
+               << " - Runs:                         " << globalStats.countPreviewFile << "\n"
+               << " - Candidates evaluated:         " << globalStats.previewFileCandidates << "\n";
+
         cout << COLOR_CYAN << ss.str() << COLOR_RESET;
         fullLog << ss.str();
         if (verboseMode)
             fullLog << "[INFO] Command usage summary printed\n";
         return Result();
     }
-    else if (cmd == "verbose") {
+    else if (id == CommandParser::CMD_VERBOSE) {
         globalStats.countVerbose++; // Track usage of 'verbose' command
         globalStats.commandUsage["verbose"]++;
         string arg;
@@ -751,7 +1413,7 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
             fullLog << "[VERBOSE] Verbose logging is now DISABLED\n";
         return res;
     }
-    else if (cmd == "color") {
+    else if (id == CommandParser::CMD_COLOR) {
     	globalStats.countColor++; // Increment 'color' command count
     	globalStats.commandUsage["color"]++;
 
@@ -781,7 +1443,7 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
     	}
     	return res;
 	}
-    else if (cmd == "heatmap") {
+    else if (id == CommandParser::CMD_HEATMAP) {
         globalStats.countHeatmap++; // Track usage count for 'heatmap' command
 		globalStats.commandUsage["heatmap"]++;
         Logger::logRequestHeatmap(); // Log current request statistics to CSV
@@ -795,7 +1457,7 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
             fullLog << "[VERBOSE] Mid-session heatmap written to logs/request_heatmap.csv\n";
         return res;
     }
-    else if (cmd == "exit") {
+    else if (id == CommandParser::CMD_EXIT) {
         globalStats.countExit++;  			// Increment usage counter for 'exit'
         Logger::log("EXIT → Session ended", Logger::INFO); // Log session termination
         if (verboseMode)
@@ -804,36 +1466,67 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
         res.status = EXIT;					// Set result status to EXIT to trigger shutdown
         return res;
     }
-    else if (cmd == "save") {
+    else if (id == CommandParser::CMD_SAVE) {
         globalStats.countSave++; 			// Increment usage counter for 'save'
-        banker.saveState("logs/save.txt");	// Save current system state to file
+        if (parts.size() >= 2 && parts[1] == "bin") {
+            // save bin [file]: binary checkpoint, written to a temp file and renamed into place
+            string path = (parts.size() >= 3) ? parts[2] : "logs/save.bin";
+            if (!banker.saveBinary(path)) {
+                cout << COLOR_RED << "[ERROR] Could not write binary checkpoint " << path << "\n" << COLOR_RESET;
+                fullLog << "[ERROR] Could not write binary checkpoint " << path << "\n";
+                Logger::log("SAVE → Binary checkpoint failed: " + path, Logger::ERROR);
+                return res;
+            }
+            Logger::log("SAVE → Binary checkpoint saved to " + path, Logger::INFO);
+            cout << "State saved to " << path << " (binary)\n";
+            if (verboseMode)
+                fullLog << "[VERBOSE] Binary checkpoint saved to " << path << "\n";
+            return res;
+        }
+        if (Journal::isOpen()) {
+            // With journaling on, save is a checkpoint: save.txt is replaced atomically and the journal restarts
+            if (!Journal::checkpoint(banker)) {
+                cout << COLOR_RED << "[ERROR] Checkpoint failed; logs/save.txt and the journal are unchanged.\n"
+                     << COLOR_RESET;
+                fullLog << "[ERROR] Checkpoint failed.\n";
+                Logger::log("SAVE → Checkpoint failed", Logger::ERROR);
+                return res;
+            }
+        } else {
+            banker.saveState("logs/save.txt");	// Save current system state to file
+        }
         Logger::log("SAVE → State saved to logs/save.txt", Logger::INFO); // Log save action
         cout << "State saved to logs/save.txt\n"; // Inform user on console
         if (verboseMode)
             fullLog << "[VERBOSE] Snapshot saved to logs/save.txt\n";
         return res;
     }
-    else if (cmd == "load") {
+    else if (id == CommandParser::CMD_LOAD) {
         globalStats.countLoad++;							// Increment 'load' command usage
-        bool success = banker.loadState("logs/save.txt");   // Attempt to load system state from file
+        // load bin [file] reads a binary checkpoint from save bin; plain load reads the text save.txt
+        bool binary = parts.size() >= 2 && parts[1] == "bin";
+        string path = binary ? (parts.size() >= 3 ? parts[2] : "logs/save.bin") : "logs/save.txt";
+        bool success = binary ? banker.loadBinary(path) : banker.loadState(path); // Attempt to load system state
+        if (success)
+            Journal::logState(banker);
 
         if (success) {
-            Logger::log("LOAD → State loaded from logs/save.txt", Logger::INFO); // Log successful load
-            cout << "State loaded from logs/save.txt\n";						 // Inform the user on console
+            Logger::log("LOAD → State loaded from " + path, Logger::INFO); // Log successful load
+            cout << "State loaded from " << path << "\n";				  // Inform the user on console
         } else {
             Logger::log("LOAD → Failed to load state", Logger::WARN);			// Log failure to load
-            cout << "Failed to load state from logs/save.txt\n";				// Inform user of failure
+            cout << "Failed to load state from " << path << "\n";				// Inform user of failure
         }
 
         if (verboseMode) {
             if (success)
-                fullLog << "[VERBOSE] Snapshot loaded from logs/save.txt\n";	// Verbose log for success
+                fullLog << "[VERBOSE] Snapshot loaded from " << path << "\n";	// Verbose log for success
             else
                 fullLog << "[VERBOSE] Failed to load snapshot\n";				// Verbose log for failure
         }
         return res;
     }
-    else if (cmd == "savepoint") {
+    else if (id == CommandParser::CMD_SAVEPOINT) {
         globalStats.countSavepoint++;				// Track usage of the savepoint command
         globalStats.commandUsage["savepoint"]++;	// Increment named command usage count
 
@@ -853,7 +1546,33 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
         res.status = CommandHandler::SUCCESS; // Mark result as successful
         return res;
     }
-	else if (cmd == "compare") {
+    else if (id == CommandParser::CMD_SAVEPOINTS) {
+		// Every savepoint with the allocation blocks it shares and the bytes it holds
+        globalStats.countSavepoints++;
+        globalStats.commandUsage["savepoints"]++;
+
+        vector<Banker::SavepointUsage> usage;
+        size_t totalBytes = 0, fullCopyBytes = 0;
+        banker.savepointUsage(usage, totalBytes, fullCopyBytes);
+
+        stringstream msg;
+        if (usage.empty()) {
+            msg << "No savepoints.\n";
+        } else {
+            msg << "Savepoints (" << BANKER_SAVEPOINT_BLOCK_ROWS << " customers per allocation block):\n";
+            for (size_t k = 0; k < usage.size(); ++k) {
+                const Banker::SavepointUsage& u = usage[k];
+                msg << "  " << u.name << ": " << u.blocks << " block" << (u.blocks == 1 ? "" : "s") << " ("
+                    << u.sharedBlocks << " shared), " << u.ownBytes << " bytes own + " << u.sharedBytes
+                    << " bytes shared\n";
+            }
+            msg << "Total: " << totalBytes << " bytes (full copies would take " << fullCopyBytes << ")\n";
+        }
+        cout << msg.str();
+        fullLog << msg.str();
+        return res;
+    }
+	else if (id == CommandParser::CMD_COMPARE) {
         globalStats.countCompare++;				// Track total uses of 'compare
         globalStats.commandUsage["compare"]++;  // Increment command-specific usage count
 
@@ -883,7 +1602,7 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
         }
         return res;
     }
-    else if (cmd == "diff") {
+    else if (id == CommandParser::CMD_DIFF) {
 		// Track usage of 'diff command'
         globalStats.countDiff++;
         globalStats.commandUsage["diff"]++;
@@ -915,7 +1634,7 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
         }
         return res;
     }
-    else if (cmd == "rollback") {
+    else if (id == CommandParser::CMD_ROLLBACK) {
 		// Increment command usage statistics for rollback
         globalStats.countRollback++;
         globalStats.commandUsage["rollback"]++;
@@ -928,6 +1647,8 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
 
 		// Attempt rollback to specific savepoint
         bool success = banker.rollback(label);
+        if (success)
+            Journal::logState(banker);
 
         if (success) {
 			// Rollback succeeds - print confirmation and log the action
@@ -951,14 +1672,15 @@ CommandHandler::Result CommandHandler::process(const std::string& input, Banker&
 
 		// Constructing error message with a list of valid command options
 		string msg = "Unknown command. Try:\n"
-             "  RQ, RL, *, safety, snapshot, undo, report, explain,\n"
-             "  summary, test, save, load, history, !N, verbose, color,\n"
-			 "  savepoint, rollback, heatmap, help, compare, diff, exit\n";
+             "  RQ, RQB, RL, *, safety, engine, log, binlog, custlog, journal, snapshot, undo, redo,\n"
+             "  report, explain, summary, test, replay, save, load, history, !N, verbose, color,\n"
+			 "  savepoint, savepoints, rollback, heatmap, help, preview, preview-file, compare,\n"
+			 "  diff, exit\n";
 		// Print error to console & log it
         cout << COLOR_RED<< msg << COLOR_RESET;
         fullLog << msg;
         if (verboseMode)
-            fullLog << "[INFO] Unknown command received " << cmd << "\n";
+            fullLog << "[INFO] Unknown command received " << parts[0] << "\n";
         return res;
     }
 }
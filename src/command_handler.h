@@ -4,6 +4,7 @@
 #define COMMAND_HANDLER_H
 
 #include <string>
+#include <cstddef>
 #include "banker.h"
 
 // Global flag to signal exit from test mode
@@ -40,6 +41,9 @@ public:
     * @return Status code indicating action taken
     */
     static Result process(const std::string& input, Banker& banker);
+
+    // Same for a line that is not a std::string of its own, e.g. one line of an mmap()ed script
+    static Result process(const char* line, size_t length, Banker& banker);
 };
 
 #endif //COMMAND_HANDLER_H
\ No newline at end of file
@@ -0,0 +1,154 @@
+// Calla Chen
+// Source Code File 29/29 for EECS 111 Project #3
+#include "command_parser.h"
+#include <cstring>
+#include <climits>
+
+// Every command and alias the interpreter accepts; names are case-sensitive
+struct CommandName {
+    const char* name;
+    CommandParser::CommandId id;
+};
+
+static const CommandName commandNames[] = {
+    { "*", CommandParser::CMD_STAR },
+    { "RQ", CommandParser::CMD_RQ }, { "req", CommandParser::CMD_RQ }, { "rq", CommandParser::CMD_RQ },
+    { "RQB", CommandParser::CMD_RQB }, { "rqb", CommandParser::CMD_RQB },
+    { "RL", CommandParser::CMD_RL }, { "rel", CommandParser::CMD_RL }, { "rl", CommandParser::CMD_RL },
+    { "safety", CommandParser::CMD_SAFETY },
+    { "engine", CommandParser::CMD_ENGINE },
+    { "log", CommandParser::CMD_LOG },
+    { "binlog", CommandParser::CMD_BINLOG },
+    { "custlog", CommandParser::CMD_CUSTLOG },
+    { "journal", CommandParser::CMD_JOURNAL },
+    { "reset", CommandParser::CMD_RESET },
+    { "report", CommandParser::CMD_REPORT }, { "rep", CommandParser::CMD_REPORT },
+    { "explain", CommandParser::CMD_EXPLAIN }, { "xpl", CommandParser::CMD_EXPLAIN },
+    { "preview", CommandParser::CMD_PREVIEW }, { "pre", CommandParser::CMD_PREVIEW },
+    { "preview-file", CommandParser::CMD_PREVIEW_FILE }, { "pf", CommandParser::CMD_PREVIEW_FILE },
+    { "snapshot", CommandParser::CMD_SNAPSHOT }, { "snap", CommandParser::CMD_SNAPSHOT },
+    { "undo", CommandParser::CMD_UNDO }, { "undo!", CommandParser::CMD_UNDO },
+    { "redo", CommandParser::CMD_REDO },
+    { "test", CommandParser::CMD_TEST },
+    { "replay", CommandParser::CMD_REPLAY },
+    { "history", CommandParser::CMD_HISTORY }, { "hist", CommandParser::CMD_HISTORY },
+    { "recap", CommandParser::CMD_RECAP },
+    { "help", CommandParser::CMD_HELP },
+    { "summary", CommandParser::CMD_SUMMARY }, { "sum", CommandParser::CMD_SUMMARY },
+    { "verbose", CommandParser::CMD_VERBOSE }, { "v", CommandParser::CMD_VERBOSE },
+    { "color", CommandParser::CMD_COLOR }, { "c", CommandParser::CMD_COLOR },
+    { "heatmap", CommandParser::CMD_HEATMAP }, { "hm", CommandParser::CMD_HEATMAP },
+    { "exit", CommandParser::CMD_EXIT }, { "q", CommandParser::CMD_EXIT },
+    { "save", CommandParser::CMD_SAVE },
+    { "load", CommandParser::CMD_LOAD },
+    { "savepoint", CommandParser::CMD_SAVEPOINT }, { "sp", CommandParser::CMD_SAVEPOINT },
+    { "savepoints", CommandParser::CMD_SAVEPOINTS },
+    { "compare", CommandParser::CMD_COMPARE }, { "cmp", CommandParser::CMD_COMPARE },
+    { "diff", CommandParser::CMD_DIFF }, { "df", CommandParser::CMD_DIFF },
+    { "rollback", CommandParser::CMD_ROLLBACK }, { "rb", CommandParser::CMD_ROLLBACK }
+};
+static const int commandNameCount = sizeof(commandNames) / sizeof(commandNames[0]);
+
+// FNV-1a over the name, mixed with the seed
+static unsigned hashName(const char* text, size_t length, unsigned seed) {
+    unsigned h = 2166136261u ^ seed;
+    for (size_t i = 0; i < length; ++i)
+        h = (h ^ (unsigned char)text[i]) * 16777619u;
+    return (h ^ (h >> 15)) & (COMMAND_TABLE_SLOTS - 1);
+}
+
+// Slot -> 1 + index into commandNames, or 0 if empty
+struct CommandTable {
+    unsigned seed;
+    unsigned char slots[COMMAND_TABLE_SLOTS];
+};
+
+// Tries seeds until no two names share a slot; with ~60 names in 512 slots that takes a few dozen tries
+static CommandTable buildCommandTable() {
+    CommandTable table;
+    for (table.seed = 1;; ++table.seed) {
+        memset(table.slots, 0, sizeof(table.slots));
+        int placed = 0;
+        for (; placed < commandNameCount; ++placed) {
+            const char* name = commandNames[placed].name;
+            unsigned slot = hashName(name, strlen(name), table.seed);
+            if (table.slots[slot]) break;
+            table.slots[slot] = (unsigned char)(placed + 1);
+        }
+        if (placed == commandNameCount) return table;
+    }
+}
+
+static const CommandTable commandTable = buildCommandTable();
+
+static bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+CommandParser::Tokenizer::Tokenizer(const char* begin, const char* end) : cursor(begin), end(end) {}
+
+bool CommandParser::Tokenizer::next(Token& token) {
+    while (cursor < end && isBlank(*cursor)) ++cursor;
+    if (cursor == end) return false;
+    token.text = cursor;
+    while (cursor < end && !isBlank(*cursor)) ++cursor;
+    token.length = cursor - token.text;
+    return true;
+}
+
+CommandParser::IntResult CommandParser::Tokenizer::nextInt(int& value, Token& token) {
+    if (!next(token) || token.text[0] == '#') return INT_END;
+    return parseInt(token.text, token.length, value);
+}
+
+const char* CommandParser::Tokenizer::position() const {
+    return cursor;
+}
+
+CommandParser::CommandId CommandParser::lookup(const char* name, size_t length) {
+    unsigned char entry = commandTable.slots[hashName(name, length, commandTable.seed)];
+    if (!entry) return CMD_UNKNOWN;
+    const CommandName& candidate = commandNames[entry - 1];
+    if (strlen(candidate.name) != length || memcmp(candidate.name, name, length) != 0) return CMD_UNKNOWN;
+    return candidate.id;
+}
+
+const char* CommandParser::name(CommandId id) {
+    // The canonical name comes first among its aliases
+    for (int i = 0; i < commandNameCount; ++i)
+        if (commandNames[i].id == id) return commandNames[i].name;
+    return "";
+}
+
+CommandParser::IntResult CommandParser::parseInt(const char* text, size_t length, int& value) {
+    size_t i = 0;
+    bool negative = false;
+    if (length > 0 && (text[0] == '-' || text[0] == '+')) {
+        negative = (text[0] == '-');
+        i = 1;
+    }
+    if (i == length) return INT_MALFORMED;
+
+    // Accumulate as a negative number so INT_MIN fits
+    const int limit = negative ? INT_MIN : -INT_MAX;
+    int total = 0;
+    bool overflow = false;
+    for (; i < length; ++i) {
+        if (text[i] < '0' || text[i] > '9') return INT_MALFORMED;
+        int digit = text[i] - '0';
+        if (total < (limit + digit) / 10) overflow = true;
+        else total = total * 10 - digit;
+    }
+    if (overflow) return INT_RANGE;
+    value = negative ? total : -total;
+    return INT_OK;
+}
+
+void CommandParser::trim(const char*& begin, const char*& end) {
+    while (begin < end && isBlank(*begin)) ++begin;
+    while (end > begin && isBlank(end[-1])) --end;
+}
+
+unsigned CommandParser::tableSeed() {
+    return commandTable.seed;
+}
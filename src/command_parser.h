@@ -0,0 +1,56 @@
+// Calla Chen
+// Source Code File 28/29 for EECS 111 Project #3
+#ifndef COMMAND_PARSER_H
+#define COMMAND_PARSER_H
+
+#include <cstddef>
+
+// Allocation-free parsing for CommandHandler::process.
+//
+// Tokens are spans into the caller's line; nothing is copied. Command names and aliases resolve to a CommandId through
+// a perfect hash built once at startup (the hash seed is searched until every name lands in a slot of its own), so a
+// lookup is one hash, one length check and one memcmp(). Integers are parsed strictly: an optional sign and decimal
+// digits, nothing else, within the range of int.
+#define COMMAND_TABLE_SLOTS 512         // Power of two, several times the number of names
+
+class CommandParser {
+public:
+    enum CommandId {
+        CMD_UNKNOWN = 0,
+        CMD_STAR, CMD_RQ, CMD_RQB, CMD_RL, CMD_SAFETY, CMD_ENGINE, CMD_LOG, CMD_BINLOG, CMD_CUSTLOG, CMD_JOURNAL,
+        CMD_RESET, CMD_REPORT, CMD_EXPLAIN, CMD_PREVIEW, CMD_PREVIEW_FILE, CMD_SNAPSHOT, CMD_UNDO, CMD_REDO,
+        CMD_TEST, CMD_REPLAY, CMD_HISTORY, CMD_RECAP, CMD_HELP, CMD_SUMMARY, CMD_VERBOSE, CMD_COLOR, CMD_HEATMAP, CMD_EXIT,
+        CMD_SAVE, CMD_LOAD, CMD_SAVEPOINT, CMD_SAVEPOINTS, CMD_COMPARE, CMD_DIFF, CMD_ROLLBACK,
+        CMD_COUNT
+    };
+    enum IntResult {
+        INT_OK = 0,
+        INT_END,                        // No tokens left, or only a trailing '#' comment
+        INT_MALFORMED,                  // Not an optional sign followed by decimal digits
+        INT_RANGE                       // Does not fit in an int
+    };
+    struct Token {
+        const char* text;
+        size_t length;
+    };
+
+    // Walks [begin, end) token by token, splitting on blanks, tabs, CR and LF
+    class Tokenizer {
+    public:
+        Tokenizer(const char* begin, const char* end);
+        bool next(Token& token);                        // false when no tokens are left
+        IntResult nextInt(int& value, Token& token);    // token is what was read, for error messages
+        const char* position() const;                   // Start of the unread rest of the line
+    private:
+        const char* cursor;
+        const char* end;
+    };
+
+    static CommandId lookup(const char* name, size_t length);  // CMD_UNKNOWN if not a command or alias
+    static const char* name(CommandId id);                     // Canonical name, e.g. "RQ" for "req"
+    static IntResult parseInt(const char* text, size_t length, int& value);
+    static void trim(const char*& begin, const char*& end);    // Drops leading and trailing whitespace
+    static unsigned tableSeed();                               // The seed the perfect hash settled on
+};
+
+#endif //COMMAND_PARSER_H
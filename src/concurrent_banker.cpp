@@ -0,0 +1,131 @@
+// Calla Chen
+// Source Code File 17/17 for EECS 111 Project #3
+#include "concurrent_banker.h"
+#include "kernels.h"
+#include "validator.h"
+
+using namespace std;
+
+// Holds a pthread mutex for the lifetime of a scope
+class ScopedLock {
+public:
+    explicit ScopedLock(pthread_mutex_t* m) : lock(m) { pthread_mutex_lock(lock); }
+    ~ScopedLock() { pthread_mutex_unlock(lock); }
+private:
+    pthread_mutex_t* lock;
+};
+
+/**
+ * @brief Wraps a fully loaded Banker for use from many threads.
+ *
+ * The row kernels are selected here, before any worker thread can race on their first-use dispatch. The Banker's undo
+ * log is turned off meanwhile: commitRequest() and releaseConcurrent() do not record, so it could not stay consistent.
+ */
+ConcurrentBanker::ConcurrentBanker(Banker& b, ReleaseMode mode) : banker(b), releaseMode(mode) {
+    Kernels::init();
+    banker.setConcurrentReleases(mode == RELEASE_LOCK_FREE);
+    undoBudget = banker.undoStats().budgetBytes;
+    banker.setUndoBudget(0);
+    pthread_mutex_init(&lock, NULL);
+}
+
+ConcurrentBanker::~ConcurrentBanker() {
+    banker.setConcurrentReleases(false);
+    banker.setUndoBudget(undoBudget);
+    pthread_mutex_destroy(&lock);
+}
+
+int ConcurrentBanker::getNumCustomers() const {
+    return banker.getNumCustomers(); // Dimensions never change after construction
+}
+
+int ConcurrentBanker::getNumResources() const {
+    return banker.getNumResources();
+}
+
+// Customer in range and no negative amounts (checked before taking any lock)
+bool ConcurrentBanker::validRequest(int customerNum, const int request[]) const {
+    return Validator::isValidCustomer(customerNum, banker.getNumCustomers()) &&
+           Validator::isValidRequest(request, banker.getNumResources());
+}
+
+/**
+ * @brief Decides and commits one request under the lock.
+ *
+ * @return A Banker::RequestResult, or INVALID_REQUEST for a bad customer ID or negative amounts.
+ */
+int ConcurrentBanker::request(int customerNum, const int request[]) {
+    if (!validRequest(customerNum, request)) return Banker::INVALID_REQUEST;
+
+    Banker::CommitPath path;
+    vector<int> sequence;
+    vector<bool> finish;
+    ScopedLock guard(&lock);
+    return banker.commitRequest(customerNum, request, path, sequence, finish);
+}
+
+/**
+ * @brief Validates a release against the customer's current allocation and applies it.
+ *
+ * In lock-free mode no lock is taken: Banker::releaseConcurrent() checks the allocation with compare-and-swap while
+ * it takes the units, so a release racing with another release of the same customer can still never overdraw it.
+ */
+bool ConcurrentBanker::release(int customerNum, const int release[]) {
+    if (releaseMode == RELEASE_LOCK_FREE)
+        return validRequest(customerNum, release) && banker.releaseConcurrent(customerNum, release);
+
+    ScopedLock guard(&lock);
+    StateView view = banker.currentView();
+    if (!Validator::isValidRelease(release, view.allocation, view.rowStride, view.numResources,
+                                   customerNum, view.numCustomers))
+        return false;
+    banker.release(customerNum, release);
+    return true;
+}
+
+/**
+ * @brief Reports what request() would decide against the latest published state, without committing or locking.
+ */
+int ConcurrentBanker::preview(int customerNum, const int request[], vector<int>& sequence) const {
+    if (!validRequest(customerNum, request)) return Banker::INVALID_REQUEST;
+
+    Banker::StateSnapshot snap;
+    banker.readSnapshot(snap);
+    return banker.previewRequest(snap.view(), customerNum, request, sequence);
+}
+
+/**
+ * @brief Need and available checks only, against the latest published state.
+ */
+bool ConcurrentBanker::wouldGrant(int customerNum, const int request[]) const {
+    if (!validRequest(customerNum, request)) return false;
+
+    Banker::StateSnapshot snap;
+    banker.readSnapshot(snap);
+    return banker.wouldGrantRequest(snap.view(), customerNum, request);
+}
+
+/**
+ * @brief Copies a consistent available/allocation/need state for reporting, without locking.
+ *
+ * Matrices are returned row-major without padding (getNumResources() ints per row).
+ */
+void ConcurrentBanker::snapshotState(vector<int>& available, vector<int>& allocation, vector<int>& need) const {
+    Banker::StateSnapshot snap;
+    banker.readSnapshot(snap);
+    StateView view = snap.view();
+    int n = view.numCustomers;
+    int m = view.numResources;
+
+    available.assign(view.available, view.available + m);
+    allocation.resize((size_t)n * m);
+    need.resize((size_t)n * m);
+    for (int i = 0; i < n; ++i) {
+        const int* allocRow = view.allocationRow(i);
+        const int* needRow = view.needRow(i);
+        for (int j = 0; j < m; ++j) {
+            allocation[(size_t)i * m + j] = allocRow[j];
+            need[(size_t)i * m + j] = needRow[j];
+        }
+    }
+}
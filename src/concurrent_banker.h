@@ -0,0 +1,51 @@
+// Calla Chen
+// Source Code File 16/17 for EECS 111 Project #3
+#ifndef CONCURRENT_BANKER_H
+#define CONCURRENT_BANKER_H
+
+#include <vector>
+#include <pthread.h>
+#include "banker.h"
+
+// Thread-safe front for one Banker shared by many request threads.
+//
+// Requests take the lock and go through Banker::commitRequest(), which produces no console or log output. Releases
+// either take the lock too (RELEASE_LOCKED) or skip it and use Banker::releaseConcurrent() (RELEASE_LOCK_FREE).
+// Read-only queries never take the lock: they copy the latest published state with Banker::readSnapshot() and run the
+// pure safety kernel on the copy, so they neither block writers nor see a half-applied commit. The wrapped Banker must
+// not be used directly while the front is in use.
+class ConcurrentBanker {
+public:
+    enum ReleaseMode {
+        RELEASE_LOCKED = 0,     // Releases serialize with requests on the exclusive lock
+        RELEASE_LOCK_FREE = 1   // Releases use atomic updates and never block
+    };
+    explicit ConcurrentBanker(Banker& banker, ReleaseMode mode = RELEASE_LOCK_FREE);
+    ~ConcurrentBanker();
+
+    // Writers (the lock, except lock-free releases)
+    int request(int customerNum, const int request[]);     // Banker::RequestResult
+    bool release(int customerNum, const int release[]);    // false if invalid (more than held, bad customer)
+
+    // Readers (no lock; each works on its own published snapshot)
+    int preview(int customerNum, const int request[], std::vector<int>& sequence) const; // Verdict without committing
+    bool wouldGrant(int customerNum, const int request[]) const;                         // Need/available checks only
+    void snapshotState(std::vector<int>& available, std::vector<int>& allocation,       // Consistent copy for reports
+                       std::vector<int>& need) const;
+
+    int getNumCustomers() const;
+    int getNumResources() const;
+
+private:
+    ConcurrentBanker(const ConcurrentBanker&);              // Not copyable: owns the lock
+    ConcurrentBanker& operator=(const ConcurrentBanker&);
+
+    bool validRequest(int customerNum, const int request[]) const;
+
+    Banker& banker;
+    ReleaseMode releaseMode;
+    size_t undoBudget;                                      // The Banker's, restored when the front goes away
+    pthread_mutex_t lock;                                   // Serializes writers only
+};
+
+#endif //CONCURRENT_BANKER_H
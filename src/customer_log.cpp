@@ -0,0 +1,116 @@
+// Calla Chen
+// Source Code File 25/25 for EECS 111 Project #3
+#include "customer_log.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+using namespace std;
+
+// Where one entry lives in the segment
+struct Extent {
+    unsigned long offset;
+    unsigned int length;                // Without the newline
+};
+
+static int segmentFd = -1;
+static string segmentPath;
+static vector<vector<Extent> > customerIndex;   // Per customer, in append order
+static string pending;                  // Entries not yet written; they start at offset 'committed'
+static unsigned long committed = 0;
+static unsigned long entries = 0;
+static unsigned long commits = 0;
+static long long lastCommit = 0;
+
+static long long nowMillis() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return (long long)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+bool CustomerLog::open(int numCustomers, const std::string& path) {
+    close();
+    segmentFd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (segmentFd < 0) return false;
+    segmentPath = path;
+    customerIndex.assign(numCustomers, vector<Extent>());
+    pending.clear();
+    committed = entries = commits = 0;
+    lastCommit = nowMillis();
+    return true;
+}
+
+void CustomerLog::close() {
+    if (segmentFd < 0) return;
+    commit();
+    ::close(segmentFd);
+    segmentFd = -1;
+}
+
+bool CustomerLog::isOpen() {
+    return segmentFd >= 0;
+}
+
+void CustomerLog::append(int customer, const std::string& entry) {
+    if (segmentFd < 0 || customer < 0 || customer >= (int)customerIndex.size()) return;
+    Extent e;
+    e.offset = committed + pending.size();
+    e.length = entry.size();
+    customerIndex[customer].push_back(e);
+    pending += entry;
+    pending += '\n';
+    ++entries;
+
+    if (pending.size() >= CUSTOMER_LOG_COMMIT_BYTES || nowMillis() - lastCommit >= CUSTOMER_LOG_COMMIT_MS)
+        commit();
+}
+
+void CustomerLog::commit() {
+    lastCommit = nowMillis();
+    if (segmentFd < 0 || pending.empty()) return;
+    const char* data = pending.data();
+    size_t left = pending.size();
+    while (left > 0) {
+        ssize_t n = ::write(segmentFd, data, left);
+        if (n <= 0) break;              // Disk full: keep the index, the reads of lost entries come back short
+        data += n;
+        left -= n;
+    }
+    committed += pending.size();
+    pending.clear();
+    ++commits;
+}
+
+bool CustomerLog::read(int customer, std::vector<std::string>& out, int limit) {
+    if (segmentFd < 0 || customer < 0 || customer >= (int)customerIndex.size()) return false;
+    commit();                           // Everything indexed is now in the segment
+    const vector<Extent>& extents = customerIndex[customer];
+    size_t first = (limit > 0 && (size_t)limit < extents.size()) ? extents.size() - limit : 0;
+    string line;
+    for (size_t k = first; k < extents.size(); ++k) {
+        line.resize(extents[k].length);
+        ssize_t n = extents[k].length ? pread(segmentFd, &line[0], extents[k].length, extents[k].offset) : 0;
+        if (n < 0) n = 0;
+        line.resize(n);
+        out.push_back(line);
+    }
+    return true;
+}
+
+unsigned long CustomerLog::entryCount(int customer) {
+    if (customer < 0 || customer >= (int)customerIndex.size()) return 0;
+    return customerIndex[customer].size();
+}
+
+CustomerLog::Stats CustomerLog::stats() {
+    Stats s;
+    s.entries = entries;
+    s.commits = commits;
+    s.bytes = committed;
+    s.pending = pending.size();
+    return s;
+}
+
+const std::string& CustomerLog::path() {
+    return segmentPath;
+}
@@ -0,0 +1,43 @@
+// Calla Chen
+// Source Code File 24/25 for EECS 111 Project #3
+#ifndef CUSTOMER_LOG_H
+#define CUSTOMER_LOG_H
+
+#include <string>
+#include <vector>
+
+// Per-customer request/release history for the whole session, kept in one append-only segment file
+// (logs/customers.seg) instead of one open file per customer.
+//
+// Entries are buffered and written by group commits: one write() once CUSTOMER_LOG_COMMIT_BYTES are pending or
+// CUSTOMER_LOG_COMMIT_MS have passed since the last commit. An in-memory index of (offset, length) per entry lets
+// custlog read back one customer's entries with one pread() each, without scanning the segment.
+#define CUSTOMER_LOG_COMMIT_BYTES 65536
+#define CUSTOMER_LOG_COMMIT_MS 250
+
+class CustomerLog {
+public:
+    struct Stats {
+        unsigned long entries;          // Appended since open()
+        unsigned long commits;          // write() calls
+        unsigned long bytes;            // Committed to the segment
+        unsigned long pending;          // Bytes waiting for the next commit
+    };
+
+    // Single-threaded: call from the command thread only
+    static bool open(int numCustomers, const std::string& path = "logs/customers.seg"); // Truncates the segment
+    static void close();                                                                // Commits and closes
+    static bool isOpen();
+
+    static void append(int customer, const std::string& entry); // One line, without the trailing newline
+    static void commit();                                        // Writes everything pending
+
+    // Appends customer's entries (oldest first, at most the last 'limit' if limit > 0); false if the id is out of range
+    static bool read(int customer, std::vector<std::string>& entries, int limit = 0);
+    static unsigned long entryCount(int customer);
+
+    static Stats stats();
+    static const std::string& path();
+};
+
+#endif //CUSTOMER_LOG_H
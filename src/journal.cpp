@@ -0,0 +1,499 @@
+// Calla Chen
+// Source Code File 27/27 for EECS 111 Project #3
+#include "journal.h"
+#include "banker.h"
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+using namespace std;
+
+enum JournalBase {
+    BASE_INITIAL = 0,       // The state the program was started with
+    BASE_CHECKPOINT = 1     // logs/save.txt
+};
+
+struct JournalHeader {
+    char magic[8];
+    unsigned int customers;
+    unsigned int resources;
+    unsigned int base;      // A JournalBase
+    unsigned int baseCrc;   // CRC-32 of the base: the initial state's matrices, or the checkpoint file's bytes
+    unsigned int headerCrc; // CRC-32 of everything above
+};
+
+// Writer state, shared with the interval flusher thread under 'lock'
+static int journalFd = -1;
+static string journalPath;
+static Journal::Options journalOptions;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake = PTHREAD_COND_INITIALIZER;
+static pthread_t flusher;
+static bool flusherRunning = false;
+static bool stopping = false;
+static unsigned long unsynced = 0;      // Records written since the last fsync()
+static Journal::Stats counters;
+static vector<int> scratch;             // Record being built (writers hold 'lock')
+
+// What recover() found, for open()
+static bool resumeAppend = false;       // Keep appending to the recovered journal
+static unsigned int resumeBase = BASE_INITIAL;
+static unsigned int resumeCrc = 0;
+
+Journal::Options::Options() : policy(SYNC_ALWAYS), intervalMs(JOURNAL_DEFAULT_INTERVAL_MS), batch(JOURNAL_DEFAULT_BATCH) {
+}
+
+static unsigned int crcTable[256];
+static bool crcReady = false;
+
+// CRC-32 (IEEE 802.3, reflected), continuing from 'crc' (0 to start)
+static unsigned int crc32(unsigned int crc, const void* data, size_t length) {
+    if (!crcReady) {
+        for (unsigned int i = 0; i < 256; ++i) {
+            unsigned int c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            crcTable[i] = c;
+        }
+        crcReady = true;
+    }
+    const unsigned char* p = (const unsigned char*)data;
+    crc = ~crc;
+    while (length--) crc = crcTable[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+// CRC-32 of Available, allocation and need, row by row without padding
+static unsigned int stateCrc(const Banker& banker) {
+    StateView view = banker.currentView();
+    int m = banker.getNumResources();
+    unsigned int crc = crc32(0, view.available, m * sizeof(int));
+    for (int i = 0; i < banker.getNumCustomers(); ++i) {
+        crc = crc32(crc, view.allocationRow(i), m * sizeof(int));
+        crc = crc32(crc, view.needRow(i), m * sizeof(int));
+    }
+    return crc;
+}
+
+// CRC-32 of a whole file; false if it cannot be read
+static bool fileCrc(const string& path, unsigned int& crc) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    char buf[65536];
+    size_t n;
+    crc = 0;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) crc = crc32(crc, buf, n);
+    bool ok = !ferror(f);
+    fclose(f);
+    return ok;
+}
+
+static bool writeAll(int fd, const void* data, size_t length) {
+    const char* p = (const char*)data;
+    while (length > 0) {
+        ssize_t n = ::write(fd, p, length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        length -= n;
+    }
+    return true;
+}
+
+static bool readAll(int fd, void* data, size_t length) {
+    char* p = (char*)data;
+    while (length > 0) {
+        ssize_t n = ::read(fd, p, length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        length -= n;
+    }
+    return true;
+}
+
+// Keeps a copy of a journal that is about to be truncated for a reason other than a torn tail
+static void copyFile(const string& from, const string& to) {
+    FILE* in = fopen(from.c_str(), "rb");
+    FILE* out = in ? fopen(to.c_str(), "wb") : NULL;
+    char buf[65536];
+    size_t n;
+    while (out && (n = fread(buf, 1, sizeof(buf), in)) > 0) fwrite(buf, 1, n, out);
+    if (out) fclose(out);
+    if (in) fclose(in);
+}
+
+static void fsyncDirectory(const string& path) {
+    size_t slash = path.rfind('/');
+    string dir = (slash == string::npos) ? "." : path.substr(0, slash);
+    int fd = ::open(dir.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fsync(fd);
+    ::close(fd);
+}
+
+// Creates 'path' holding only a header; returns the fd (positioned after it) or -1
+static int createJournal(const string& path, const Banker& banker, unsigned int base, unsigned int baseCrc) {
+    JournalHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, JOURNAL_MAGIC, sizeof(h.magic));
+    h.customers = banker.getNumCustomers();
+    h.resources = banker.getNumResources();
+    h.base = base;
+    h.baseCrc = baseCrc;
+    h.headerCrc = crc32(0, &h, offsetof(JournalHeader, headerCrc));
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return -1;
+    if (!writeAll(fd, &h, sizeof(h)) || fsync(fd) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Caller holds 'lock'
+static void syncLocked() {
+    if (journalFd < 0 || unsynced == 0) return;
+    fdatasync(journalFd);
+    unsynced = 0;
+    ++counters.syncs;
+}
+
+static void* flusherMain(void*) {
+    pthread_mutex_lock(&lock);
+    while (!stopping) {
+        timeval now;
+        gettimeofday(&now, NULL);
+        long long ns = (now.tv_usec * 1000LL) + journalOptions.intervalMs * 1000000LL;
+        timespec deadline;
+        deadline.tv_sec = now.tv_sec + ns / 1000000000LL;
+        deadline.tv_nsec = ns % 1000000000LL;
+        pthread_cond_timedwait(&wake, &lock, &deadline);
+        syncLocked();
+    }
+    pthread_mutex_unlock(&lock);
+    return NULL;
+}
+
+// Appends one record (type, customer, count, values) and applies the sync policy
+static void append(int type, int customer, const int* values, int count, const int* more = 0, int moreCount = 0) {
+    pthread_mutex_lock(&lock);
+    if (journalFd < 0) {
+        pthread_mutex_unlock(&lock);
+        return;
+    }
+    unsigned int total = count + moreCount;
+    scratch.resize(5 + total);
+    scratch[2] = type;
+    scratch[3] = customer;
+    scratch[4] = total;
+    if (count) memcpy(&scratch[5], values, count * sizeof(int));
+    if (moreCount) memcpy(&scratch[5 + count], more, moreCount * sizeof(int));
+    unsigned int length = (3 + total) * sizeof(int);
+    scratch[0] = (int)length;
+    scratch[1] = (int)crc32(0, &scratch[2], length);
+
+    if (writeAll(journalFd, &scratch[0], length + 2 * sizeof(int))) {
+        ++counters.records;
+        counters.bytes += length + 2 * sizeof(int);
+        ++unsynced;
+        if (journalOptions.policy == Journal::SYNC_ALWAYS ||
+            (journalOptions.policy == Journal::SYNC_BATCH && unsynced >= (unsigned long)journalOptions.batch))
+            syncLocked();
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+bool Journal::parsePolicy(const std::string& spec, Options& options) {
+    Options o;
+    if (spec == "always") o.policy = SYNC_ALWAYS;
+    else if (spec == "none") o.policy = SYNC_NONE;
+    else if (spec.compare(0, 2, "ms") == 0 || spec.compare(0, 3, "ops") == 0) {
+        bool interval = spec[0] == 'm';
+        size_t prefix = interval ? 2 : 3;
+        o.policy = interval ? SYNC_INTERVAL : SYNC_BATCH;
+        if (spec.size() > prefix) {
+            if (spec[prefix] != ':') return false;
+            char* end;
+            long value = strtol(spec.c_str() + prefix + 1, &end, 10);
+            if (*end != '\0' || end == spec.c_str() + prefix + 1 || value < 1 || value > 3600000) return false;
+            if (interval) o.intervalMs = (int)value;
+            else o.batch = (int)value;
+        }
+    }
+    else return false;
+    options = o;
+    return true;
+}
+
+std::string Journal::describe(const Options& options) {
+    char buf[64];
+    switch (options.policy) {
+        case SYNC_ALWAYS: return "fsync every operation";
+        case SYNC_INTERVAL: snprintf(buf, sizeof(buf), "fsync every %d ms", options.intervalMs); return buf;
+        case SYNC_BATCH: snprintf(buf, sizeof(buf), "fsync every %d operations", options.batch); return buf;
+        default: return "no fsync";
+    }
+}
+
+// Moves an unusable journal out of the way so it is kept for inspection but not replayed
+static void setAside(const string& path, Journal::Recovery& r, const string& why) {
+    r.error = why + "; moved to " + path + ".old";
+    rename(path.c_str(), (path + ".old").c_str());
+}
+
+Journal::Recovery Journal::recover(Banker& banker, const std::string& path) {
+    Recovery r;
+    r.found = r.fromCheckpoint = r.checkpointNewer = false;
+    r.records = r.requests = r.releases = r.states = r.tornBytes = 0;
+    resumeAppend = false;
+    resumeBase = BASE_INITIAL;
+    resumeCrc = stateCrc(banker);
+
+    int fd = ::open(path.c_str(), O_RDWR);
+    if (fd < 0) return r;
+    r.found = true;
+
+    JournalHeader h;
+    if (!readAll(fd, &h, sizeof(h)) || memcmp(h.magic, JOURNAL_MAGIC, sizeof(h.magic)) != 0
+        || h.headerCrc != crc32(0, &h, offsetof(JournalHeader, headerCrc))) {
+        ::close(fd);
+        setAside(path, r, "journal header is damaged");
+        return r;
+    }
+    if ((int)h.customers != banker.getNumCustomers() || (int)h.resources != banker.getNumResources()) {
+        ::close(fd);
+        char why[96];
+        snprintf(why, sizeof(why), "journal is for %u customers x %u resources", h.customers, h.resources);
+        setAside(path, r, why);
+        return r;
+    }
+
+    // Load the base state the journal continues from
+    if (h.base == BASE_CHECKPOINT) {
+        unsigned int crc;
+        if (!fileCrc(JOURNAL_CHECKPOINT_PATH, crc) || !banker.loadState(JOURNAL_CHECKPOINT_PATH)) {
+            ::close(fd);
+            setAside(path, r, "checkpoint " JOURNAL_CHECKPOINT_PATH " is missing or unreadable");
+            return r;
+        }
+        r.fromCheckpoint = true;
+        resumeBase = BASE_CHECKPOINT;
+        resumeCrc = crc;
+        if (crc != h.baseCrc) {
+            // A checkpoint finished writing save.txt but not the new journal: save.txt already holds every record
+            ::close(fd);
+            r.checkpointNewer = true;
+            return r;
+        }
+    } else if (h.baseCrc != resumeCrc) {
+        ::close(fd);
+        setAside(path, r, "journal was started with a different maximum file or available units");
+        return r;
+    }
+
+    // Replay every intact record; the first short or corrupt one ends the journal
+    off_t good = sizeof(h);
+    off_t size = lseek(fd, 0, SEEK_END);
+    lseek(fd, good, SEEK_SET);
+    int m = banker.getNumResources();
+    size_t matrixInts = (size_t)banker.getNumCustomers() * m;
+    size_t stateInts = m + 2 * matrixInts;
+    vector<int> payload;
+    for (;;) {
+        unsigned int prefix[2];
+        if (!readAll(fd, prefix, sizeof(prefix))) break;
+        if (prefix[0] < 3 * sizeof(int) || prefix[0] % sizeof(int) != 0 || (off_t)prefix[0] > size - good) break;
+        payload.resize(prefix[0] / sizeof(int));
+        if (!readAll(fd, &payload[0], prefix[0]) || crc32(0, &payload[0], prefix[0]) != prefix[1]) break;
+        int type = payload[0], customer = payload[1];
+        size_t count = (size_t)payload[2];
+        if (count != payload.size() - 3) break;
+
+        bool applied = false;
+        if ((type == RECORD_REQUEST || type == RECORD_RELEASE) && count == (size_t)m) {
+            applied = (type == RECORD_REQUEST) ? banker.replayRequest(customer, &payload[3])
+                                               : banker.replayRelease(customer, &payload[3]);
+            if (applied) ++(type == RECORD_REQUEST ? r.requests : r.releases);
+        } else if (type == RECORD_STATE && count == stateInts) {
+            banker.replaceState(&payload[3], &payload[3 + m], &payload[3 + m + matrixInts]);
+            applied = true;
+            ++r.states;
+        }
+        if (!applied) {
+            char why[96];
+            snprintf(why, sizeof(why), "record %lu (type %d, customer %d) does not apply", r.records + 1, type,
+                     customer);
+            r.error = why;
+            break;
+        }
+        ++r.records;
+        good += sizeof(prefix) + prefix[0];
+    }
+
+    // Drop the torn tail (or the record that did not apply) so new records follow the last good one
+    if (!r.error.empty()) {
+        copyFile(path, path + ".old");
+        r.error += "; full journal kept as " + path + ".old";
+    }
+    if (good < size) {
+        r.tornBytes = size - good;
+        if (ftruncate(fd, good) == 0) fsync(fd);
+    }
+    ::close(fd);
+    resumeAppend = true;
+    resumeBase = h.base;
+    resumeCrc = h.baseCrc;
+    return r;
+}
+
+bool Journal::open(const Banker& banker, const Options& options, const std::string& path) {
+    close();
+    int fd;
+    if (resumeAppend) {
+        fd = ::open(path.c_str(), O_WRONLY | O_APPEND);
+    } else {
+        // No usable journal: start one from the current state (the command line's, or a newer checkpoint's)
+        string tmp = path + ".tmp";
+        fd = createJournal(tmp, banker, resumeBase,
+                           resumeBase == BASE_CHECKPOINT ? resumeCrc : stateCrc(banker));
+        if (fd >= 0 && rename(tmp.c_str(), path.c_str()) != 0) {
+            ::close(fd);
+            fd = -1;
+        }
+        if (fd >= 0) fsyncDirectory(path);
+    }
+    if (fd < 0) return false;
+
+    pthread_mutex_lock(&lock);
+    journalFd = fd;
+    journalPath = path;
+    journalOptions = options;
+    counters.records = counters.bytes = counters.syncs = 0;
+    unsynced = 0;
+    stopping = false;
+    pthread_mutex_unlock(&lock);
+    resumeAppend = true;
+
+    if (options.policy == SYNC_INTERVAL)
+        flusherRunning = pthread_create(&flusher, NULL, flusherMain, NULL) == 0;
+    return true;
+}
+
+void Journal::close() {
+    if (flusherRunning) {
+        pthread_mutex_lock(&lock);
+        stopping = true;
+        pthread_cond_signal(&wake);
+        pthread_mutex_unlock(&lock);
+        pthread_join(flusher, NULL);
+        flusherRunning = false;
+    }
+    pthread_mutex_lock(&lock);
+    if (journalFd >= 0) {
+        syncLocked();
+        ::close(journalFd);
+        journalFd = -1;
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+bool Journal::isOpen() {
+    return journalFd >= 0;
+}
+
+void Journal::logRequest(int customer, const int* amounts, int count) {
+    append(RECORD_REQUEST, customer, amounts, count);
+}
+
+void Journal::logRelease(int customer, const int* amounts, int count) {
+    append(RECORD_RELEASE, customer, amounts, count);
+}
+
+void Journal::logState(const Banker& banker) {
+    if (journalFd < 0) return;
+    StateView view = banker.currentView();
+    int n = banker.getNumCustomers(), m = banker.getNumResources();
+    // Allocation rows, then maximum rows: load replaces the claims too, and need is derived from them
+    vector<int> rows(2 * (size_t)n * m);
+    for (int i = 0; i < n; ++i) {
+        const int* allocRow = view.allocationRow(i);
+        const int* needRow = view.needRow(i);
+        int* maxRow = &rows[((size_t)n + i) * m];
+        memcpy(&rows[(size_t)i * m], allocRow, m * sizeof(int));
+        for (int j = 0; j < m; ++j) maxRow[j] = allocRow[j] + needRow[j];
+    }
+    append(RECORD_STATE, -1, view.available, m, rows.empty() ? 0 : &rows[0], (int)rows.size());
+}
+
+void Journal::sync() {
+    pthread_mutex_lock(&lock);
+    syncLocked();
+    pthread_mutex_unlock(&lock);
+}
+
+/**
+ * @brief Writes a checkpoint and restarts the journal from it.
+ *
+ * Order matters for a crash at any point: the new save.txt and the new (empty) journal are both written and synced
+ * under temporary names first, then renamed into place, save.txt first. A crash between the two renames leaves the
+ * new save.txt with the old journal, whose header no longer matches save.txt's CRC, so recovery uses save.txt alone
+ * (it already holds every record). An old journal based on the command-line state still replays correctly.
+ */
+bool Journal::checkpoint(const Banker& banker, const std::string& checkpointPath) {
+    string saveTmp = checkpointPath + ".tmp";
+    banker.saveState(saveTmp);
+    int saveFd = ::open(saveTmp.c_str(), O_RDONLY);
+    unsigned int crc;
+    if (saveFd < 0 || fsync(saveFd) != 0 || !fileCrc(saveTmp, crc)) {
+        if (saveFd >= 0) ::close(saveFd);
+        remove(saveTmp.c_str());
+        return false;
+    }
+    ::close(saveFd);
+
+    pthread_mutex_lock(&lock);
+    if (journalFd < 0) {
+        pthread_mutex_unlock(&lock);
+        bool ok = rename(saveTmp.c_str(), checkpointPath.c_str()) == 0;
+        return ok;
+    }
+    string journalTmp = journalPath + ".tmp";
+    int fd = createJournal(journalTmp, banker, BASE_CHECKPOINT, crc);
+    if (fd < 0 || rename(saveTmp.c_str(), checkpointPath.c_str()) != 0
+        || rename(journalTmp.c_str(), journalPath.c_str()) != 0) {
+        if (fd >= 0) ::close(fd);
+        remove(saveTmp.c_str());
+        remove(journalTmp.c_str());
+        pthread_mutex_unlock(&lock);
+        return false;
+    }
+    fsyncDirectory(journalPath);
+    ::close(journalFd);
+    journalFd = fd;
+    unsynced = 0;
+    pthread_mutex_unlock(&lock);
+    return true;
+}
+
+Journal::Stats Journal::stats() {
+    pthread_mutex_lock(&lock);
+    Stats s = counters;
+    pthread_mutex_unlock(&lock);
+    return s;
+}
+
+Journal::Options Journal::options() {
+    return journalOptions;
+}
+
+const std::string& Journal::path() {
+    return journalPath;
+}
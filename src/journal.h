@@ -0,0 +1,89 @@
+// Calla Chen
+// Source Code File 26/27 for EECS 111 Project #3
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <string>
+
+class Banker;
+
+// Write-ahead journal of committed operations (logs/journal.wal), enabled with --journal=<policy>.
+//
+// The journal holds everything since the latest checkpoint: the state the program started from (the command-line
+// arguments), or logs/save.txt once 'save' has run with journaling on. At startup, recover() loads that base state
+// and replays the journal on top of it, so nothing acknowledged before a crash is lost beyond what the fsync policy
+// allows.
+//
+// File: a header (magic, dimensions, base, CRC-32 of the checkpoint file, CRC-32 of the header), then one record per
+// operation: payload length and CRC-32 of the payload (uint32 each), then the payload as int32 values
+//     type, customer, count, count values.
+// Requests and releases carry one amount per resource type. Reset, undo, redo, rollback and load carry Available
+// followed by the whole allocation matrix and the whole maximum matrix, since they replace the state rather than
+// change it. Each record is written with
+// one write(), so a process crash loses nothing that was acknowledged; the policy only decides when it is fsync()ed.
+// A record that is short or fails its CRC ends the journal: recovery truncates the file there.
+#define JOURNAL_PATH "logs/journal.wal"
+#define JOURNAL_CHECKPOINT_PATH "logs/save.txt"
+#define JOURNAL_MAGIC "ZBWAL002"
+#define JOURNAL_DEFAULT_INTERVAL_MS 100
+#define JOURNAL_DEFAULT_BATCH 64
+
+class Journal {
+public:
+    enum SyncPolicy {
+        SYNC_ALWAYS = 0,        // fsync() after every operation
+        SYNC_INTERVAL = 1,      // fsync() from a background thread every interval ms, if anything was written
+        SYNC_BATCH = 2,         // fsync() after every batch operations
+        SYNC_NONE = 3           // Leave it to the OS (survives a process crash, not a power loss)
+    };
+    enum RecordType {
+        RECORD_REQUEST = 1,     // A granted request (RQ or an RQB entry)
+        RECORD_RELEASE = 2,
+        RECORD_STATE = 3        // Available, allocation and maximum after reset, undo, redo, rollback or load
+    };
+    struct Options {
+        SyncPolicy policy;
+        int intervalMs;
+        int batch;
+        Options();
+    };
+    struct Stats {
+        unsigned long records;  // Since open()
+        unsigned long bytes;
+        unsigned long syncs;    // fsync() calls
+    };
+    struct Recovery {
+        bool found;             // A journal for these dimensions existed
+        bool fromCheckpoint;    // The base state was logs/save.txt rather than the command line
+        bool checkpointNewer;   // save.txt changed after the journal started (a checkpoint interrupted mid-way)
+        unsigned long records;  // Replayed
+        unsigned long requests, releases, states;
+        unsigned long tornBytes;    // Truncated from the end
+        std::string error;      // Why replay stopped early, if it did
+    };
+
+    // "always", "none", "ms:N" or "ops:N" (also "ms" and "ops" for the defaults); false if not understood
+    static bool parsePolicy(const std::string& spec, Options& options);
+    static std::string describe(const Options& options);
+
+    // Brings banker (already holding the command-line state) up to date from the journal at 'path'
+    static Recovery recover(Banker& banker, const std::string& path = JOURNAL_PATH);
+    // Appends to the journal left by recover() (or starts one based on the current state); false if it cannot
+    static bool open(const Banker& banker, const Options& options, const std::string& path = JOURNAL_PATH);
+    static void close();                    // fsync()s and closes
+    static bool isOpen();
+
+    static void logRequest(int customer, const int* amounts, int count);
+    static void logRelease(int customer, const int* amounts, int count);
+    static void logState(const Banker& banker);
+    static void sync();                     // fsync() now if anything is pending
+
+    // Saves banker to the checkpoint file and restarts the journal from it; false (journal untouched) on failure
+    static bool checkpoint(const Banker& banker, const std::string& checkpointPath = JOURNAL_CHECKPOINT_PATH);
+
+    static Stats stats();
+    static Options options();
+    static const std::string& path();
+};
+
+#endif //JOURNAL_H
@@ -0,0 +1,285 @@
+// Calla Chen
+// Source Code File 13/13 for EECS 111 Project #3
+#include "kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace Kernels {
+
+/**
+ * @brief Scalar "row <= work" check, the reference for the SIMD versions.
+ */
+bool scalarRowFits(const int* row, const int* work, int stride) {
+    for (int j = 0; j < stride; ++j)
+        if (row[j] > work[j]) return false;
+    return true;
+}
+
+void scalarAddRow(int* work, const int* row, int stride) {
+    for (int j = 0; j < stride; ++j)
+        work[j] += row[j];
+}
+
+void scalarGrantRow(int* available, int* allocRow, int* needRow, const int* request, int stride) {
+    for (int j = 0; j < stride; ++j) {
+        available[j] -= request[j];
+        allocRow[j] += request[j];
+        needRow[j] -= request[j];
+    }
+}
+
+void scalarReleaseRow(int* available, int* allocRow, int* needRow, const int* release, int stride) {
+    for (int j = 0; j < stride; ++j) {
+        available[j] += release[j];
+        allocRow[j] -= release[j];
+        needRow[j] += release[j];
+    }
+}
+
+void scalarSubRows(int* dst, const int* a, const int* b, long count) {
+    for (long k = 0; k < count; ++k)
+        dst[k] = a[k] - b[k];
+}
+
+#ifdef KERNELS_X86
+// SSE4.1: 4 ints per step. Strides are multiples of KERNEL_LANES, so they are multiples of 4 as well.
+__attribute__((target("sse4.1")))
+static bool sseRowFits(const int* row, const int* work, int stride) {
+    for (int j = 0; j < stride; j += 4) {
+        __m128i r = _mm_loadu_si128((const __m128i*)(row + j));
+        __m128i w = _mm_loadu_si128((const __m128i*)(work + j));
+        __m128i over = _mm_cmpgt_epi32(r, w);         // Lanes where row > work
+        if (!_mm_testz_si128(over, over)) return false;
+    }
+    return true;
+}
+
+__attribute__((target("sse4.1")))
+static void sseAddRow(int* work, const int* row, int stride) {
+    for (int j = 0; j < stride; j += 4) {
+        __m128i w = _mm_loadu_si128((const __m128i*)(work + j));
+        __m128i r = _mm_loadu_si128((const __m128i*)(row + j));
+        _mm_storeu_si128((__m128i*)(work + j), _mm_add_epi32(w, r));
+    }
+}
+
+__attribute__((target("sse4.1")))
+static void sseGrantRow(int* available, int* allocRow, int* needRow, const int* request, int stride) {
+    for (int j = 0; j < stride; j += 4) {
+        __m128i q = _mm_loadu_si128((const __m128i*)(request + j));
+        __m128i a = _mm_loadu_si128((const __m128i*)(available + j));
+        __m128i al = _mm_loadu_si128((const __m128i*)(allocRow + j));
+        __m128i n = _mm_loadu_si128((const __m128i*)(needRow + j));
+        _mm_storeu_si128((__m128i*)(available + j), _mm_sub_epi32(a, q));
+        _mm_storeu_si128((__m128i*)(allocRow + j), _mm_add_epi32(al, q));
+        _mm_storeu_si128((__m128i*)(needRow + j), _mm_sub_epi32(n, q));
+    }
+}
+
+__attribute__((target("sse4.1")))
+static void sseReleaseRow(int* available, int* allocRow, int* needRow, const int* release, int stride) {
+    for (int j = 0; j < stride; j += 4) {
+        __m128i q = _mm_loadu_si128((const __m128i*)(release + j));
+        __m128i a = _mm_loadu_si128((const __m128i*)(available + j));
+        __m128i al = _mm_loadu_si128((const __m128i*)(allocRow + j));
+        __m128i n = _mm_loadu_si128((const __m128i*)(needRow + j));
+        _mm_storeu_si128((__m128i*)(available + j), _mm_add_epi32(a, q));
+        _mm_storeu_si128((__m128i*)(allocRow + j), _mm_sub_epi32(al, q));
+        _mm_storeu_si128((__m128i*)(needRow + j), _mm_add_epi32(n, q));
+    }
+}
+
+__attribute__((target("sse4.1")))
+static void sseSubRows(int* dst, const int* a, const int* b, long count) {
+    long k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(a + k));
+        __m128i y = _mm_loadu_si128((const __m128i*)(b + k));
+        _mm_storeu_si128((__m128i*)(dst + k), _mm_sub_epi32(x, y));
+    }
+    for (; k < count; ++k) dst[k] = a[k] - b[k];
+}
+
+// AVX2: 8 ints per step, one step per KERNEL_LANES of padded row
+__attribute__((target("avx2")))
+static bool avxRowFits(const int* row, const int* work, int stride) {
+    for (int j = 0; j < stride; j += 8) {
+        __m256i r = _mm256_loadu_si256((const __m256i*)(row + j));
+        __m256i w = _mm256_loadu_si256((const __m256i*)(work + j));
+        if (_mm256_movemask_epi8(_mm256_cmpgt_epi32(r, w))) return false; // Any lane with row > work
+    }
+    return true;
+}
+
+__attribute__((target("avx2")))
+static void avxAddRow(int* work, const int* row, int stride) {
+    for (int j = 0; j < stride; j += 8) {
+        __m256i w = _mm256_loadu_si256((const __m256i*)(work + j));
+        __m256i r = _mm256_loadu_si256((const __m256i*)(row + j));
+        _mm256_storeu_si256((__m256i*)(work + j), _mm256_add_epi32(w, r));
+    }
+}
+
+__attribute__((target("avx2")))
+static void avxGrantRow(int* available, int* allocRow, int* needRow, const int* request, int stride) {
+    for (int j = 0; j < stride; j += 8) {
+        __m256i q = _mm256_loadu_si256((const __m256i*)(request + j));
+        __m256i a = _mm256_loadu_si256((const __m256i*)(available + j));
+        __m256i al = _mm256_loadu_si256((const __m256i*)(allocRow + j));
+        __m256i n = _mm256_loadu_si256((const __m256i*)(needRow + j));
+        _mm256_storeu_si256((__m256i*)(available + j), _mm256_sub_epi32(a, q));
+        _mm256_storeu_si256((__m256i*)(allocRow + j), _mm256_add_epi32(al, q));
+        _mm256_storeu_si256((__m256i*)(needRow + j), _mm256_sub_epi32(n, q));
+    }
+}
+
+__attribute__((target("avx2")))
+static void avxReleaseRow(int* available, int* allocRow, int* needRow, const int* release, int stride) {
+    for (int j = 0; j < stride; j += 8) {
+        __m256i q = _mm256_loadu_si256((const __m256i*)(release + j));
+        __m256i a = _mm256_loadu_si256((const __m256i*)(available + j));
+        __m256i al = _mm256_loadu_si256((const __m256i*)(allocRow + j));
+        __m256i n = _mm256_loadu_si256((const __m256i*)(needRow + j));
+        _mm256_storeu_si256((__m256i*)(available + j), _mm256_add_epi32(a, q));
+        _mm256_storeu_si256((__m256i*)(allocRow + j), _mm256_sub_epi32(al, q));
+        _mm256_storeu_si256((__m256i*)(needRow + j), _mm256_add_epi32(n, q));
+    }
+}
+
+__attribute__((target("avx2")))
+static void avxSubRows(int* dst, const int* a, const int* b, long count) {
+    long k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + k));
+        __m256i y = _mm256_loadu_si256((const __m256i*)(b + k));
+        _mm256_storeu_si256((__m256i*)(dst + k), _mm256_sub_epi32(x, y));
+    }
+    for (; k < count; ++k) dst[k] = a[k] - b[k];
+}
+#endif // KERNELS_X86
+
+// Dispatch table. Entries start at resolver stubs that run init() on first use and then forward to the chosen kernel.
+static bool resolveRowFits(const int* row, const int* work, int stride);
+static void resolveAddRow(int* work, const int* row, int stride);
+static void resolveGrantRow(int* available, int* allocRow, int* needRow, const int* request, int stride);
+static void resolveReleaseRow(int* available, int* allocRow, int* needRow, const int* release, int stride);
+static void resolveSubRows(int* dst, const int* a, const int* b, long count);
+
+static bool (*rowFitsFn)(const int*, const int*, int) = resolveRowFits;
+static void (*addRowFn)(int*, const int*, int) = resolveAddRow;
+static void (*grantRowFn)(int*, int*, int*, const int*, int) = resolveGrantRow;
+static void (*releaseRowFn)(int*, int*, int*, const int*, int) = resolveReleaseRow;
+static void (*subRowsFn)(int*, const int*, const int*, long) = resolveSubRows;
+static Isa currentIsa = ISA_SCALAR;
+
+static bool resolveRowFits(const int* row, const int* work, int stride) {
+    init();
+    return rowFitsFn(row, work, stride);
+}
+
+static void resolveAddRow(int* work, const int* row, int stride) {
+    init();
+    addRowFn(work, row, stride);
+}
+
+static void resolveGrantRow(int* available, int* allocRow, int* needRow, const int* request, int stride) {
+    init();
+    grantRowFn(available, allocRow, needRow, request, stride);
+}
+
+static void resolveReleaseRow(int* available, int* allocRow, int* needRow, const int* release, int stride) {
+    init();
+    releaseRowFn(available, allocRow, needRow, release, stride);
+}
+
+static void resolveSubRows(int* dst, const int* a, const int* b, long count) {
+    init();
+    subRowsFn(dst, a, b, count);
+}
+
+// Reports whether the running CPU can execute the given instruction set (CPUID via the compiler builtin)
+static bool cpuSupports(Isa isa) {
+#ifdef KERNELS_X86
+    __builtin_cpu_init();
+    if (isa == ISA_AVX2) return __builtin_cpu_supports("avx2");
+    if (isa == ISA_SSE41) return __builtin_cpu_supports("sse4.1");
+#endif
+    return isa == ISA_SCALAR;
+}
+
+/**
+ * @brief Selects the widest instruction set the CPU supports.
+ */
+void init() {
+    if (cpuSupports(ISA_AVX2)) select(ISA_AVX2);
+    else if (cpuSupports(ISA_SSE41)) select(ISA_SSE41);
+    else select(ISA_SCALAR);
+}
+
+/**
+ * @brief Points the dispatch table at one instruction set's kernels.
+ *
+ * Falls back to the scalar kernels if the CPU cannot run the requested set, so callers never fault on older hardware.
+ */
+void select(Isa isa) {
+    if (!cpuSupports(isa)) isa = ISA_SCALAR;
+    currentIsa = isa;
+
+    rowFitsFn = scalarRowFits;
+    addRowFn = scalarAddRow;
+    grantRowFn = scalarGrantRow;
+    releaseRowFn = scalarReleaseRow;
+    subRowsFn = scalarSubRows;
+#ifdef KERNELS_X86
+    if (isa == ISA_AVX2) {
+        rowFitsFn = avxRowFits;
+        addRowFn = avxAddRow;
+        grantRowFn = avxGrantRow;
+        releaseRowFn = avxReleaseRow;
+        subRowsFn = avxSubRows;
+    } else if (isa == ISA_SSE41) {
+        rowFitsFn = sseRowFits;
+        addRowFn = sseAddRow;
+        grantRowFn = sseGrantRow;
+        releaseRowFn = sseReleaseRow;
+        subRowsFn = sseSubRows;
+    }
+#endif
+}
+
+Isa activeIsa() {
+    return currentIsa;
+}
+
+const char* isaName(Isa isa) {
+    switch (isa) {
+        case ISA_AVX2: return "avx2";
+        case ISA_SSE41: return "sse4.1";
+        default: return "scalar";
+    }
+}
+
+bool rowFits(const int* row, const int* work, int stride) {
+    return rowFitsFn(row, work, stride);
+}
+
+void addRow(int* work, const int* row, int stride) {
+    addRowFn(work, row, stride);
+}
+
+void grantRow(int* available, int* allocRow, int* needRow, const int* request, int stride) {
+    grantRowFn(available, allocRow, needRow, request, stride);
+}
+
+void releaseRow(int* available, int* allocRow, int* needRow, const int* release, int stride) {
+    releaseRowFn(available, allocRow, needRow, release, stride);
+}
+
+void subRows(int* dst, const int* a, const int* b, long count) {
+    subRowsFn(dst, a, b, count);
+}
+
+} // namespace Kernels
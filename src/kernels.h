@@ -0,0 +1,53 @@
+// Calla Chen
+// Source Code File 12/13 for EECS 111 Project #3
+#ifndef KERNELS_H
+#define KERNELS_H
+
+// Vectorized row kernels for the Banker's hot loops.
+//
+// Every row passed in must be padded to a multiple of KERNEL_LANES ints with zeros in the padding (Banker's row stride
+// guarantees this), so the kernels never need a scalar tail loop. Loads are unaligned-safe; Banker rows are also
+// cache-line aligned, so they never split a line.
+#define KERNEL_LANES 8  // ints per AVX2 register
+
+namespace Kernels {
+    enum Isa {
+        ISA_SCALAR = 0,     // Portable C++ loops
+        ISA_SSE41 = 1,      // 4 x int32 per compare/add
+        ISA_AVX2 = 2        // 8 x int32 per compare/add
+    };
+
+    // Picks the widest instruction set the CPU supports (CPUID); called once automatically on first use
+    void init();
+
+    // Forces a specific instruction set (falls back to scalar if the CPU lacks it); used by benchmarks
+    void select(Isa isa);
+
+    // Instruction set currently in use and its display name
+    Isa activeIsa();
+    const char* isaName(Isa isa);
+
+    // true if row[k] <= work[k] for every k < stride (Need[i] <= Work)
+    bool rowFits(const int* row, const int* work, int stride);
+
+    // work[k] += row[k] (Work += Allocation[i])
+    void addRow(int* work, const int* row, int stride);
+
+    // available -= request, allocation += request, need -= request
+    void grantRow(int* available, int* allocRow, int* needRow, const int* request, int stride);
+
+    // available += release, allocation -= release, need += release
+    void releaseRow(int* available, int* allocRow, int* needRow, const int* release, int stride);
+
+    // dst[k] = a[k] - b[k] for 'count' ints (need = maximum - allocation over whole matrices)
+    void subRows(int* dst, const int* a, const int* b, long count);
+
+    // Scalar reference versions, always available (used for fallback and benchmarking)
+    bool scalarRowFits(const int* row, const int* work, int stride);
+    void scalarAddRow(int* work, const int* row, int stride);
+    void scalarGrantRow(int* available, int* allocRow, int* needRow, const int* request, int stride);
+    void scalarReleaseRow(int* available, int* allocRow, int* needRow, const int* release, int stride);
+    void scalarSubRows(int* dst, const int* a, const int* b, long count);
+}
+
+#endif //KERNELS_H
@@ -1,6 +1,7 @@
 // Calla Chen
 // Source Code File 5/11 for EECS 111 Project #3
 #include "log_global.h"
+#include "customer_log.h"
 #include <iostream>
 #include <vector>
 #include <string>
@@ -21,30 +22,39 @@ SessionStats globalStats;     // Track stats for final summary
 
 vector<string> commandHistory;
 
-ofstream customerLogs[10];
-int customerArrivalTimes[10] = { -1 };
-int customerRetryCounts[10] = { 0 };
-int customerWaitTimes[10] = { -1 };
-int customerTurnaround[10] = { -1 };
+vector<int> customerArrivalTimes;
+vector<int> customerRetryCounts;
+vector<int> customerWaitTimes;
+vector<int> customerTurnaround;
 
 // Constructor to initialize all counts to 0
 SessionStats::SessionStats()
     : totalRequests(0), totalReleases(0), totalDenied(0),
       safeRequests(0), unsafeRequests(0),
-      deniedNeed(0), deniedAvailability(0), deniedUnsafe(0),
-      countRQ(0), countRL(0), countStar(0), countSafety(0),
+      deniedNeed(0), deniedAvailability(0), deniedUnsafe(0), invalidRequests(0),
+      fastPathHits(0), orderReplayHits(0), fastPathMisses(0),
+      batchRequests(0), batchSafetyChecks(0),
+      countRQ(0), countRQB(0), countRL(0), countStar(0), countSafety(0), countEngine(0), countLog(0), countBinlog(0), countCustlog(0), countJournal(0),
       countReset(0), countReport(0), countExplain(0),
-      countUndo(0), countHelp(0), countSummary(0), countVerbose(0),
-      countColor(0), countSnapshot(0), countSavepoint(0),
+      countUndo(0), countRedo(0), countHelp(0), countSummary(0), countVerbose(0),
+      countColor(0), countSnapshot(0), countSavepoint(0), countSavepoints(0),
       countRollback(0), countLoad(0), countSave(0),
       countHistory(0), countExit(0), countUnknown(0), countDeadlock(0),
       countHeatmap(0), countPreview(0), countSafePreview(0), countUnsafePreview(0),
-	  countDeniedPreview(0), countRecap(0), countCompare(0), countDiff(0)
+	  countDeniedPreview(0), countPreviewFile(0), previewFileCandidates(0), countRecap(0), countCompare(0), countDiff(0),
+	  countReplay(0)
 {
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
-        requestCount[i] = 0;
-        releaseCount[i] = 0;
-    }
+}
+
+// Sizes every per-customer counter once the number of customers is known
+void initCustomerStats(int numCustomers) {
+    globalStats.requestCount.assign(numCustomers, 0);
+    globalStats.releaseCount.assign(numCustomers, 0);
+
+    customerArrivalTimes.assign(numCustomers, -1);
+    customerRetryCounts.assign(numCustomers, 0);
+    customerWaitTimes.assign(numCustomers, -1);
+    customerTurnaround.assign(numCustomers, -1);
 }
 
 string currentTimestamp() {
@@ -56,7 +66,7 @@ string currentTimestamp() {
     return oss.str();
 }
 
-void initCustomerLogs() {
+void initCustomerLogs(int numCustomers) {
     // Ensure logs/ directory exists
     if (access("logs", F_OK) == -1) {
         int status = mkdir("logs", 0755);
@@ -67,28 +77,33 @@ void initCustomerLogs() {
         }
     }
 
-    // Open customer log files (only for defined NUMBER_OF_CUSTOMERS)
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
-        ostringstream filename;
-        filename << "logs/customer_P" << i << ".txt";
-        customerLogs[i].open(filename.str().c_str());
-    }
+    // One segment file for every customer's history (read back with custlog)
+    if (!CustomerLog::open(numCustomers))
+        cerr << "[WARN] Could not create logs/customers.seg; per-customer history is disabled" << endl;
 }
 
 const string helpText =
     "\nCommands:\n"
     "  RQ <cust> r0 r1 r2 r3   		- Request resources\n"
+    "  RQB <cust> r0 r1 ... ; ...	- Request a batch (one safety check when it fits)\n"
     "  RL <cust> r0 r1 r2 r3   		- Release resources\n"
     "  *                       		- Print all matrices\n"
     "  safety                  		- Toggle safe sequence display\n"
+    "  engine [classic/indexed/parallel/verify] - Select the safety check engine\n"
+    "  log [sync/async [ms]/stats]  - Synchronous or batched background event logging\n"
+    "  binlog [on [path]/off/stats] - Compact binary event log (zotbank-logdump decodes it)\n"
+    "  custlog [<cust> [N]]         - Show one customer's RQ/RL history\n"
+    "  journal [stats/sync]         - Write-ahead journal status (--journal=<policy>)\n"
     "  snapshot                		- Save a manual undo snapshot\n"
-    "  undo                    		- Revert to last snapshot\n"
+    "  undo [N | stats | budget <KB>] - Revert N operations, or to the last snapshot\n"
+    "  redo [N]                     - Re-apply undone operations\n"
     "  report                  		- Show current usage\n"
     "  explain                 		- Show last denial reason\n"
     "  summary                 		- Command usage breakdown\n"
     "  test <file>             		- Run commands from a file\n"
-    "  save                    		- Save current system state\n"
-    "  load                    		- Load previously saved state\n"
+    "  replay <file>                - Replay a long script or trace quietly, then report commands/s and latency\n"
+    "  save [bin [file]]       		- Save current system state (text, or binary checkpoint)\n"
+    "  load [bin [file]]       		- Load previously saved state (text, or binary checkpoint)\n"
     "  history                 		- View past commands\n"
 	"  recap 						- Show the last 5 meaningful commands\n"
     "  !N                      		- Replay a previous command\n"
@@ -96,9 +111,11 @@ const string helpText =
     "  color [on/off]          		- Toggle ANSI color output\n"
     "  savepoint <name>        		- Create named system snapshot\n"
     "  rollback <name>         		- Restore system to a savepoint\n"
+    "  savepoints                   - List savepoints and the memory each one holds\n"
     "  heatmap                 		- Log current RQ/RL heatmap\n"
     "  help [cmd]              		- Show help for a command or all\n"
 	"  preview <cust> r0 r1 r2 r3   - Show save sequence if request is made (but do NOT apply)\n"
+    "  preview-file <file> [csv]    - Preview every request in a file in parallel, verdicts to CSV\n"
     "  compare <name>               - Compare current system with a savepoint\n"
 	"  diff <savepoint name> 		- View differences from savepoint\n"
     "  exit                    		- Quit the session\n";
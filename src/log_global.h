@@ -24,22 +24,40 @@ struct SessionStats {
     int deniedNeed;
     int deniedAvailability;
     int deniedUnsafe;
+    int invalidRequests;    // Malformed or out-of-range RQ/RQB entries, never decided
+
+    // Safety check fast paths (RQ only)
+    int fastPathHits;       // Granted by the O(m) "requester can finish first" condition
+    int orderReplayHits;    // Granted by re-verifying the cached safe order
+    int fastPathMisses;     // Needed the full safety check
+
+    // Batch requests (RQB)
+    int batchRequests;      // Requests decided inside batches
+    int batchSafetyChecks;  // Safety checks those batches needed
 
     // Per-command usage counters
     int countRQ;
+    int countRQB;
     int countRL;
     int countStar;
     int countSafety;
+    int countEngine;
+    int countLog;
+    int countBinlog;
+    int countCustlog;
+    int countJournal;
     int countReset;
     int countReport;
     int countExplain;
     int countUndo;
+    int countRedo;
     int countHelp;
     int countSummary;
     int countVerbose;
     int countColor;
     int countSnapshot;
     int countSavepoint;
+    int countSavepoints;
     int countRollback;
     int countLoad;
     int countSave;
@@ -52,12 +70,15 @@ struct SessionStats {
 	int countSafePreview;
 	int countUnsafePreview;
 	int countDeniedPreview;
+	int countPreviewFile;
+	int previewFileCandidates;  // Candidates evaluated by those preview-file runs
 	int countRecap;
 	int countCompare;
 	int countDiff;
+	int countReplay;
 
-    int requestCount[NUMBER_OF_CUSTOMERS];
-    int releaseCount[NUMBER_OF_CUSTOMERS];
+    std::vector<int> requestCount;   // Sized by initCustomerStats() once the customer count is known
+    std::vector<int> releaseCount;
 
     std::map<std::string, int> commandUsage;
 
@@ -70,14 +91,12 @@ extern SessionStats globalStats;
 // Command history
 extern std::vector<std::string> commandHistory;
 
-// Per customer logs - supporting up to 10 customers
-extern std::ofstream customerLogs[10];
-
 // Current Time Stamp
 std::string currentTimestamp();
 
-// Declare the init function
-void initCustomerLogs();
+// Declare the init functions
+void initCustomerLogs(int numCustomers);
+void initCustomerStats(int numCustomers);
 
 // Help text for commands to put in the terminal
 extern const std::string helpText;
@@ -100,11 +119,11 @@ inline std::string colorWrap(const std::string& code) {
 #define COLOR_MAGENTA  colorWrap("\033[1;95m")
 #define COLOR_BLUE     colorWrap("\033[0;34m")
 
-// Per-customer session stats (indexed by customer ID)
-extern int customerArrivalTimes[10];
-extern int customerRetryCounts[10];
-extern int customerWaitTimes[10];
-extern int customerTurnaround[10];
+// Per-customer session stats (indexed by customer ID, sized by initCustomerStats())
+extern std::vector<int> customerArrivalTimes;
+extern std::vector<int> customerRetryCounts;
+extern std::vector<int> customerWaitTimes;
+extern std::vector<int> customerTurnaround;
 
 // Snapshot of last savepoint (used for undo)
 extern std::vector<std::vector<int> > snapshotAllocation;
@@ -10,11 +10,20 @@
 #include <map>
 #include <algorithm>
 #include <vector>
+#include <cstdio>
+#include <cstring>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <errno.h>
+#include <sys/time.h>
 
 using namespace std;
 
+#define LOGGER_WRITE_BATCH 65536        // Bytes the writer thread collects before one write()
+
 // Comparator for sorting command usage by count (descending)
 struct CommandUsageComparator {
     bool operator()(const std::pair<std::string, int>& a,
@@ -25,6 +34,232 @@ struct CommandUsageComparator {
 
 // Define the static member variable
 ofstream Logger::logFile;
+string Logger::logPath;
+
+// One cell of the asynchronous ring; 'sequence' says whether it is free for position p (== p) or holds position p
+// (== p + 1), as in Sequencer. An event with more than LOGGER_RECORD_VALUES amounts takes the following cells too,
+// which carry only the rest of its values.
+struct LogRecord {
+    unsigned long sequence;
+    long long stamp;                        // CLOCK_MONOTONIC nanoseconds
+    int level;
+    int kind;                               // A Logger::Event, or -1 for text
+    int customer;
+    int count;
+    const char* outcome;                    // String literal
+    int values[LOGGER_RECORD_VALUES];
+    char text[LOGGER_RECORD_TEXT];
+};
+
+// State of the asynchronous mode; exists only between startAsync() and stopAsync()
+struct AsyncLog {
+    vector<LogRecord> ring;
+    unsigned long mask;                     // Capacity - 1
+    unsigned long tail;                     // Next position to claim (producers, CAS)
+    unsigned long head;                     // Next position to write (writer thread; producers read it as a hint)
+    unsigned long queued, dropped;          // Producer counters (atomic)
+    unsigned long written, batches, bytes;  // Writer counters (atomic stores, read by asyncStats())
+    int flushIntervalMs;
+    int fd;                                 // Log file, opened for appending
+    time_t wallBase;                        // Wall clock and monotonic clock at startAsync(), for timestamps
+    long long monoBase;
+    pthread_t writer;
+    int stopping;
+    pthread_mutex_t wakeMutex;
+    pthread_cond_t wakeCond;
+};
+
+static AsyncLog* asyncLog = NULL;
+
+static long long monotonicNanos() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static const char* levelPrefix(int level) {
+    switch (level) {
+        case Logger::WARN:  return "[WARN] ";
+        case Logger::ERROR: return "[ERROR] ";
+        default:            return "[INFO] ";
+    }
+}
+
+// Ring cells an event with 'count' amounts takes
+static unsigned long eventCells(int count) {
+    return count <= LOGGER_RECORD_VALUES ? 1 : (unsigned long)(count + LOGGER_RECORD_VALUES - 1) / LOGGER_RECORD_VALUES;
+}
+
+// "RQ 0 1 1 1 1 → GRANTED"
+static void formatEvent(string& out, int kind, int customer, const int* values, int count, const char* outcome) {
+    char num[16];
+    out += (kind == Logger::EVENT_RELEASE) ? "RL" : "RQ";
+    snprintf(num, sizeof(num), " %d", customer);
+    out += num;
+    for (int j = 0; j < count; ++j) {
+        snprintf(num, sizeof(num), " %d", values[j]);
+        out += num;
+    }
+    out += " → ";
+    out += outcome;
+}
+
+/**
+ * @brief Claims the ring cells for one record and fills them; never blocks.
+ *
+ * Multi-producer, lock-free: a CAS on the tail claims the next positions, the cells are filled, and publishing the
+ * first cell's sequence hands the record to the writer. The writer frees cells in order, so the last cell being free
+ * means all of them are. A full ring drops the record and counts it. The writer is only woken early when the ring is
+ * half full; otherwise it picks records up on its next flush interval.
+ */
+static void pushRecord(int level, int kind, int customer, const int* values, int count, const char* outcome,
+                       const char* text, size_t length) {
+    AsyncLog* a = asyncLog;
+    unsigned long cells = text ? 1 : eventCells(count);
+    if (cells > a->mask + 1) {
+        __atomic_add_fetch(&a->dropped, 1, __ATOMIC_RELAXED); // Could never fit
+        return;
+    }
+    unsigned long pos = __atomic_load_n(&a->tail, __ATOMIC_RELAXED);
+    LogRecord* slot;
+    for (;;) {
+        slot = &a->ring[pos & a->mask];
+        LogRecord* last = &a->ring[(pos + cells - 1) & a->mask];
+        unsigned long seq = __atomic_load_n(&last->sequence, __ATOMIC_ACQUIRE);
+        long diff = (long)(seq - (pos + cells - 1));
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&a->tail, &pos, pos + cells, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        } else if (diff < 0) {
+            __atomic_add_fetch(&a->dropped, 1, __ATOMIC_RELAXED); // Full: the writer has not caught up
+            return;
+        } else {
+            pos = __atomic_load_n(&a->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->stamp = monotonicNanos();
+    slot->level = level;
+    slot->kind = kind;
+    slot->customer = customer;
+    slot->count = count;
+    slot->outcome = outcome;
+    for (int j = 0; j < count && j < LOGGER_RECORD_VALUES; ++j) slot->values[j] = values[j];
+    for (unsigned long c = 1; c < cells; ++c) {
+        LogRecord* more = &a->ring[(pos + c) & a->mask];
+        int from = (int)c * LOGGER_RECORD_VALUES;
+        for (int j = from; j < count && j < from + LOGGER_RECORD_VALUES; ++j) more->values[j - from] = values[j];
+        __atomic_store_n(&more->sequence, pos + c + 1, __ATOMIC_RELAXED); // Published with the first cell below
+    }
+    if (text) {
+        if (length >= LOGGER_RECORD_TEXT) length = LOGGER_RECORD_TEXT - 1;
+        memcpy(slot->text, text, length);
+        slot->text[length] = '\0';
+    }
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&a->queued, 1, __ATOMIC_RELAXED);
+
+    unsigned long half = (a->mask + 1) / 2, ahead = pos - __atomic_load_n(&a->head, __ATOMIC_RELAXED);
+    if (ahead <= half && ahead + cells > half)
+        pthread_cond_signal(&a->wakeCond);
+}
+
+// Hands the collected bytes to the kernel in one write() (more if it writes partially)
+static void writeBatch(AsyncLog* a, string& out) {
+    size_t done = 0;
+    while (done < out.size()) {
+        ssize_t n = write(a->fd, out.data() + done, out.size() - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break; // Nothing sensible to report to; the records are lost
+        }
+        done += (size_t)n;
+    }
+    __atomic_add_fetch(&a->batches, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&a->bytes, (unsigned long)done, __ATOMIC_RELAXED);
+    out.clear();
+}
+
+// Formats every published record, writing whenever LOGGER_WRITE_BATCH bytes have collected. 'values' gathers the
+// amounts of events that span several cells.
+static void drainRing(AsyncLog* a, string& out, time_t& cachedSecond, char* cachedTime, vector<int>& values) {
+    for (;;) {
+        LogRecord& slot = a->ring[a->head & a->mask];
+        if (__atomic_load_n(&slot.sequence, __ATOMIC_ACQUIRE) != a->head + 1) return;
+        unsigned long cells = slot.kind < 0 ? 1 : eventCells(slot.count);
+
+        // Same "[HH:MM:SS] [LEVEL] message" layout as the synchronous path; localtime only once per second
+        time_t wall = a->wallBase + (time_t)((slot.stamp - a->monoBase) / 1000000000LL);
+        if (wall != cachedSecond) {
+            tm parts;
+            localtime_r(&wall, &parts);
+            strftime(cachedTime, 9, "%H:%M:%S", &parts);
+            cachedSecond = wall;
+        }
+        out += "[";
+        out += cachedTime;
+        out += "] ";
+        out += levelPrefix(slot.level);
+        if (slot.kind < 0) out += slot.text;
+        else if (cells == 1) formatEvent(out, slot.kind, slot.customer, slot.values, slot.count, slot.outcome);
+        else {
+            values.resize(cells * LOGGER_RECORD_VALUES);
+            for (unsigned long c = 0; c < cells; ++c)
+                memcpy(&values[c * LOGGER_RECORD_VALUES], a->ring[(a->head + c) & a->mask].values,
+                       sizeof(slot.values));
+            formatEvent(out, slot.kind, slot.customer, &values[0], slot.count, slot.outcome);
+        }
+        out += "\n";
+
+        for (unsigned long c = 0; c < cells; ++c)
+            __atomic_store_n(&a->ring[(a->head + c) & a->mask].sequence, a->head + c + a->mask + 1, __ATOMIC_RELEASE);
+        __atomic_store_n(&a->head, a->head + cells, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&a->written, 1, __ATOMIC_RELAXED);
+        if (out.size() >= LOGGER_WRITE_BATCH) writeBatch(a, out);
+    }
+}
+
+/**
+ * @brief Background writer: every flush interval (or sooner when the ring fills up) formats everything queued and
+ * writes it out in large batches. Exits once stopAsync() asks and the ring is empty.
+ */
+static void* writerMain(void* arg) {
+    AsyncLog* a = static_cast<AsyncLog*>(arg);
+    string out;
+    out.reserve(LOGGER_WRITE_BATCH + 256);
+    vector<int> values;
+    time_t cachedSecond = (time_t)-1;
+    char cachedTime[9] = "";
+    unsigned long reportedDrops = 0;
+
+    for (;;) {
+        // Read before draining, so everything queued before stopAsync() is written on the last pass
+        bool stop = __atomic_load_n(&a->stopping, __ATOMIC_ACQUIRE) != 0;
+        drainRing(a, out, cachedSecond, cachedTime, values);
+
+        unsigned long drops = __atomic_load_n(&a->dropped, __ATOMIC_RELAXED);
+        if (drops != reportedDrops) {
+            char line[96];
+            snprintf(line, sizeof(line), "[%s] [WARN] LOGGER → %lu records dropped (ring full)\n", cachedTime,
+                     drops - reportedDrops);
+            out += line;
+            reportedDrops = drops;
+        }
+        if (!out.empty()) writeBatch(a, out);
+        if (stop) return NULL;
+
+        timeval now;
+        gettimeofday(&now, NULL);
+        long long until = (now.tv_sec * 1000000LL + now.tv_usec) + a->flushIntervalMs * 1000LL;
+        timespec deadline;
+        deadline.tv_sec = (time_t)(until / 1000000);
+        deadline.tv_nsec = (long)(until % 1000000) * 1000;
+        pthread_mutex_lock(&a->wakeMutex);
+        if (!__atomic_load_n(&a->stopping, __ATOMIC_ACQUIRE))
+            pthread_cond_timedwait(&a->wakeCond, &a->wakeMutex, &deadline);
+        pthread_mutex_unlock(&a->wakeMutex);
+    }
+}
 
 /**
 * @brief Initializes the logging system.
@@ -39,6 +274,7 @@ void Logger::init(const string& filePath) {
     mkdir("logs", 0777);
 
     // Open the specified log file for writing
+    logPath = filePath;
     logFile.open(filePath.c_str(), ios::out);
     if (logFile.is_open()) {
         // Write a timestamp marking the start of the log
@@ -59,6 +295,10 @@ void Logger::init(const string& filePath) {
 */
 void Logger::log(const string& message, Level level) {
     if (!logFile.is_open()) return; // Skip if log file isn't open
+    if (asyncLog) {
+        pushRecord(level, -1, -1, NULL, 0, NULL, message.data(), message.size());
+        return;
+    }
 
     // Get current time
     time_t now = time(NULL);
@@ -91,6 +331,119 @@ void Logger::log(const string& message, Level level) {
     cout << color << prefix << message << COLOR_RESET << endl;
 }
 
+/**
+* @brief Logs one RQ/RL outcome.
+*
+* In asynchronous mode the customer and amounts are copied into a ring record as plain integers (over as many cells
+* as the amounts need) and formatted by the writer thread; otherwise the line is formatted here and goes through log().
+*
+* @param id EVENT_REQUEST or EVENT_RELEASE.
+* @param customer The customer number.
+* @param values The requested or released amounts.
+* @param count Number of amounts.
+* @param outcome A string literal such as "GRANTED".
+* @param level The severity level.
+*/
+void Logger::event(Event id, int customer, const int* values, int count, const char* outcome, Level level) {
+    if (!logFile.is_open()) return;
+    if (asyncLog) {
+        pushRecord(level, id, customer, values, count, outcome, NULL, 0);
+        return;
+    }
+    string message;
+    formatEvent(message, id, customer, values, count, outcome);
+    log(message, level);
+}
+
+/**
+* @brief Switches to asynchronous logging.
+*
+* Flushes the log file, opens it again for appending with a raw descriptor for the writer thread, and starts that
+* thread. Does nothing if already asynchronous or no log file is open.
+*
+* @param flushIntervalMs How long the writer sleeps between flushes, in milliseconds (at least 1).
+* @param capacity Ring size in records, rounded up to a power of two.
+* @return true if asynchronous logging is running.
+*/
+bool Logger::startAsync(int flushIntervalMs, int capacity) {
+    if (asyncLog) return true;
+    if (!logFile.is_open()) return false;
+    logFile.flush();
+    int fd = open(logPath.c_str(), O_WRONLY | O_APPEND);
+    if (fd < 0) return false;
+
+    AsyncLog* a = new AsyncLog();
+    int size = 2;
+    while (size < capacity) size <<= 1;
+    a->ring.resize(size);
+    for (int i = 0; i < size; ++i) a->ring[i].sequence = (unsigned long)i;
+    a->mask = (unsigned long)size - 1;
+    a->tail = a->head = 0;
+    a->queued = a->dropped = a->written = a->batches = a->bytes = 0;
+    a->flushIntervalMs = flushIntervalMs < 1 ? 1 : flushIntervalMs;
+    a->fd = fd;
+    a->wallBase = time(NULL);
+    a->monoBase = monotonicNanos();
+    a->stopping = 0;
+    pthread_mutex_init(&a->wakeMutex, NULL);
+    pthread_cond_init(&a->wakeCond, NULL);
+    if (pthread_create(&a->writer, NULL, writerMain, a) != 0) {
+        ::close(fd);
+        delete a;
+        return false;
+    }
+    asyncLog = a;
+    return true;
+}
+
+/**
+* @brief Returns to synchronous logging once every queued record is written.
+*
+* Callers must make sure no other thread is still logging.
+*
+* @return The final counters of the asynchronous session (all zero if it was not running).
+*/
+Logger::AsyncStats Logger::stopAsync() {
+    AsyncLog* a = asyncLog;
+    if (!a) return asyncStats();
+    pthread_mutex_lock(&a->wakeMutex);
+    __atomic_store_n(&a->stopping, 1, __ATOMIC_RELEASE);
+    pthread_cond_signal(&a->wakeCond);
+    pthread_mutex_unlock(&a->wakeMutex);
+    pthread_join(a->writer, NULL);
+    AsyncStats final = asyncStats();
+    asyncLog = NULL;
+
+    ::close(a->fd);
+    pthread_mutex_destroy(&a->wakeMutex);
+    pthread_cond_destroy(&a->wakeCond);
+    delete a;
+
+    // The writer appended behind logFile's back: continue at the real end of the file
+    logFile.close();
+    logFile.open(logPath.c_str(), ios::out | ios::app);
+    return final;
+}
+
+bool Logger::isAsync() {
+    return asyncLog != NULL;
+}
+
+Logger::AsyncStats Logger::asyncStats() {
+    AsyncStats s;
+    memset(&s, 0, sizeof(s));
+    AsyncLog* a = asyncLog;
+    if (!a) return s;
+    s.queued = __atomic_load_n(&a->queued, __ATOMIC_RELAXED);
+    s.written = __atomic_load_n(&a->written, __ATOMIC_RELAXED);
+    s.dropped = __atomic_load_n(&a->dropped, __ATOMIC_RELAXED);
+    s.batches = __atomic_load_n(&a->batches, __ATOMIC_RELAXED);
+    s.bytes = __atomic_load_n(&a->bytes, __ATOMIC_RELAXED);
+    s.capacity = (int)(a->mask + 1);
+    s.flushIntervalMs = a->flushIntervalMs;
+    return s;
+}
+
 /**
 * @brief Finalizes the logging session.
 *
@@ -98,6 +451,7 @@ void Logger::log(const string& message, Level level) {
 * properly terminate logging.
 */
 void Logger::close() {
+    stopAsync();
     if (logFile.is_open()) {
         // Write a timestamp marking the end of the log
         time_t now = time(NULL);
@@ -179,7 +533,11 @@ void Logger::logSessionTXT(const SessionStats& stats, const std::string& path) {
     file << "Unsafe Requests: " << stats.unsafeRequests << "\n";
     file << "  > Exceeds Need: " << stats.deniedNeed << "\n";
     file << "  > Exceeds Avail: " << stats.deniedAvailability << "\n";
-    file << "  > Unsafe State: " << stats.deniedUnsafe << "\n\n";
+    file << "  > Unsafe State: " << stats.deniedUnsafe << "\n";
+    file << "Invalid Requests: " << stats.invalidRequests << "\n";
+    file << "Fast Path Hits: " << stats.fastPathHits << "\n";
+    file << "Cached Order Hits: " << stats.orderReplayHits << "\n";
+    file << "Fast Path Misses: " << stats.fastPathMisses << "\n\n";
 
     // Convert map to vector
     std::vector<std::pair<std::string, int> > sortedUsage;
@@ -204,7 +562,7 @@ void Logger::logRequestHeatmap() {
     if (!heatmap.is_open()) return;
 
     heatmap << "CustomerID,RQ_Count,RL_Count\n";
-    for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
+    for (size_t i = 0; i < globalStats.requestCount.size(); ++i) {
         heatmap << "P" << i << "," << globalStats.requestCount[i]
                 << "," << globalStats.releaseCount[i] << "\n";
     }
@@ -214,7 +572,7 @@ void Logger::logRequestHeatmap() {
 
     if (verboseMode) {
         cout << COLOR_CYAN << "[HEATMAP] Request/Release counts:\n";
-        for (int i = 0; i < NUMBER_OF_CUSTOMERS; ++i) {
+        for (size_t i = 0; i < globalStats.requestCount.size(); ++i) {
             cout << "  P" << i << " → RQ: " << globalStats.requestCount[i]
                  << ", RL: " << globalStats.releaseCount[i] << "\n";
         }
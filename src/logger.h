@@ -9,16 +9,46 @@
 
 extern std::ofstream fullLog;
 
+#define LOGGER_RING_CAPACITY 8192       // Records the asynchronous ring holds (power of two)
+#define LOGGER_FLUSH_INTERVAL_MS 100    // Default time between asynchronous writer flushes
+#define LOGGER_RECORD_VALUES 8          // Integer fields per ring cell; longer events continue in the next cells
+#define LOGGER_RECORD_TEXT 120          // Bytes of free-form text per record (longer messages are truncated)
+
 class Logger {
 public:
     enum Level { INFO, WARN, ERROR };
 
+    // Hot-path events, written as "<RQ/RL> <customer> v0 v1 ... → <outcome>"
+    enum Event { EVENT_REQUEST, EVENT_RELEASE };
+
+    // Counters for the asynchronous mode since the last startAsync()
+    struct AsyncStats {
+        unsigned long queued;           // Records pushed into the ring
+        unsigned long written;          // Records formatted and written by the writer thread
+        unsigned long dropped;          // Records lost because the ring was full
+        unsigned long batches;          // write() calls
+        unsigned long bytes;            // Bytes written
+        int capacity;
+        int flushIntervalMs;
+    };
+
     // Initializes logger and opens log file for writing
     static void init(const std::string& filePath = "logs/events.log");
 
     // Logs a message to the file with a specified level
     static void log(const std::string& message, Level level = INFO);
 
+    // Logs a hot-path event; 'outcome' must be a string literal. Formats nothing on the caller in asynchronous mode.
+    static void event(Event id, int customer, const int* values, int count, const char* outcome, Level level = INFO);
+
+    // Asynchronous mode: log() and event() push fixed-size records into a lock-free ring and a background thread
+    // formats them and writes them to the log file in batches. Console echo is skipped while it is on. Records that
+    // find the ring full are dropped and counted.
+    static bool startAsync(int flushIntervalMs = LOGGER_FLUSH_INTERVAL_MS, int capacity = LOGGER_RING_CAPACITY);
+    static AsyncStats stopAsync();      // Writes everything queued, joins the writer thread; returns final counters
+    static bool isAsync();
+    static AsyncStats asyncStats();
+
     // Creating initializer for full_session.txt
     static void initFullSessionLog();
 
@@ -35,6 +65,7 @@ public:
 
 private:
     static std::ofstream logFile; // File stream for logging messages
+    static std::string logPath;   // Path logFile was opened with (the asynchronous writer appends to it)
 };
 
 #endif // LOGGER_H
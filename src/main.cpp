@@ -5,11 +5,16 @@
 #include <cstdlib>
 #include <string>
 #include <fstream>
+#include <vector>
 
 #include "banker.h"
 #include "command_handler.h"
 #include "logger.h"
+#include "binary_log.h"
+#include "customer_log.h"
+#include "journal.h"
 #include "log_global.h"
+#include "replay.h"
 
 using namespace std;
 
@@ -43,18 +48,51 @@ int main(int argc, char* argv[]) {
     fullLog << "=================================\n";
     fullLog << "Type 'help' for command syntax.\n\n";
 
-    if (
-     argc != NUMBER_OF_RESOURCES + 2 &&
-     !(argc == NUMBER_OF_RESOURCES + 3 && string(argv[NUMBER_OF_RESOURCES + 2]) == "test") &&
-     !(argc == NUMBER_OF_RESOURCES + 4 && string(argv[NUMBER_OF_RESOURCES + 2]) == "test")
-     ) {
-        cout << "Usage: " << argv[0] << " <inputfile> r0 r1 r2 r3 [test <testfile>]\n";
+    // Options (--journal=<policy>) may appear anywhere; the rest are positional
+    bool journaling = false;
+    Journal::Options journalOptions;
+    vector<char*> positional;
+    for (int a = 0; a < argc; ++a) {
+        string arg = argv[a];
+        if (a > 0 && arg.compare(0, 10, "--journal=") == 0) {
+            if (!Journal::parsePolicy(arg.substr(10), journalOptions)) {
+                cout << "[ERROR] Unknown journal policy: " << arg.substr(10) << " (use always, ms:N, ops:N or none)\n";
+                return 1;
+            }
+            journaling = true;
+        } else {
+            positional.push_back(argv[a]);
+        }
+    }
+    argc = (int)positional.size();
+    argv = &positional[0];
+
+    // Resource counts run from argv[2] up to the optional "test" or "replay" keyword
+    int testArg = argc;
+    for (int a = 2; a < argc; ++a) {
+        if (string(argv[a]) == "test" || string(argv[a]) == "replay") {
+            testArg = a;
+            break;
+        }
+    }
+    int numResources = testArg - 2;
+
+    if (argc < 3 || numResources < 1 || argc > testArg + 2) {
+        cout << "Usage: " << argv[0] << " <inputfile> r0 r1 ... rN [test|replay <file>] [--journal=always|ms:N|ops:N|none]\n";
+        return 1;
+    }
+
+    int numCustomers = Banker::countDemandRows(argv[1]);
+    if (numCustomers <= 0) {
+        cout << "Failed to load input file.\n";
+        fullLog << "Failed to load input file.\n";
         return 1;
     }
 
     Logger::init();
-    initCustomerLogs();
-    Banker banker;
+    initCustomerLogs(numCustomers);
+    initCustomerStats(numCustomers);
+    Banker banker(numCustomers, numResources);
     loadHistory();
 
     if (!banker.loadMaximumFromFile(argv[1])) {
@@ -63,13 +101,56 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    int availableResources[NUMBER_OF_RESOURCES];
-    for (int j = 0; j < NUMBER_OF_RESOURCES; ++j)
+    vector<int> availableResources(numResources);
+    for (int j = 0; j < numResources; ++j)
         availableResources[j] = atoi(argv[j + 2]);
-    banker.setAvailable(availableResources);
+    banker.setAvailable(&availableResources[0]);
+
+    // Bring the state up to date from the write-ahead journal, then keep appending to it
+    if (journaling) {
+        Journal::Recovery r = Journal::recover(banker);
+        stringstream msg;
+        if (r.checkpointNewer)
+            msg << "[RECOVERY] State loaded from " JOURNAL_CHECKPOINT_PATH " (newer than the journal)\n";
+        else if (r.found && (r.error.empty() || r.records > 0))
+            msg << "[RECOVERY] Replayed " << r.records << " journal record" << (r.records == 1 ? "" : "s") << " ("
+                << r.requests << " RQ, " << r.releases << " RL, " << r.states << " state) on top of "
+                << (r.fromCheckpoint ? JOURNAL_CHECKPOINT_PATH : "the initial state") << "\n";
+        if (!r.error.empty())
+            msg << "[WARN] Journal: " << r.error << "\n";
+        if (r.tornBytes)
+            msg << "[WARN] Journal: dropped " << r.tornBytes << " bytes after the last intact record\n";
+        cout << msg.str();
+        fullLog << msg.str();
+        if (!Journal::open(banker, journalOptions)) {
+            cout << "[ERROR] Cannot open " JOURNAL_PATH "\n";
+            return 1;
+        }
+        cout << "[INFO] Journal: " JOURNAL_PATH " (" << Journal::describe(journalOptions) << ")\n";
+    }
 
-    if (argc == NUMBER_OF_RESOURCES + 4 && string(argv[NUMBER_OF_RESOURCES + 2]) == "test") {
-        string testfile = argv[NUMBER_OF_RESOURCES + 3];
+    // Replay: the whole script quietly, then throughput and latency
+    if (argc == testArg + 2 && string(argv[testArg]) == "replay") {
+        string replayfile = argv[testArg + 1];
+        Replay::Stats stats = Replay::run(replayfile, banker);
+        if (!stats.error.empty()) {
+            cout << "[ERROR] " << stats.error << "\n";
+            return 1;
+        }
+        string report = Replay::describe(stats);
+        cout << report;
+        fullLog << report;
+
+        BinaryLog::close();
+        CustomerLog::close();
+        Journal::close();
+        Logger::stopAsync();
+        cout << "[INFO] REPLAY → " << stats.commands << " commands executed from " << replayfile << "\n";
+        return 0;
+    }
+
+    if (argc == testArg + 2) {
+        string testfile = argv[testArg + 1];
         ifstream infile(testfile.c_str());
         if (!infile.is_open()) {
             cout << "[ERROR] Cannot open test file: " << testfile << "\n";
@@ -90,12 +171,15 @@ int main(int argc, char* argv[]) {
             }
         }
 
+        banker.flushDeadlockReports();
+        BinaryLog::close();
+        CustomerLog::close();
+        Journal::close();
+        Logger::stopAsync();
         cout << "[INFO] TEST → " << commandHistory.size() << " commands executed from " << testfile << "\n";
         return 0;
     }
 
-    banker.snapshot();
-
     string line;
     extern bool exitAfterTest;
     while (!exitAfterTest) {
@@ -113,6 +197,8 @@ int main(int argc, char* argv[]) {
             break;
     }
 
+    banker.flushDeadlockReports();
+    BinaryLog::close();
     cout << COLOR_CYAN << "\n===== Session Summary =====\n" << COLOR_RESET;
     cout << "Total Requests:  " << globalStats.totalRequests << "\n";
     cout << "Total Releases:  " << globalStats.totalReleases << "\n";
@@ -122,7 +208,10 @@ int main(int argc, char* argv[]) {
     cout << " > Exceeds Need:   " << COLOR_YELLOW << globalStats.deniedNeed << COLOR_RESET << "\n";
     cout << " > Exceeds Avail:  " << COLOR_YELLOW << globalStats.deniedAvailability << COLOR_RESET << "\n";
     cout << " > Unsafe State:   " << COLOR_YELLOW << globalStats.deniedUnsafe << COLOR_RESET << "\n";
+    cout << "Invalid Requests: " << globalStats.invalidRequests << "  (not decided)\n";
     cout << "Deadlocks detected: " << COLOR_RED << globalStats.countDeadlock << COLOR_RESET << "\n";
+    cout << "Fast path hits:  " << globalStats.fastPathHits + globalStats.orderReplayHits
+         << "  (misses: " << globalStats.fastPathMisses << ")\n";
     cout << COLOR_CYAN << "===========================\n" << COLOR_RESET;
 
     if (globalStats.countPreview > 0) {
@@ -145,7 +234,10 @@ int main(int argc, char* argv[]) {
             << " > Exceeds Need:   " << globalStats.deniedNeed << "\n"
             << " > Exceeds Avail:  " << globalStats.deniedAvailability << "\n"
             << " > Unsafe State:   " << globalStats.deniedUnsafe << "\n"
+            << "Invalid Requests: " << globalStats.invalidRequests << "  (not decided)\n"
             << "Deadlocks detected: " << globalStats.countDeadlock << "\n"
+            << "Fast path hits:  " << globalStats.fastPathHits + globalStats.orderReplayHits
+            << "  (misses: " << globalStats.fastPathMisses << ")\n"
             << "===========================\n";
 
     if (globalStats.countPreview > 0) {
@@ -174,7 +266,7 @@ int main(int argc, char* argv[]) {
     Logger::logSessionTXT(globalStats);
 
     // Write per-customer CSV
-    for (int i = 0; i < 10; ++i) {
+    for (int i = 0; i < numCustomers; ++i) {
         if (customerWaitTimes[i] >= 0) {  // Replace with your real condition
             Logger::logCustomerCSV(
                 i,
@@ -187,11 +279,9 @@ int main(int argc, char* argv[]) {
     }
     Logger::close();
 
-    // Close per-customer logs
-    for (int i = 0; i < 10; ++i) {
-        if (customerLogs[i].is_open())
-            customerLogs[i].close();
-    }
+    // Commit and close the per-customer history and the journal
+    CustomerLog::close();
+    Journal::close();
     saveHistory();
 
     return 0;
@@ -0,0 +1,202 @@
+// Calla Chen
+// Source Code File 31/31 for EECS 111 Project #3
+#include "replay.h"
+#include "banker.h"
+#include "command_handler.h"
+#include "logger.h"
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <vector>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+// Swallows console output while a replay runs
+class DiscardBuffer : public streambuf {
+protected:
+    int overflow(int c) { return traits_type::not_eof(c); }
+    streamsize xsputn(const char*, streamsize count) { return count; }
+};
+
+static long long monotonicNanos() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Log-linear latency histogram: values below REPLAY_SUB_BUCKETS get a bucket each, then every power of two is split
+// into REPLAY_SUB_BUCKETS equal buckets
+class LatencyHistogram {
+public:
+    LatencyHistogram() : counts(64 * REPLAY_SUB_BUCKETS, 0), total(0), largest(0) {}
+
+    void add(long long nanos) {
+        unsigned long long v = nanos > 0 ? (unsigned long long)nanos : 0;
+        counts[bucketOf(v)]++;
+        total++;
+        if (v > largest) largest = v;
+    }
+
+    // Upper bound of the bucket holding the given fraction of samples
+    double percentile(double fraction) const {
+        if (!total) return 0;
+        unsigned long long rank = (unsigned long long)(fraction * (total - 1)) + 1, seen = 0;
+        for (size_t b = 0; b < counts.size(); ++b) {
+            seen += counts[b];
+            if (seen >= rank) {
+                double bound = upperBound(b);
+                return bound < largest ? bound : (double)largest;
+            }
+        }
+        return (double)largest;
+    }
+
+    double maximum() const { return (double)largest; }
+
+private:
+    static size_t bucketOf(unsigned long long v) {
+        if (v < REPLAY_SUB_BUCKETS) return (size_t)v;
+        int shift = 0;
+        while ((v >> shift) >= 2 * REPLAY_SUB_BUCKETS) ++shift;
+        // v >> shift is in [SUB, 2 * SUB): one range of SUB buckets per shift
+        return (size_t)(shift + 1) * REPLAY_SUB_BUCKETS + (size_t)((v >> shift) - REPLAY_SUB_BUCKETS);
+    }
+
+    static double upperBound(size_t bucket) {
+        if (bucket < REPLAY_SUB_BUCKETS) return (double)bucket;
+        int shift = (int)(bucket / REPLAY_SUB_BUCKETS) - 1;
+        unsigned long long top = (unsigned long long)(bucket % REPLAY_SUB_BUCKETS + REPLAY_SUB_BUCKETS + 1) << shift;
+        return (double)(top - 1);
+    }
+
+    vector<unsigned long> counts;
+    unsigned long long total;
+    unsigned long long largest;
+};
+
+/**
+ * @brief Runs every command in a script file against the banker as fast as the handlers allow.
+ *
+ * The file is mmap()ed and each line is handed to CommandHandler::process as a span of the mapping. Console output is
+ * redirected to a discarding buffer for the duration, the safe sequence display is turned off, and the event log is
+ * switched to asynchronous mode. All three are put back afterwards. Results still reach the full session log, the binary and customer logs and the
+ * journal, exactly as they would in test mode.
+ *
+ * @param path Script or trace file, one command per line.
+ * @param banker The live state the commands run against.
+ * @return Counts, elapsed time and latency percentiles; stats.error says why nothing ran, if so.
+ */
+Replay::Stats Replay::run(const string& path, Banker& banker) {
+    Stats stats;
+    stats.commands = stats.requests = stats.denied = stats.releases = stats.logDropped = 0;
+    stats.exited = false;
+    stats.seconds = stats.p50Ns = stats.p90Ns = stats.p99Ns = stats.p999Ns = stats.maxNs = 0;
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        stats.error = "Cannot open replay file: " + path;
+        return stats;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        stats.error = "Cannot read replay file: " + path;
+        return stats;
+    }
+    size_t size = st.st_size;
+    if (size == 0) {
+        ::close(fd);
+        return stats;
+    }
+    void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        stats.error = "Cannot map replay file: " + path;
+        return stats;
+    }
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    // Quiet console, no safe sequence display (settling and printing the order costs more than most grants), batched
+    // event log
+    bool showSequence = banker.isSafeSequenceEnabled();
+    if (showSequence) banker.toggleSafeSequence();
+    bool startedAsync = !Logger::isAsync() && Logger::startAsync(REPLAY_LOG_INTERVAL_MS, REPLAY_LOG_RING);
+    unsigned long droppedBefore = Logger::isAsync() && !startedAsync ? Logger::asyncStats().dropped : 0;
+    DiscardBuffer discard;
+    streambuf* console = cout.rdbuf(&discard);
+
+    LatencyHistogram latency;
+    const char* p = (const char*)map;
+    const char* end = p + size;
+    long long started = monotonicNanos();
+    while (p < end) {
+        const char* newline = (const char*)memchr(p, '\n', end - p);
+        const char* lineEnd = newline ? newline : end;
+        const char* line = p;
+        p = newline ? newline + 1 : end;
+
+        while (line < lineEnd && (*line == ' ' || *line == '\t' || *line == '\r')) ++line;
+        if (line == lineEnd || *line == '#') continue;
+
+        long long before = monotonicNanos();
+        CommandHandler::Result result = CommandHandler::process(line, lineEnd - line, banker);
+        latency.add(monotonicNanos() - before);
+        stats.commands++;
+
+        if (result.isRequest) {
+            stats.requests++;
+            if (result.wasDenied) stats.denied++;
+        }
+        if (result.isRelease) stats.releases++;
+        if (result.status == CommandHandler::EXIT) {
+            stats.exited = true;
+            break;
+        }
+    }
+    stats.seconds = (monotonicNanos() - started) / 1e9;
+
+    banker.flushDeadlockReports();
+    cout.rdbuf(console);
+    if (banker.isSafeSequenceEnabled() != showSequence) banker.toggleSafeSequence();
+    if (startedAsync) stats.logDropped = Logger::stopAsync().dropped;
+    else if (Logger::isAsync()) stats.logDropped = Logger::asyncStats().dropped - droppedBefore;
+    munmap(map, size);
+
+    stats.p50Ns = latency.percentile(0.50);
+    stats.p90Ns = latency.percentile(0.90);
+    stats.p99Ns = latency.percentile(0.99);
+    stats.p999Ns = latency.percentile(0.999);
+    stats.maxNs = latency.maximum();
+    return stats;
+}
+
+// Nanoseconds as ns, us or ms, whichever reads best
+static string formatNanos(double nanos) {
+    stringstream out;
+    out << fixed;
+    if (nanos < 1e4) out << setprecision(0) << nanos << " ns";
+    else if (nanos < 1e7) out << setprecision(1) << nanos / 1e3 << " us";
+    else out << setprecision(1) << nanos / 1e6 << " ms";
+    return out.str();
+}
+
+string Replay::describe(const Stats& stats) {
+    stringstream out;
+    out << "[REPLAY] " << stats.commands << " commands in " << fixed << setprecision(3) << stats.seconds << " s ("
+        << setprecision(0) << (stats.seconds > 0 ? stats.commands / stats.seconds : 0) << " commands/s)"
+        << (stats.exited ? ", stopped at exit" : "") << "\n"
+        << "[REPLAY] " << stats.requests << " requests (" << stats.denied << " denied or invalid), "
+        << stats.releases << " releases\n"
+        << "[REPLAY] Latency p50 " << formatNanos(stats.p50Ns) << ", p90 " << formatNanos(stats.p90Ns)
+        << ", p99 " << formatNanos(stats.p99Ns) << ", p99.9 " << formatNanos(stats.p999Ns)
+        << ", max " << formatNanos(stats.maxNs) << "\n";
+    if (stats.logDropped)
+        out << "[REPLAY] Event log dropped " << stats.logDropped << " records (ring full)\n";
+    return out.str();
+}
@@ -0,0 +1,41 @@
+// Calla Chen
+// Source Code File 30/31 for EECS 111 Project #3
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <string>
+
+class Banker;
+
+// High-throughput replay of long command scripts and traces (the replay command, or "replay <file>" on the
+// command line).
+//
+// The script is mmap()ed and walked line by line in place; each line goes through CommandHandler::process as in test
+// mode, without being copied. While the replay runs, console output is discarded, safe sequences are not displayed,
+// lines are neither echoed nor added to the history, and the event log runs in asynchronous mode so its lines are
+// formatted and written in batches.
+// Blank lines and lines starting with '#' are skipped, and 'exit' ends the replay. Per-command latency goes into a
+// log-linear histogram (REPLAY_SUB_BUCKETS buckets per power of two), so percentiles are exact to within 12.5%.
+#define REPLAY_SUB_BUCKETS 8
+#define REPLAY_LOG_INTERVAL_MS 20       // Event log flush interval while replaying
+#define REPLAY_LOG_RING (1 << 16)       // Event log ring records while replaying
+
+class Replay {
+public:
+    struct Stats {
+        std::string error;              // Why the script could not be replayed; empty on success
+        unsigned long commands;         // Lines run, blank and comment lines not counted
+        unsigned long requests;         // RQ and RQB
+        unsigned long denied;           // Requests denied or rejected as invalid
+        unsigned long releases;
+        unsigned long logDropped;       // Event log records lost to a full ring
+        bool exited;                    // Stopped at an 'exit' line
+        double seconds;
+        double p50Ns, p90Ns, p99Ns, p999Ns, maxNs;
+    };
+
+    static Stats run(const std::string& path, Banker& banker);
+    static std::string describe(const Stats& stats);    // Throughput and latency lines for the console and full log
+};
+
+#endif //REPLAY_H
@@ -0,0 +1,248 @@
+// Calla Chen
+// Source Code File 15/15 for EECS 111 Project #3
+#include "safety.h"
+#include "kernels.h"
+#include "thread_pool.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace Safety {
+
+/**
+ * @brief Classic Banker's safety scan over the given state.
+ *
+ * Repeatedly scans every unfinished customer looking for one whose Need[i] <= Work, then simulates its completion with
+ * Work += Allocation[i]. Each pass is O(n * m) and up to n passes may be needed, so the scan is O(n^2 * m).
+ *
+ * @param view State to check.
+ * @param sequence Receives the order in which customers finish.
+ * @param finish Receives, per customer, whether it could finish.
+ * @param finalWork If not null, receives Work at the end of the check.
+ * @return true if every customer can finish; false otherwise.
+ */
+bool classic(const StateView& view, vector<int>& sequence, vector<bool>& finish, vector<int>* finalWork) {
+    // Step 1: Initialize Work = Available (padded to rowStride with zeros for the row kernels)
+    vector<int> work(view.rowStride, 0);
+    copy(view.available, view.available + view.numResources, work.begin());
+    finish.assign(view.numCustomers, false);
+    sequence.clear();
+
+    bool progress = true;
+    while (progress) {
+        progress = false;
+
+        // Step 2. Find an unfinished customer i such that Need[i] <= Work
+        for (int i = 0; i < view.numCustomers; ++i) {
+            if (!finish[i]) {
+                // Step 3. If found, simulate completion: Work += Allocation[i]
+                if (Kernels::rowFits(view.needRow(i), &work[0], view.rowStride)) {
+                    Kernels::addRow(&work[0], view.allocationRow(i), view.rowStride);
+                    finish[i] = true;
+                    sequence.push_back(i);
+                    progress = true;
+                }
+            }
+        }
+    }
+    if (finalWork) finalWork->assign(work.begin(), work.begin() + view.numResources);
+    return (int)sequence.size() == view.numCustomers;
+}
+
+// Orders (need, customer) pairs by need so each resource column can be walked from smallest to largest
+struct NeedOrder {
+    bool operator()(const pair<int, int>& a, const pair<int, int>& b) const {
+        return a.first < b.first;
+    }
+};
+
+/**
+ * @brief Advances the cursor of one resource column past every customer whose need now fits in Work.
+ *
+ * Helper for indexed(). Each passed customer has one fewer blocking resource; when none remain it is queued as ready
+ * to finish.
+ */
+static void advanceColumn(const vector<pair<int, int> >& order, int numCustomers, int column, int workValue,
+                          vector<int>& cursor, vector<int>& blocking, vector<int>& ready) {
+    const pair<int, int>* entries = &order[0] + (size_t)column * numCustomers;
+    int c = cursor[column];
+    while (c < numCustomers && entries[c].first <= workValue) {
+        if (--blocking[entries[c].second] == 0)
+            ready.push_back(entries[c].second);
+        ++c;
+    }
+    cursor[column] = c;
+}
+
+/**
+ * @brief Indexed Banker's safety check over the given state.
+ *
+ * Instead of rescanning every customer on each pass, this engine keeps one list of customers per resource sorted by
+ * their need for that resource, plus a per-customer count of resources that still block it (Need[i][j] > Work[j]).
+ * Whenever Work[j] grows, the cursor of column j advances past every customer whose need now fits, decrementing their
+ * blocking count; a customer whose count reaches zero can finish. Every (customer, resource) pair is passed at most
+ * once, so after the O(n * m * log n) sort the walk is O(n * m).
+ *
+ * Finishing order may differ from the classic scan, but the verdict is always the same: both compute the set of
+ * customers reachable from Work = Available.
+ *
+ * @param view State to check.
+ * @param sequence Receives the order in which customers finish.
+ * @param finish Receives, per customer, whether it could finish.
+ * @param finalWork If not null, receives Work at the end of the check.
+ * @return true if every customer can finish; false otherwise.
+ */
+bool indexed(const StateView& view, vector<int>& sequence, vector<bool>& finish, vector<int>* finalWork) {
+    const int numCustomers = view.numCustomers;
+    const int numResources = view.numResources;
+    vector<int> work(view.available, view.available + numResources);
+    finish.assign(numCustomers, false);
+    sequence.clear();
+    sequence.reserve(numCustomers);
+
+    // One column of (need, customer) pairs per resource, sorted by need
+    vector<pair<int, int> > order((size_t)numCustomers * numResources);
+    for (int j = 0; j < numResources; ++j) {
+        pair<int, int>* column = &order[0] + (size_t)j * numCustomers;
+        for (int i = 0; i < numCustomers; ++i)
+            column[i] = make_pair(view.needRow(i)[j], i);
+        sort(column, column + numCustomers, NeedOrder());
+    }
+
+    vector<int> blocking(numCustomers, numResources); // Resources whose need still exceeds Work
+    vector<int> cursor(numResources, 0);              // First customer in each column not yet satisfied
+    vector<int> ready;                                // Customers that can finish, in discovery order
+    ready.reserve(numCustomers);
+
+    for (int j = 0; j < numResources; ++j)
+        advanceColumn(order, numCustomers, j, work[j], cursor, blocking, ready);
+
+    // Finish ready customers one by one; only columns whose Work grew need to be advanced
+    for (size_t head = 0; head < ready.size(); ++head) {
+        int i = ready[head];
+        finish[i] = true;
+        sequence.push_back(i);
+
+        const int* allocRow = view.allocationRow(i);
+        for (int j = 0; j < numResources; ++j) {
+            if (allocRow[j] > 0) {
+                work[j] += allocRow[j];
+                advanceColumn(order, numCustomers, j, work[j], cursor, blocking, ready);
+            }
+        }
+    }
+    if (finalWork) *finalWork = work;
+    return (int)sequence.size() == numCustomers;
+}
+
+// One round of parallel(): every worker scans its slice of the unfinished customers against the round's Work
+struct ParallelRound {
+    const StateView* view;
+    const int* work;                                    // Work at the start of the round (rowStride ints)
+    const vector<int>* pending;                         // Unfinished customers, in index order
+    int chunks;                                         // Slices this round (<= pool size)
+    vector<vector<int> > localWork;                     // Per worker: Work plus what its own finishers returned
+    vector<vector<int> > returned;                      // Per worker: sum of its finishers' allocations
+    vector<vector<int> > finished;                      // Per worker: customers that finished, in scan order
+    vector<vector<int> > remaining;                     // Per worker: customers still blocked
+};
+
+/**
+ * @brief Scans one slice for customers whose need fits the round's Work.
+ *
+ * A finisher's allocation is added to this worker's local Work right away, so later customers in the same slice can
+ * use it, just as one pass of classic() would. Other workers only see it after the merge.
+ */
+static void scanSlice(void* context, int worker) {
+    ParallelRound* round = static_cast<ParallelRound*>(context);
+    if (worker >= round->chunks) return;
+
+    const StateView& view = *round->view;
+    const vector<int>& pending = *round->pending;
+    size_t lo = pending.size() * worker / round->chunks;
+    size_t hi = pending.size() * (worker + 1) / round->chunks;
+
+    vector<int>& work = round->localWork[worker];
+    vector<int>& returned = round->returned[worker];
+    work.assign(round->work, round->work + view.rowStride);
+    returned.assign(view.rowStride, 0);
+    round->finished[worker].clear();
+    round->remaining[worker].clear();
+
+    for (size_t k = lo; k < hi; ++k) {
+        int i = pending[k];
+        if (Kernels::rowFits(view.needRow(i), &work[0], view.rowStride)) {
+            Kernels::addRow(&work[0], view.allocationRow(i), view.rowStride);
+            Kernels::addRow(&returned[0], view.allocationRow(i), view.rowStride);
+            round->finished[worker].push_back(i);
+        } else {
+            round->remaining[worker].push_back(i);
+        }
+    }
+}
+
+/**
+ * @brief Multi-threaded Banker's safety check for very large customer counts.
+ *
+ * Each round splits the unfinished customers into one slice per worker and scans the slices in parallel against the
+ * same Work vector (see scanSlice()). The round then reduces every worker's returned allocations into Work, appends
+ * the finishers to the sequence slice by slice, and keeps the still-blocked customers for the next round. It stops
+ * when everyone has finished or a round finds nobody.
+ *
+ * Finishing a customer only ever adds to Work, so when a round finds nobody no remaining customer can ever finish:
+ * the verdict and the set of finished customers are the same as classic() and indexed(), only the order may differ.
+ * Small states (under SAFETY_PARALLEL_MIN_CHUNK customers per worker) are scanned on the calling thread.
+ *
+ * @param view State to check.
+ * @param sequence Receives the order in which customers finish.
+ * @param finish Receives, per customer, whether it could finish.
+ * @param pool Workers to scan with; may be shared, see ThreadPool::run().
+ * @param finalWork If not null, receives Work at the end of the check.
+ * @return true if every customer can finish; false otherwise.
+ */
+bool parallel(const StateView& view, vector<int>& sequence, vector<bool>& finish, ThreadPool& pool,
+              vector<int>* finalWork) {
+    vector<int> work(view.rowStride, 0);
+    copy(view.available, view.available + view.numResources, work.begin());
+    finish.assign(view.numCustomers, false);
+    sequence.clear();
+    sequence.reserve(view.numCustomers);
+
+    vector<int> pending(view.numCustomers);
+    for (int i = 0; i < view.numCustomers; ++i) pending[i] = i;
+
+    ParallelRound round;
+    round.view = &view;
+    round.work = &work[0];
+    round.pending = &pending;
+    round.localWork.resize(pool.size());
+    round.returned.resize(pool.size());
+    round.finished.resize(pool.size());
+    round.remaining.resize(pool.size());
+
+    while (!pending.empty()) {
+        round.chunks = (int)min((size_t)pool.size(), max((size_t)1, pending.size() / SAFETY_PARALLEL_MIN_CHUNK));
+        if (round.chunks == 1) scanSlice(&round, 0);
+        else pool.run(scanSlice, &round);
+
+        // Reduction: merge every slice's finishers into Work and the sequence, in slice order
+        size_t before = sequence.size();
+        vector<int> blocked;
+        blocked.reserve(pending.size());
+        for (int w = 0; w < round.chunks; ++w) {
+            const vector<int>& done = round.finished[w];
+            for (size_t k = 0; k < done.size(); ++k) {
+                finish[done[k]] = true;
+                sequence.push_back(done[k]);
+            }
+            if (!done.empty()) Kernels::addRow(&work[0], &round.returned[w][0], view.rowStride);
+            blocked.insert(blocked.end(), round.remaining[w].begin(), round.remaining[w].end());
+        }
+        if (sequence.size() == before) break; // Nobody could finish: the rest never will
+        pending.swap(blocked);
+    }
+    if (finalWork) finalWork->assign(work.begin(), work.begin() + view.numResources);
+    return (int)sequence.size() == view.numCustomers;
+}
+
+} // namespace Safety
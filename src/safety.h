@@ -0,0 +1,60 @@
+// Calla Chen
+// Source Code File 14/15 for EECS 111 Project #3
+#ifndef SAFETY_H
+#define SAFETY_H
+
+#include <cstddef>
+#include <vector>
+
+// Read-only view of a Banker state: row-major matrices with 'rowStride' ints per row (padding columns zero).
+//
+// One customer's allocation and need rows may be overridden, which describes "the current state with one request
+// granted" without copying the matrices. Nothing behind the view is ever written.
+struct StateView {
+    const int* available;
+    const int* allocation;
+    const int* need;
+    int numCustomers;
+    int numResources;
+    int rowStride;
+
+    int overrideCustomer;               // -1 for none
+    const int* overrideAllocation;      // Replaces allocation row 'overrideCustomer'
+    const int* overrideNeed;            // Replaces need row 'overrideCustomer'
+
+    StateView(const int* avail, const int* alloc, const int* needM, int customers, int resources, int stride)
+        : available(avail), allocation(alloc), need(needM),
+          numCustomers(customers), numResources(resources), rowStride(stride),
+          overrideCustomer(-1), overrideAllocation(0), overrideNeed(0) {}
+
+    const int* allocationRow(int i) const {
+        return i == overrideCustomer ? overrideAllocation : allocation + (size_t)i * rowStride;
+    }
+    const int* needRow(int i) const {
+        return i == overrideCustomer ? overrideNeed : need + (size_t)i * rowStride;
+    }
+};
+
+class ThreadPool;
+
+// Customers per worker below which Safety::parallel() does not wake the pool
+#define SAFETY_PARALLEL_MIN_CHUNK 2048
+
+// Pure safety checks: no logging, no stats, no shared scratch, so any number of threads may run them at once on the
+// same (unchanging) state. 'finish' plus the optional 'finalWork' (Work once nobody else could finish, numResources
+// ints) is everything needed to explain a failed check later.
+namespace Safety {
+    // Rescans every unfinished customer until no progress: O(n^2 * m)
+    bool classic(const StateView& view, std::vector<int>& sequence, std::vector<bool>& finish,
+                 std::vector<int>* finalWork = 0);
+
+    // Per-resource need orderings with blocking counts: O(n * m * log n)
+    bool indexed(const StateView& view, std::vector<int>& sequence, std::vector<bool>& finish,
+                 std::vector<int>* finalWork = 0);
+
+    // Rounds of parallel scans over the unfinished customers, merged with a reduction: O(n^2 * m / threads)
+    bool parallel(const StateView& view, std::vector<int>& sequence, std::vector<bool>& finish, ThreadPool& pool,
+                  std::vector<int>* finalWork = 0);
+}
+
+#endif //SAFETY_H
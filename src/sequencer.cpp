@@ -0,0 +1,358 @@
+// Calla Chen
+// Source Code File 19/19 for EECS 111 Project #3
+#include "sequencer.h"
+#include "kernels.h"
+#include "validator.h"
+#include <algorithm>
+#include <sched.h>
+#include <sys/time.h>
+
+using namespace std;
+
+// Wall-clock microseconds for queue latency
+static long nowMicros() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (long)tv.tv_sec * 1000000L + tv.tv_usec;
+}
+
+/**
+ * @brief Wraps a fully loaded Banker; nothing runs until start().
+ *
+ * @param b Banker the owner thread will drive.
+ * @param ringCapacity Entries the ring holds before producers have to wait (rounded up to a power of two).
+ * @param batchLimit Most entries the owner drains at once, and so the largest requestBatch() call.
+ */
+Sequencer::Sequencer(Banker& b, int ringCapacity, int batchLimit)
+    : banker(b), numResources(b.getNumResources()), capacity(1), maxBatch(max(1, batchLimit)),
+      tail(0), head(0), running(false), stopping(0), ownerSleeping(0),
+      requestCount(0), releaseCount(0), batchCount(0), checkCount(0), batchedRequests(0), drainCount(0),
+      depthTotal(0), largestBatch(0), largestDepth(0), latencies(SEQUENCER_LATENCY_SAMPLES, 0), latencyCount(0) {
+    while (capacity < ringCapacity) capacity *= 2;
+    slots.resize(capacity);
+    for (int k = 0; k < capacity; ++k) slots[k].sequence = k;
+    slotAmounts.assign((size_t)capacity * numResources, 0);
+    entries.resize(maxBatch);
+    entryAmounts.assign((size_t)maxBatch * numResources, 0);
+
+    pthread_mutex_init(&wakeMutex, NULL);
+    pthread_cond_init(&wakeCond, NULL);
+    pthread_mutex_init(&statsMutex, NULL);
+}
+
+Sequencer::~Sequencer() {
+    stop();
+    pthread_mutex_destroy(&wakeMutex);
+    pthread_cond_destroy(&wakeCond);
+    pthread_mutex_destroy(&statsMutex);
+}
+
+/**
+ * @brief Starts the owner thread. The row kernels are selected first, as in ConcurrentBanker.
+ */
+void Sequencer::start() {
+    if (running) return;
+    Kernels::init();
+    __atomic_store_n(&stopping, 0, __ATOMIC_SEQ_CST);
+    pthread_create(&owner, NULL, ownerMain, this);
+    running = true;
+}
+
+/**
+ * @brief Lets the owner decide everything already queued, then joins it. Producers must have finished submitting.
+ */
+void Sequencer::stop() {
+    if (!running) return;
+    __atomic_store_n(&stopping, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_lock(&wakeMutex);
+    pthread_cond_signal(&wakeCond);
+    pthread_mutex_unlock(&wakeMutex);
+    pthread_join(owner, NULL);
+    running = false;
+}
+
+// Customer in range and no negative amounts (checked before queueing)
+bool Sequencer::validEntry(int customerNum, const int amounts[]) const {
+    return Validator::isValidCustomer(customerNum, banker.getNumCustomers()) &&
+           Validator::isValidRequest(amounts, numResources);
+}
+
+/**
+ * @brief Claims the next ring position, copies the entry into it and publishes it to the owner.
+ *
+ * Producers race for positions with a compare-and-swap on 'tail'. A cell is free for position p when its sequence
+ * equals p; writing p + 1 hands it to the owner, which writes p + capacity once it has copied the entry out. When the
+ * ring is full the producer yields until the owner frees a cell.
+ */
+void Sequencer::enqueue(int kind, int customerNum, const int amounts[], Waiter* waiter, Callback callback,
+                        void* context) {
+    unsigned long pos = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+    Slot* slot;
+    for (;;) {
+        slot = &slots[pos & (capacity - 1)];
+        unsigned long seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        long diff = (long)(seq - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&tail, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        } else if (diff < 0) {
+            sched_yield(); // Full: wait for the owner to drain
+            pos = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+        } else {
+            pos = __atomic_load_n(&tail, __ATOMIC_RELAXED); // Another producer took this position
+        }
+    }
+
+    slot->kind = kind;
+    slot->customer = customerNum;
+    slot->waiter = waiter;
+    slot->callback = callback;
+    slot->context = context;
+    slot->enqueuedAt = nowMicros();
+    copy(amounts, amounts + numResources, slotAmounts.begin() + (size_t)(pos & (capacity - 1)) * numResources);
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+
+    // Wake the owner if it went to sleep; the fence pairs with the one in waitForWork()
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ownerSleeping, __ATOMIC_RELAXED)) {
+        pthread_mutex_lock(&wakeMutex);
+        pthread_cond_signal(&wakeCond);
+        pthread_mutex_unlock(&wakeMutex);
+    }
+}
+
+// Queues one entry and blocks until the owner has decided it
+int Sequencer::submitAndWait(int kind, int customerNum, const int amounts[]) {
+    Waiter waiter;
+    pthread_mutex_init(&waiter.mutex, NULL);
+    pthread_cond_init(&waiter.cond, NULL);
+    waiter.result = Banker::INVALID_REQUEST;
+    waiter.done = false;
+
+    enqueue(kind, customerNum, amounts, &waiter, NULL, NULL);
+
+    pthread_mutex_lock(&waiter.mutex);
+    while (!waiter.done) pthread_cond_wait(&waiter.cond, &waiter.mutex);
+    pthread_mutex_unlock(&waiter.mutex);
+    pthread_mutex_destroy(&waiter.mutex);
+    pthread_cond_destroy(&waiter.cond);
+    return waiter.result;
+}
+
+/**
+ * @brief Queues a request and waits for its verdict.
+ *
+ * @return A Banker::RequestResult, or INVALID_REQUEST for a bad customer ID or negative amounts (never queued).
+ */
+int Sequencer::request(int customerNum, const int request[]) {
+    if (!validEntry(customerNum, request)) return Banker::INVALID_REQUEST;
+    return submitAndWait(ENTRY_REQUEST, customerNum, request);
+}
+
+/**
+ * @brief Queues a release and waits until the owner has applied it; it is checked against the allocation at that point.
+ */
+bool Sequencer::release(int customerNum, const int release[]) {
+    if (!validEntry(customerNum, release)) return false;
+    return submitAndWait(ENTRY_RELEASE, customerNum, release) == Banker::GRANTED;
+}
+
+/**
+ * @brief Queues a request and returns at once; 'callback' later receives the verdict on the owner thread.
+ *
+ * An invalid request is answered immediately, on the calling thread, with INVALID_REQUEST.
+ */
+void Sequencer::requestAsync(int customerNum, const int request[], Callback callback, void* context) {
+    if (!validEntry(customerNum, request)) {
+        callback(Banker::INVALID_REQUEST, context);
+        return;
+    }
+    enqueue(ENTRY_REQUEST, customerNum, request, NULL, callback, context);
+}
+
+void* Sequencer::ownerMain(void* self) {
+    static_cast<Sequencer*>(self)->ownerLoop();
+    return NULL;
+}
+
+// Drain, decide, complete; sleep when the ring is empty; leave once stopping and empty
+void Sequencer::ownerLoop() {
+    for (;;) {
+        int count = drain();
+        if (count > 0)
+            process(count);
+        else if (__atomic_load_n(&stopping, __ATOMIC_SEQ_CST))
+            return; // Producers are done and the ring is empty
+        else
+            waitForWork();
+    }
+}
+
+/**
+ * @brief Copies up to maxBatch published entries out of the ring and frees their cells.
+ *
+ * Also samples the queue depth (entries published or being published when the drain starts).
+ */
+int Sequencer::drain() {
+    unsigned long claimed = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+    int count = 0;
+    while (count < maxBatch) {
+        Slot& slot = slots[head & (capacity - 1)];
+        if (__atomic_load_n(&slot.sequence, __ATOMIC_ACQUIRE) != head + 1) break; // Not published yet
+
+        Entry& e = entries[count];
+        e.kind = slot.kind;
+        e.customer = slot.customer;
+        e.waiter = slot.waiter;
+        e.callback = slot.callback;
+        e.context = slot.context;
+        e.enqueuedAt = slot.enqueuedAt;
+        const int* src = &slotAmounts[(size_t)(head & (capacity - 1)) * numResources];
+        copy(src, src + numResources, entryAmounts.begin() + (size_t)count * numResources);
+        __atomic_store_n(&slot.sequence, head + capacity, __ATOMIC_RELEASE);
+        ++head;
+        ++count;
+    }
+    if (count > 0) {
+        int depth = (int)(claimed - (head - count));
+        pthread_mutex_lock(&statsMutex);
+        ++drainCount;
+        depthTotal += depth;
+        largestDepth = max(largestDepth, depth);
+        pthread_mutex_unlock(&statsMutex);
+    }
+    return count;
+}
+
+/**
+ * @brief Decides the drained entries in queue order.
+ *
+ * Each run of consecutive requests goes to one requestBatch() call; a release ends the run and is applied before the
+ * requests queued after it.
+ */
+void Sequencer::process(int count) {
+    int k = 0;
+    while (k < count) {
+        if (entries[k].kind == ENTRY_RELEASE) {
+            const int* amounts = &entryAmounts[(size_t)k * numResources];
+            StateView view = banker.currentView();
+            bool valid = Validator::isValidRelease(amounts, view.allocation, view.rowStride, view.numResources,
+                                                   entries[k].customer, view.numCustomers);
+            if (valid) banker.release(entries[k].customer, amounts);
+            pthread_mutex_lock(&statsMutex);
+            ++releaseCount;
+            pthread_mutex_unlock(&statsMutex);
+            complete(entries[k], valid ? Banker::GRANTED : Banker::INVALID_REQUEST, nowMicros());
+            ++k;
+            continue;
+        }
+
+        int end = k;
+        while (end < count && entries[end].kind == ENTRY_REQUEST) ++end;
+        batch.resize(end - k);
+        for (int r = k; r < end; ++r) {
+            batch[r - k].customer = entries[r].customer;
+            const int* amounts = &entryAmounts[(size_t)r * numResources];
+            batch[r - k].amounts.assign(amounts, amounts + numResources);
+        }
+        int checks = banker.requestBatch(batch, verdicts);
+
+        pthread_mutex_lock(&statsMutex);
+        ++batchCount;
+        checkCount += checks;
+        requestCount += end - k;
+        batchedRequests += end - k;
+        largestBatch = max(largestBatch, end - k);
+        pthread_mutex_unlock(&statsMutex);
+
+        long now = nowMicros();
+        for (int r = k; r < end; ++r) complete(entries[r], verdicts[r - k], now);
+        k = end;
+    }
+}
+
+// Records the entry's latency, then wakes its producer or runs its callback
+void Sequencer::complete(const Entry& entry, int result, long now) {
+    pthread_mutex_lock(&statsMutex);
+    latencies[latencyCount % SEQUENCER_LATENCY_SAMPLES] = now - entry.enqueuedAt;
+    ++latencyCount;
+    pthread_mutex_unlock(&statsMutex);
+
+    if (entry.callback) {
+        entry.callback(result, entry.context);
+        return;
+    }
+    Waiter* waiter = entry.waiter;
+    pthread_mutex_lock(&waiter->mutex);
+    waiter->result = result;
+    waiter->done = true;
+    pthread_cond_signal(&waiter->cond);
+    pthread_mutex_unlock(&waiter->mutex);
+}
+
+/**
+ * @brief Sleeps until a producer publishes an entry or stop() is called.
+ *
+ * The owner announces it is sleeping, then re-checks the ring; a producer publishes, then checks the flag. With a
+ * full fence on both sides at least one of them sees the other, so a wakeup is never lost.
+ */
+void Sequencer::waitForWork() {
+    pthread_mutex_lock(&wakeMutex);
+    __atomic_store_n(&ownerSleeping, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    const Slot& next = slots[head & (capacity - 1)];
+    while (__atomic_load_n(&next.sequence, __ATOMIC_ACQUIRE) != head + 1 &&
+           !__atomic_load_n(&stopping, __ATOMIC_SEQ_CST))
+        pthread_cond_wait(&wakeCond, &wakeMutex);
+    __atomic_store_n(&ownerSleeping, 0, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&wakeMutex);
+}
+
+/**
+ * @brief Copies the latest state the owner has published. Never waits for the ring or the owner's batch to finish.
+ */
+void Sequencer::snapshot(Banker::StateSnapshot& snap) const {
+    banker.readSnapshot(snap);
+}
+
+/**
+ * @brief What a request would get against the latest published state, without queueing it.
+ *
+ * Entries already in the ring are not taken into account.
+ */
+int Sequencer::preview(int customerNum, const int request[], vector<int>& sequence) const {
+    if (!validEntry(customerNum, request)) return Banker::INVALID_REQUEST;
+    Banker::StateSnapshot snap;
+    banker.readSnapshot(snap);
+    return banker.previewRequest(snap.view(), customerNum, request, sequence);
+}
+
+/**
+ * @brief Queue depth, batch size and latency figures so far. Safe to call from any thread.
+ */
+Sequencer::Stats Sequencer::stats() const {
+    Stats s;
+    vector<long> samples;
+    pthread_mutex_lock(&statsMutex);
+    s.requests = requestCount;
+    s.releases = releaseCount;
+    s.batches = batchCount;
+    s.safetyChecks = checkCount;
+    s.meanBatch = batchCount ? (double)batchedRequests / batchCount : 0;
+    s.maxBatch = largestBatch;
+    s.meanDepth = drainCount ? (double)depthTotal / drainCount : 0;
+    s.maxDepth = largestDepth;
+    samples.assign(latencies.begin(), latencies.begin() + min(latencyCount, (long)SEQUENCER_LATENCY_SAMPLES));
+    pthread_mutex_unlock(&statsMutex);
+
+    s.p50Us = s.p90Us = s.p99Us = s.maxUs = 0;
+    if (!samples.empty()) {
+        sort(samples.begin(), samples.end());
+        size_t last = samples.size() - 1;
+        s.p50Us = samples[last * 50 / 100];
+        s.p90Us = samples[last * 90 / 100];
+        s.p99Us = samples[last * 99 / 100];
+        s.maxUs = samples[last];
+    }
+    return s;
+}
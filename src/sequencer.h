@@ -0,0 +1,128 @@
+// Calla Chen
+// Source Code File 18/19 for EECS 111 Project #3
+#ifndef SEQUENCER_H
+#define SEQUENCER_H
+
+#include <vector>
+#include <pthread.h>
+#include "banker.h"
+
+// Single-writer front for one Banker shared by many producer threads.
+//
+// Producers push requests and releases into a bounded lock-free multi-producer ring. One owner thread drains it,
+// decides each run of consecutive requests with a single Banker::requestBatch() call (one safety check per run where
+// possible), applies releases in queue order, and completes every entry by waking its producer or running its
+// callback. Only the owner thread ever writes the matrices; monitors read the latest published state through
+// snapshot() and preview() without ever holding up the owner. The wrapped Banker must not be used directly between
+// start() and stop().
+class Sequencer {
+public:
+    typedef void (*Callback)(int result, void* context); // Runs on the owner thread
+
+    // Queue and latency figures since start(); latency percentiles cover the last SEQUENCER_LATENCY_SAMPLES entries
+    struct Stats {
+        long requests;          // Requests decided
+        long releases;          // Releases applied or rejected
+        long batches;           // requestBatch() calls
+        long safetyChecks;      // Full safety checks run by those calls
+        double meanBatch;       // Requests per requestBatch() call
+        int maxBatch;
+        double meanDepth;       // Entries waiting in the ring when the owner started a drain
+        int maxDepth;
+        double p50Us, p90Us, p99Us, maxUs;  // Enqueue-to-completion latency in microseconds
+    };
+
+    Sequencer(Banker& banker, int capacity = 1024, int maxBatch = 64);
+    ~Sequencer();                                       // Calls stop()
+
+    void start();                                       // Starts the owner thread
+    void stop();                                        // Decides everything already queued, then joins the owner
+
+    // Producers (any thread, between start() and stop())
+    int request(int customerNum, const int request[]);  // Blocks until decided; Banker::RequestResult
+    bool release(int customerNum, const int release[]); // Blocks until applied; false if more than held
+    void requestAsync(int customerNum, const int request[], Callback callback, void* context); // Never blocks unless the ring is full
+
+    // Monitors (any thread, never block the owner)
+    void snapshot(Banker::StateSnapshot& snap) const;                               // Latest published state
+    int preview(int customerNum, const int request[], std::vector<int>& sequence) const; // Verdict without queueing
+    Stats stats() const;
+
+private:
+    Sequencer(const Sequencer&);                        // Not copyable: owns a thread and the ring
+    Sequencer& operator=(const Sequencer&);
+
+    // Completion handle for a producer blocked in request() or release()
+    struct Waiter {
+        pthread_mutex_t mutex;
+        pthread_cond_t cond;
+        int result;
+        bool done;
+    };
+
+    enum EntryKind { ENTRY_REQUEST, ENTRY_RELEASE };
+
+    // One ring cell; 'sequence' says whether it is free for position p (== p) or holds position p (== p + 1)
+    struct Slot {
+        unsigned long sequence;
+        int kind;
+        int customer;
+        Waiter* waiter;
+        Callback callback;
+        void* context;
+        long enqueuedAt;
+    };
+
+    // An entry copied out of the ring by the owner, so its cell can be reused at once
+    struct Entry {
+        int kind;
+        int customer;
+        Waiter* waiter;
+        Callback callback;
+        void* context;
+        long enqueuedAt;
+    };
+
+    bool validEntry(int customerNum, const int amounts[]) const;
+    void enqueue(int kind, int customerNum, const int amounts[], Waiter* waiter, Callback callback, void* context);
+    int submitAndWait(int kind, int customerNum, const int amounts[]);
+    static void* ownerMain(void* self);
+    void ownerLoop();
+    int drain();                                        // Copies up to maxBatch ready entries; returns the count
+    void process(int count);
+    void complete(const Entry& entry, int result, long now);
+    void waitForWork();
+
+    Banker& banker;
+    int numResources;
+    int capacity;                                       // Power of two
+    int maxBatch;
+
+    std::vector<Slot> slots;
+    std::vector<int> slotAmounts;                       // capacity rows of numResources ints
+    unsigned long tail;                                 // Next position to claim (producers, CAS)
+    unsigned long head;                                 // Next position to drain (owner only)
+
+    std::vector<Entry> entries;                         // Owner scratch: the current drain
+    std::vector<int> entryAmounts;                      // maxBatch rows of numResources ints
+    std::vector<Banker::BatchRequest> batch;
+    std::vector<int> verdicts;
+
+    pthread_t owner;
+    bool running;
+    int stopping;
+    int ownerSleeping;
+    pthread_mutex_t wakeMutex;
+    pthread_cond_t wakeCond;
+
+    // Owner-side statistics, read by stats() under statsMutex
+    mutable pthread_mutex_t statsMutex;
+    long requestCount, releaseCount, batchCount, checkCount, batchedRequests, drainCount, depthTotal;
+    int largestBatch, largestDepth;
+    std::vector<long> latencies;                        // Ring of the most recent latencies (microseconds)
+    long latencyCount;
+};
+
+#define SEQUENCER_LATENCY_SAMPLES 65536
+
+#endif //SEQUENCER_H
@@ -0,0 +1,180 @@
+// Calla Chen
+// Source Code File 21/21 for EECS 111 Project #3
+#include "thread_pool.h"
+#include <unistd.h>
+
+using namespace std;
+
+/**
+ * @brief Starts threads - 1 helper threads; the thread calling run() is always worker 0.
+ */
+ThreadPool::ThreadPool(int threads)
+    : numThreads(threads < 1 ? hardwareThreads() : threads), task(NULL), context(NULL), generation(0), pending(0),
+      shuttingDown(false) {
+    pthread_mutex_init(&runMutex, NULL);
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&startCond, NULL);
+    pthread_cond_init(&doneCond, NULL);
+
+    helpers.resize(numThreads - 1);
+    for (int w = 1; w < numThreads; ++w) {
+        Helper& h = helpers[w - 1];
+        h.pool = this;
+        h.worker = w;
+        pthread_create(&h.thread, NULL, helperMain, &h);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    pthread_mutex_lock(&mutex);
+    shuttingDown = true;
+    pthread_cond_broadcast(&startCond);
+    pthread_mutex_unlock(&mutex);
+    for (size_t k = 0; k < helpers.size(); ++k)
+        pthread_join(helpers[k].thread, NULL);
+
+    pthread_mutex_destroy(&runMutex);
+    pthread_mutex_destroy(&mutex);
+    pthread_cond_destroy(&startCond);
+    pthread_cond_destroy(&doneCond);
+}
+
+int ThreadPool::size() const {
+    return numThreads;
+}
+
+int ThreadPool::hardwareThreads() {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus < 1 ? 1 : (int)cpus;
+}
+
+/**
+ * @brief Runs task(context, w) once for every worker and waits for all of them.
+ *
+ * If another thread is already inside run(), this call does not wait for the pool: it runs every worker's share
+ * itself, one after the other. Results are the same, so callers never need to know.
+ */
+void ThreadPool::run(Task t, void* ctx) {
+    if (numThreads == 1 || pthread_mutex_trylock(&runMutex) != 0) {
+        for (int w = 0; w < numThreads; ++w) t(ctx, w);
+        return;
+    }
+
+    pthread_mutex_lock(&mutex);
+    task = t;
+    context = ctx;
+    pending = numThreads - 1;
+    ++generation;
+    pthread_cond_broadcast(&startCond);
+    pthread_mutex_unlock(&mutex);
+
+    t(ctx, 0);
+
+    pthread_mutex_lock(&mutex);
+    while (pending > 0) pthread_cond_wait(&doneCond, &mutex);
+    pthread_mutex_unlock(&mutex);
+    pthread_mutex_unlock(&runMutex);
+}
+
+// One worker's share of a parallelFor(): items [begin, end), taken from the front by its owner and split from the back
+// by thieves
+struct StealRange {
+    pthread_mutex_t lock;
+    long begin;
+    long end;
+};
+
+struct ThreadPool::StealJob {
+    IndexTask task;
+    void* context;
+    std::vector<StealRange> ranges;     // One per worker
+};
+
+/**
+ * @brief Calls task(context, i, worker) once for every i in [0, count), spread over the workers.
+ *
+ * Each worker starts with an equal contiguous range and works through it from the front. A worker that runs dry
+ * steals the back half of another worker's remaining range, so uneven items (say, safety checks that finish after
+ * one pass and ones that need many) still keep every worker busy. Per-item cost is one uncontended lock.
+ */
+void ThreadPool::parallelFor(long count, IndexTask task, void* context) {
+    StealJob job;
+    job.task = task;
+    job.context = context;
+    job.ranges.resize(numThreads);
+    for (int w = 0; w < numThreads; ++w) {
+        pthread_mutex_init(&job.ranges[w].lock, NULL);
+        job.ranges[w].begin = count * w / numThreads;
+        job.ranges[w].end = count * (w + 1) / numThreads;
+    }
+    run(stealLoop, &job);
+    for (int w = 0; w < numThreads; ++w)
+        pthread_mutex_destroy(&job.ranges[w].lock);
+}
+
+// Works through this worker's range, then steals from the others until none has anything left
+void ThreadPool::stealLoop(void* arg, int worker) {
+    StealJob* job = static_cast<StealJob*>(arg);
+    int workers = (int)job->ranges.size();
+    StealRange& own = job->ranges[worker];
+
+    for (;;) {
+        pthread_mutex_lock(&own.lock);
+        long index = own.begin < own.end ? own.begin++ : -1;
+        pthread_mutex_unlock(&own.lock);
+        if (index >= 0) {
+            job->task(job->context, index, worker);
+            continue;
+        }
+
+        // Own range is empty: take the back half of the first victim with work left
+        bool stole = false;
+        for (int k = 1; k < workers && !stole; ++k) {
+            StealRange& victim = job->ranges[(worker + k) % workers];
+            pthread_mutex_lock(&victim.lock);
+            long left = victim.end - victim.begin;
+            long from = 0, to = 0;
+            if (left > 0) {
+                from = victim.end - (left + 1) / 2;
+                to = victim.end;
+                victim.end = from;
+            }
+            pthread_mutex_unlock(&victim.lock);
+
+            if (to > from) {
+                pthread_mutex_lock(&own.lock);
+                own.begin = from;
+                own.end = to;
+                pthread_mutex_unlock(&own.lock);
+                stole = true;
+            }
+        }
+        if (!stole) return;
+    }
+}
+
+void* ThreadPool::helperMain(void* arg) {
+    Helper* h = static_cast<Helper*>(arg);
+    h->pool->helperLoop(h->worker);
+    return NULL;
+}
+
+// Waits for each new generation, runs its share, and reports back
+void ThreadPool::helperLoop(int worker) {
+    unsigned long seen = 0;
+    pthread_mutex_lock(&mutex);
+    for (;;) {
+        while (generation == seen && !shuttingDown) pthread_cond_wait(&startCond, &mutex);
+        if (shuttingDown) break;
+        seen = generation;
+        Task t = task;
+        void* ctx = context;
+        pthread_mutex_unlock(&mutex);
+
+        t(ctx, worker);
+
+        pthread_mutex_lock(&mutex);
+        if (--pending == 0) pthread_cond_signal(&doneCond);
+    }
+    pthread_mutex_unlock(&mutex);
+}
@@ -0,0 +1,54 @@
+// Calla Chen
+// Source Code File 20/21 for EECS 111 Project #3
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <pthread.h>
+
+// Fixed-size fork-join pool. run() hands the same task to every worker (the caller is worker 0, so a pool of N
+// threads starts N - 1 helpers) and returns once all of them are done. Helpers sleep between runs. parallelFor()
+// spreads many independent items over the workers with work stealing.
+class ThreadPool {
+public:
+    typedef void (*Task)(void* context, int worker);
+    typedef void (*IndexTask)(void* context, long index, int worker);
+
+    explicit ThreadPool(int threads);                   // threads < 1 means one per online CPU
+    ~ThreadPool();
+
+    int size() const;                                   // Workers, including the caller
+    void run(Task task, void* context);                 // task(context, w) for every w in [0, size())
+    void parallelFor(long count, IndexTask task, void* context); // task(context, i, w) once for every i in [0, count)
+
+    static int hardwareThreads();                       // Online CPUs (at least 1)
+
+private:
+    ThreadPool(const ThreadPool&);                      // Not copyable: owns threads
+    ThreadPool& operator=(const ThreadPool&);
+
+    struct Helper {
+        ThreadPool* pool;
+        int worker;
+        pthread_t thread;
+    };
+    struct StealJob;
+    static void stealLoop(void* job, int worker);
+    static void* helperMain(void* arg);
+    void helperLoop(int worker);
+
+    int numThreads;
+    std::vector<Helper> helpers;
+
+    pthread_mutex_t runMutex;                           // One run() at a time; a second caller runs inline
+    pthread_mutex_t mutex;                              // Guards everything below
+    pthread_cond_t startCond;
+    pthread_cond_t doneCond;
+    Task task;
+    void* context;
+    unsigned long generation;                           // Bumped by every run()
+    int pending;                                        // Helpers still working on the current run
+    bool shuttingDown;
+};
+
+#endif //THREAD_POOL_H
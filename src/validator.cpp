@@ -8,10 +8,11 @@
 * Checks whether the customer number falls within the valid range.
 *
 * @param customerNum Index of the customer to validate
-* @return true if customerNum is between 0 and NUMBER_OF_CUSTOMERS - 1; false otherwise
+* @param numCustomers Number of customers the Banker was sized for
+* @return true if customerNum is between 0 and numCustomers - 1; false otherwise
 */
-bool Validator::isValidCustomer(int customerNum) {
-    return customerNum >= 0 && customerNum < NUMBER_OF_CUSTOMERS;
+bool Validator::isValidCustomer(int customerNum, int numCustomers) {
+    return customerNum >= 0 && customerNum < numCustomers;
 }
 
 /**
@@ -20,10 +21,11 @@ bool Validator::isValidCustomer(int customerNum) {
 * Ensures the equested resource array contains no negative values.
 *
 * @param request Array of requested units for each resource.
+* @param numResources Number of resource types in request[].
 * @return true if all values are ≥ 0; false if any negative value is found.
 */
-bool Validator::isValidRequest(const int request[]) {
-    for (int i = 0; i < NUMBER_OF_RESOURCES; ++i) {
+bool Validator::isValidRequest(const int request[], int numResources) {
+    for (int i = 0; i < numResources; ++i) {
         if (request[i] < 0) return false; // Resource request must not be negative
     }
     return true;
@@ -35,16 +37,21 @@ bool Validator::isValidRequest(const int request[]) {
  * Checks that the release does not include negative values or exceed the customer's current allocation.
  *
  * @param release Array of units the customer wants to release.
- * @param allocation 2D matrix of current resource allocations per customer.
+ * @param allocation Row-major matrix of current resource allocations per customer.
+ * @param rowStride Ints between the start of consecutive allocation rows.
+ * @param numResources Number of resource types in release[].
  * @param customerNum Index of the customer requesting the release.
+ * @param numCustomers Number of customers the Banker was sized for.
  * @return true if the release is valid; false otherwise.
  */
-bool Validator::isValidRelease(const int release[], const int allocation[][NUMBER_OF_RESOURCES], int customerNum) {
-    if (!isValidCustomer(customerNum)) return false; // Request if customer ID is invalid
+bool Validator::isValidRelease(const int release[], const int* allocation, int rowStride, int numResources,
+                               int customerNum, int numCustomers) {
+    if (!isValidCustomer(customerNum, numCustomers)) return false; // Request if customer ID is invalid
 
-    for (int i = 0; i < NUMBER_OF_RESOURCES; ++i) {
+    const int* allocRow = allocation + (long)customerNum * rowStride;
+    for (int i = 0; i < numResources; ++i) {
         // Each release must be within the allocated amount and non-negative
-        if (release[i] < 0 || release[i] > allocation[customerNum][i]) return false;
+        if (release[i] < 0 || release[i] > allocRow[i]) return false;
     }
     return true;
 }
\ No newline at end of file
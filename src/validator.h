@@ -3,19 +3,18 @@
 #ifndef VALIDATOR_H
 #define VALIDATOR_H
 
-// Constants defining problem size
-#define NUMBER_OF_CUSTOMERS 5
-#define NUMBER_OF_RESOURCES 4
-
+// Problem size is no longer fixed at compile time: callers pass the Banker's dimensions
 namespace Validator {
-    // Returns true if customerNum is betwen 0 and NUMBER_OF_CUSTOMERS - 1
-    bool isValidCustomer(int customerNum);
+    // Returns true if customerNum is betwen 0 and numCustomers - 1
+    bool isValidCustomer(int customerNum, int numCustomers);
 
-    // Returns true if all values in request[][] are non-negative
-    bool isValidRequest(const int request[]);
+    // Returns true if all numResources values in request[] are non-negative
+    bool isValidRequest(const int request[], int numResources);
 
     // Returns true if release[] values are non-negative and ≤ current allocation
-    bool isValidRelease(const int release[], const int allocation[][NUMBER_OF_RESOURCES], int customerNum);
+    // (allocation is row-major with rowStride ints per customer row)
+    bool isValidRelease(const int release[], const int* allocation, int rowStride, int numResources,
+                        int customerNum, int numCustomers);
 };
 
-#endif //VALIDATOR_H
\ No newline at end of file
+#endif //VALIDATOR_H
@@ -0,0 +1,521 @@
+// Calla Chen
+// zotbank-gen: synthetic workload generator, writing a max demand file and a matching command trace
+//
+// Customers go through request/release lifecycles. A customer picked by a Zipfian draw (a few hot customers, a long
+// tail of cold ones) sets out to acquire part of its claim. It requests that in several fragments a few commands
+// apart, holds it for an exponentially distributed number of commands, then releases it in one RL. A denied fragment
+// is retried after a pause, and a customer that keeps getting denied gives up and releases what it has. A chosen share
+// of requests is built to be denied for a given reason: over the customer's need, over Available, or granted-but-unsafe.
+// The generator keeps its own copy of the state and checks safety with the bank's engines, so every verdict is known
+// in advance and printed next to the command to run. The same seed and options always give the same files.
+// Build with: make zotbank-gen
+//
+// Usage: zotbank-gen [options] <customers> <resources> <max file> <trace file>
+#include "kernels.h"
+#include "safety.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <queue>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+using namespace std;
+
+#define GEN_CRAFT_TRIES 16              // Customers tried for a designed denial before it waits for a later step
+#define GEN_CLASSIC_CUSTOMERS 1024      // Up to this many customers the classic safety check is the faster one
+#define GEN_PICK_TRIES 8                // Zipfian draws for an idle customer before the next due event comes early
+
+// Verdicts, numbered as Banker::RequestResult
+enum Verdict { GRANTED = 0, DENIED_NEED = -1, DENIED_AVAIL = -2, DENIED_UNSAFE = -3 };
+
+struct Options {
+    unsigned long long seed;
+    long commands;                      // Trace lines
+    double zipf;                        // Popularity skew: 0 uniform, 1 classic Zipf
+    int claim;                          // Maximum claim per resource is 0..claim (at least 1 unit per customer)
+    double capacity;                    // Available per resource covers this many average claims
+    int fragments;                      // A lifecycle requests its target in 1..fragments pieces
+    double think;                       // Mean commands between the fragments of one acquisition, and before a retry
+    double hold;                        // Mean commands a completed acquisition is held before release
+    int patience;                       // Denials a customer takes before giving up and releasing
+    double denyNeed, denyAvail, denyUnsafe; // Fractions of requests designed to be denied for each reason
+};
+
+// splitmix64: small, fast and the same on every platform, unlike rand()
+class Random {
+public:
+    Random(unsigned long long seed) : state(seed) {}
+
+    unsigned long long next() {
+        unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }  // [0, 1)
+    int below(int n) { return (int)(next() % (unsigned long long)n); }
+    double exponential(double mean) { return -mean * log(1.0 - uniform()); }
+
+private:
+    unsigned long long state;
+};
+
+// Customer popularity: rank k (1-based) has weight 1 / k^s, and ranks are dealt to customers in a shuffled order so
+// the hot customers are not simply the first rows
+class Zipf {
+public:
+    Zipf(int n, double s, Random& random) : cumulative(n), customerOfRank(n) {
+        double total = 0;
+        for (int k = 0; k < n; ++k) {
+            total += 1.0 / pow(k + 1.0, s);
+            cumulative[k] = total;
+        }
+        for (int k = 0; k < n; ++k) {
+            cumulative[k] /= total;
+            customerOfRank[k] = k;
+        }
+        for (int k = n - 1; k > 0; --k) swap(customerOfRank[k], customerOfRank[random.below(k + 1)]);
+    }
+
+    int draw(Random& random) const {
+        size_t rank = lower_bound(cumulative.begin(), cumulative.end(), random.uniform()) - cumulative.begin();
+        return customerOfRank[min(rank, cumulative.size() - 1)];
+    }
+
+private:
+    vector<double> cumulative;
+    vector<int> customerOfRank;
+};
+
+// The generator's copy of the bank: padded rows like Banker's so Safety and the row kernels can run on it
+class Model {
+public:
+    Model(int n, int m) : n(n), m(m), stride((m + KERNEL_LANES - 1) / KERNEL_LANES * KERNEL_LANES),
+                          maximum((size_t)n * stride), allocation((size_t)n * stride), need((size_t)n * stride),
+                          available(stride), holderSlot(n, -1),
+                          scratchAvail(stride), scratchAlloc(stride), scratchNeed(stride) {}
+
+    int* maxRow(int i) { return &maximum[(size_t)i * stride]; }
+    int* allocRow(int i) { return &allocation[(size_t)i * stride]; }
+    int* needRow(int i) { return &need[(size_t)i * stride]; }
+
+    // The bank's verdict for a request, in the bank's order of checks; a grant is applied
+    int request(int i, const int* amounts) {
+        int* nd = needRow(i);
+        for (int j = 0; j < m; ++j)
+            if (amounts[j] < 0 || amounts[j] > nd[j]) return DENIED_NEED;
+        for (int j = 0; j < m; ++j)
+            if (amounts[j] > available[j]) return DENIED_AVAIL;
+        if (!safeAfter(i, amounts)) return DENIED_UNSAFE;
+        Kernels::grantRow(&available[0], allocRow(i), nd, amounts, stride);
+        if (holderSlot[i] < 0) {
+            holderSlot[i] = (int)holders.size();
+            holders.push_back(i);
+        }
+        return GRANTED;
+    }
+
+    void release(int i, const int* amounts) {
+        Kernels::releaseRow(&available[0], allocRow(i), needRow(i), amounts, stride);
+        const int* a = allocRow(i);
+        for (int j = 0; j < m; ++j)
+            if (a[j]) return;
+        // Holds nothing any more
+        holderSlot[holders.back()] = holderSlot[i];
+        holders[holderSlot[i]] = holders.back();
+        holders.pop_back();
+        holderSlot[i] = -1;
+    }
+
+    // Safety with the request granted. Customers holding nothing can always finish last (by then Available is back to
+    // the whole capacity, which covers any single claim), so only the holders and the requester are checked.
+    bool safeAfter(int i, const int* amounts) {
+        bool finishesFirst = true;  // The requester could then finish on its own, so the state stays safe
+        for (int j = 0; j < m; ++j) {
+            scratchAvail[j] = available[j] - amounts[j];
+            scratchAlloc[j] = allocRow(i)[j] + amounts[j];
+            scratchNeed[j] = needRow(i)[j] - amounts[j];
+            if (scratchNeed[j] > scratchAvail[j]) finishesFirst = false;
+        }
+        if (finishesFirst) return true;
+
+        packedAlloc.resize((holders.size() + 1) * stride);
+        packedNeed.resize((holders.size() + 1) * stride);
+        int k = 0;
+        for (size_t h = 0; h < holders.size(); ++h) {
+            if (holders[h] == i) continue;
+            copy(allocRow(holders[h]), allocRow(holders[h]) + stride, &packedAlloc[(size_t)k * stride]);
+            copy(needRow(holders[h]), needRow(holders[h]) + stride, &packedNeed[(size_t)k * stride]);
+            ++k;
+        }
+        copy(scratchAlloc.begin(), scratchAlloc.end(), &packedAlloc[(size_t)k * stride]);
+        copy(scratchNeed.begin(), scratchNeed.end(), &packedNeed[(size_t)k * stride]);
+        ++k;
+        StateView view(&scratchAvail[0], &packedAlloc[0], &packedNeed[0], k, m, stride);
+        // Either engine gives the bank's verdict; the indexed one keeps large, crowded states affordable
+        if (k > GEN_CLASSIC_CUSTOMERS) return Safety::indexed(view, sequence, finish);
+        return Safety::classic(view, sequence, finish);
+    }
+
+    int n, m, stride;
+    vector<int> maximum, allocation, need, available;
+
+private:
+    vector<int> holders, holderSlot;    // Customers holding anything, and each one's place in that list (-1: none)
+    vector<int> scratchAvail, scratchAlloc, scratchNeed, packedAlloc, packedNeed, sequence;
+    vector<bool> finish;
+};
+
+// Where a customer is in its lifecycle
+struct Lifecycle {
+    enum Phase { IDLE, ACQUIRING, HOLDING } phase;
+    vector<int> remaining;              // Still to acquire
+    int fragmentsLeft;
+    int denials;                        // In a row, while acquiring
+};
+
+struct Counts {
+    long requests, releases, giveUps;
+    long verdicts[4];                   // By -verdict
+    long designed[4];                   // Designed denials placed, by -verdict
+    long owed[4];                       // ... and those still waiting for a state that allows them
+};
+
+class Generator {
+public:
+    Generator(const Options& options, int n, int m, ostream& trace)
+        : options(options), random(options.seed), model(n, m), customers(n), amounts(model.stride), trace(trace) {
+        // Claims first, then Available: at least the largest single claim (so the empty state is safe), and otherwise
+        // the full claims of 'capacity' average customers. How many customers hold resources at once depends on hold
+        // times and fragments rather than on the number of customers, so contention does not fade as n grows.
+        for (int i = 0; i < n; ++i) {
+            int* row = model.maxRow(i);
+            int total = 0;
+            for (int j = 0; j < m; ++j) total += row[j] = random.below(options.claim + 1);
+            if (total == 0) row[random.below(m)] = 1 + random.below(options.claim);
+            copy(row, row + m, model.needRow(i));
+        }
+        for (int j = 0; j < m; ++j) {
+            long sum = 0;
+            int largest = 0;
+            for (int i = 0; i < n; ++i) {
+                sum += model.maxRow(i)[j];
+                largest = max(largest, model.maxRow(i)[j]);
+            }
+            model.available[j] = max(largest, (int)ceil(options.capacity * sum / n));
+        }
+        popularity = new Zipf(n, options.zipf, random);
+        for (int i = 0; i < n; ++i) {
+            customers[i].phase = Lifecycle::IDLE;
+            customers[i].remaining.assign(m, 0);
+        }
+        counts.requests = counts.releases = counts.giveUps = 0;
+        lines = 0;
+        for (int k = 0; k < 4; ++k) counts.verdicts[k] = counts.designed[k] = counts.owed[k] = 0;
+    }
+
+    ~Generator() { delete popularity; }
+
+    const Counts& run() {
+        double designed = options.denyNeed + options.denyAvail + options.denyUnsafe;
+        for (step = 0; lines < options.commands; ++step) {
+            bool ready = !due.empty() && due.top().first <= step;
+            if (ready && customers[due.top().second].phase == Lifecycle::HOLDING) {
+                advance();
+                continue;
+            }
+            // Every other step is a request, a designed denial in the chosen shares. Over-Available and unsafe
+            // denials are only possible while resources are short, so the ones that cannot be placed yet are owed
+            // and placed as soon as the state allows.
+            double u = random.uniform();
+            if (u < designed)
+                counts.owed[u < options.denyNeed ? -DENIED_NEED
+                            : u < options.denyNeed + options.denyAvail ? -DENIED_AVAIL : -DENIED_UNSAFE]++;
+            bool placed = false;
+            for (int k = -DENIED_NEED; k <= -DENIED_UNSAFE && !placed; ++k)
+                if (counts.owed[k] && craftDenial(-k)) {
+                    counts.owed[k]--;
+                    counts.designed[k]++;
+                    placed = true;
+                }
+            if (placed) continue;
+            if (ready) advance();
+            else startLifecycle();
+        }
+        return counts;
+    }
+
+    Model& state() { return model; }
+
+private:
+    typedef pair<long, int> Event;      // (step, customer): the customer's next fragment or release, earliest first
+
+    // A Zipfian customer that is idle starts acquiring. With every pick busy, the next due event comes early instead.
+    void startLifecycle() {
+        for (int tries = 0; tries < GEN_PICK_TRIES; ++tries) {
+            int i = popularity->draw(random);
+            Lifecycle& c = customers[i];
+            if (c.phase != Lifecycle::IDLE) continue;
+
+            // A target of up to the whole remaining need per resource, to be requested in 1..fragments pieces
+            const int* nd = model.needRow(i);
+            int total = 0;
+            for (int j = 0; j < model.m; ++j) total += c.remaining[j] = nd[j] ? random.below(nd[j] + 1) : 0;
+            if (total == 0) continue;
+            c.phase = Lifecycle::ACQUIRING;
+            c.fragmentsLeft = min(1 + random.below(options.fragments), total);
+            c.denials = 0;
+            requestFragment(i);
+            return;
+        }
+        if (!due.empty()) {
+            advance();
+            return;
+        }
+        // Nothing in progress and nobody startable: ask for something impossible rather than emit nothing
+        if (craftDenial(DENIED_NEED)) counts.designed[-DENIED_NEED]++;
+    }
+
+    // The earliest due event: a holding customer releases, an acquiring one requests its next fragment
+    void advance() {
+        int i = due.top().second;
+        due.pop();
+        if (customers[i].phase == Lifecycle::HOLDING) {
+            releaseAll(i);
+            customers[i].phase = Lifecycle::IDLE;
+        } else {
+            requestFragment(i);
+        }
+    }
+
+    // The next piece: roughly remaining / fragmentsLeft of every resource, the rest on the last fragment. A denied
+    // piece is retried after another pause, until the customer runs out of patience and gives back what it has.
+    void requestFragment(int i) {
+        Lifecycle& c = customers[i];
+        bool any = false;
+        while (!any) {
+            for (int j = 0; j < model.m; ++j) {
+                int share = c.remaining[j] / c.fragmentsLeft;
+                if (c.remaining[j] % c.fragmentsLeft > random.below(c.fragmentsLeft)) ++share;
+                amounts[j] = c.fragmentsLeft == 1 ? c.remaining[j] : share;
+                if (amounts[j]) any = true;
+            }
+            if (!any) --c.fragmentsLeft;    // An empty piece; the last one never is
+        }
+        int verdict = emitRequest(i);
+        long pause = 1 + (long)random.exponential(options.think);
+        if (verdict == GRANTED) {
+            bool done = true;
+            for (int j = 0; j < model.m; ++j)
+                if ((c.remaining[j] -= amounts[j]) > 0) done = false;
+            c.denials = 0;
+            if (--c.fragmentsLeft == 0 || done) {
+                c.phase = Lifecycle::HOLDING;
+                pause = 1 + (long)random.exponential(options.hold);
+            }
+        } else if (++c.denials > options.patience) {
+            counts.giveUps++;
+            c.phase = Lifecycle::HOLDING;
+            pause = 1;
+        }
+        due.push(Event(step + pause, i));
+    }
+
+    // A request the bank will deny for the given reason, from one of a few Zipfian customers; false if none could
+    bool craftDenial(int want) {
+        int m = model.m;
+        for (int tries = 0; tries < GEN_CRAFT_TRIES; ++tries) {
+            int i = popularity->draw(random);
+            const int* nd = model.needRow(i);
+            fill(amounts.begin(), amounts.end(), 0);
+            if (want == DENIED_NEED) {
+                int j = random.below(m);
+                amounts[j] = nd[j] + 1 + random.below(3);
+            } else if (want == DENIED_AVAIL) {
+                // Within need but over Available on one resource
+                int start = random.below(m), j = -1;
+                for (int k = 0; k < m && j < 0; ++k)
+                    if (nd[(start + k) % m] > model.available[(start + k) % m]) j = (start + k) % m;
+                if (j < 0) continue;
+                amounts[j] = model.available[j] + 1 + random.below(nd[j] - model.available[j]);
+            } else {
+                // As much as Available allows of the whole need; only customers that could not then finish on
+                // their own can make the state unsafe
+                bool overAvailable = false, any = false;
+                for (int j = 0; j < m; ++j) {
+                    amounts[j] = min(nd[j], model.available[j]);
+                    if (nd[j] > model.available[j]) overAvailable = true;
+                    if (amounts[j]) any = true;
+                }
+                if (!overAvailable || !any || model.safeAfter(i, &amounts[0])) continue;
+            }
+            int verdict = emitRequest(i);
+            if (verdict != want) {
+                cerr << "[ERROR] Internal: designed " << want << " but got " << verdict << "\n";
+                exit(2);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    int emitRequest(int i) {
+        int verdict = model.request(i, &amounts[0]);
+        counts.requests++;
+        counts.verdicts[-verdict]++;
+        lines++;
+        trace << "RQ " << i;
+        for (int j = 0; j < model.m; ++j) trace << ' ' << amounts[j];
+        trace << '\n';
+        return verdict;
+    }
+
+    // One RL of everything the customer holds, if anything
+    void releaseAll(int i) {
+        const int* held = model.allocRow(i);
+        bool any = false;
+        for (int j = 0; j < model.m; ++j)
+            if (held[j]) any = true;
+        if (!any) return;
+        copy(held, held + model.m, amounts.begin());
+        trace << "RL " << i;
+        for (int j = 0; j < model.m; ++j) trace << ' ' << amounts[j];
+        trace << '\n';
+        model.release(i, &amounts[0]);
+        counts.releases++;
+        lines++;
+    }
+
+    Options options;
+    Random random;
+    Model model;
+    Zipf* popularity;
+    vector<Lifecycle> customers;
+    priority_queue<Event, vector<Event>, greater<Event> > due;
+    vector<int> amounts;
+    ostream& trace;
+    Counts counts;
+    long step;
+    long lines;                         // Written to the trace
+};
+
+static int usage(const char* program) {
+    cerr << "Usage: " << program << " [options] <customers> <resources> <max file> <trace file>\n"
+         << "  --seed N          Random seed (default 1); the same seed and options give the same files\n"
+         << "  --commands N      Trace length in commands (default 100000)\n"
+         << "  --zipf S          Customer popularity skew, 0 for uniform (default 0.99)\n"
+         << "  --claim N         Maximum claim per resource is 0..N units (default 10)\n"
+         << "  --capacity N      Available per resource covers the claims of N average customers (default 20)\n"
+         << "  --fragments N     Each acquisition is requested in 1..N pieces (default 4)\n"
+ << "  --think N         Mean commands between fragments, and before retrying a denied one (default 5)\n"
+         << "  --hold N          Mean commands an acquisition is held before release (default 100)\n"
+         << "  --patience N      Denials in a row before a customer gives up and releases (default 3)\n"
+         << "  --deny-need F     Share of requests built to exceed the customer's need (default 0.01)\n"
+         << "  --deny-avail F    Share of requests built to exceed Available (default 0.01)\n"
+         << "  --deny-unsafe F   Share of requests built to leave the state unsafe (default 0.01)\n";
+    return 1;
+}
+
+// Strict number parsing for the options: the whole argument must be used
+static bool parseNumber(const char* text, double& value, double low, double high) {
+    char* end;
+    value = strtod(text, &end);
+    return *text && *end == '\0' && value >= low && value <= high;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    options.seed = 1;
+    options.commands = 100000;
+    options.zipf = 0.99;
+    options.claim = 10;
+    options.capacity = 20;
+    options.fragments = 4;
+    options.think = 5;
+    options.hold = 100;
+    options.patience = 3;
+    options.denyNeed = options.denyAvail = options.denyUnsafe = 0.01;
+
+    vector<string> positional;
+    for (int a = 1; a < argc; ++a) {
+        string arg = argv[a];
+        double v;
+        if (arg.size() > 2 && arg.compare(0, 2, "--") == 0 && a + 1 < argc) {
+            const char* value = argv[++a];
+            if (arg == "--seed" && parseNumber(value, v, 0, 9007199254740992.0)) options.seed = (unsigned long long)v;
+            else if (arg == "--commands" && parseNumber(value, v, 1, 1e12)) options.commands = (long)v;
+            else if (arg == "--zipf" && parseNumber(value, v, 0, 10)) options.zipf = v;
+            else if (arg == "--claim" && parseNumber(value, v, 1, 1e6)) options.claim = (int)v;
+            else if (arg == "--capacity" && parseNumber(value, v, 0, 1e7)) options.capacity = v;
+            else if (arg == "--fragments" && parseNumber(value, v, 1, 1e6)) options.fragments = (int)v;
+            else if (arg == "--think" && parseNumber(value, v, 0, 1e12)) options.think = v;
+            else if (arg == "--hold" && parseNumber(value, v, 0, 1e12)) options.hold = v;
+            else if (arg == "--patience" && parseNumber(value, v, 0, 1e6)) options.patience = (int)v;
+            else if (arg == "--deny-need" && parseNumber(value, v, 0, 1)) options.denyNeed = v;
+            else if (arg == "--deny-avail" && parseNumber(value, v, 0, 1)) options.denyAvail = v;
+            else if (arg == "--deny-unsafe" && parseNumber(value, v, 0, 1)) options.denyUnsafe = v;
+            else return usage(argv[0]);
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            return usage(argv[0]);
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    double n, m;
+    if (positional.size() != 4 || !parseNumber(positional[0].c_str(), n, 1, 1e7)
+        || !parseNumber(positional[1].c_str(), m, 1, 4096)
+        || options.denyNeed + options.denyAvail + options.denyUnsafe > 1)
+        return usage(argv[0]);
+    const string& maxPath = positional[2];
+    const string& tracePath = positional[3];
+
+    ofstream trace(tracePath.c_str());
+    if (!trace) {
+        cerr << "[ERROR] Cannot write " << tracePath << "\n";
+        return 1;
+    }
+    Generator generator(options, (int)n, (int)m, trace);
+    Model& model = generator.state();
+
+    // The max demand file is written from the claims before any command runs
+    ofstream maxFile(maxPath.c_str());
+    if (!maxFile) {
+        cerr << "[ERROR] Cannot write " << maxPath << "\n";
+        return 1;
+    }
+    for (int i = 0; i < model.n; ++i) {
+        for (int j = 0; j < model.m; ++j) maxFile << (j ? "," : "") << model.maxRow(i)[j];
+        maxFile << "\n";
+    }
+    maxFile.close();
+
+    stringstream command;
+    command << "./zotbank " << maxPath;
+    for (int j = 0; j < model.m; ++j) command << ' ' << model.available[j];
+    command << " replay " << tracePath;
+
+    const Counts& counts = generator.run();
+    trace.close();
+    if (!trace || !maxFile) {
+        cerr << "[ERROR] Write failed\n";
+        return 1;
+    }
+
+    cout << "Wrote " << model.n << " customers x " << model.m << " resources to " << maxPath << " and "
+         << options.commands << " commands to " << tracePath << " (seed " << options.seed << ")\n"
+         << "Requests: " << counts.requests << " (" << counts.verdicts[0] << " GRANTED, "
+         << counts.verdicts[-DENIED_NEED] << " DENIED_NEED, " << counts.verdicts[-DENIED_AVAIL] << " DENIED_AVAIL, "
+         << counts.verdicts[-DENIED_UNSAFE] << " DENIED_UNSAFE), releases: " << counts.releases
+         << ", give-ups: " << counts.giveUps << "\n"
+         << "Designed denials: " << counts.designed[-DENIED_NEED] << " need, " << counts.designed[-DENIED_AVAIL]
+         << " avail, " << counts.designed[-DENIED_UNSAFE] << " unsafe";
+    if (counts.owed[-DENIED_AVAIL] || counts.owed[-DENIED_UNSAFE])
+        cout << " (" << counts.owed[-DENIED_AVAIL] << " avail and " << counts.owed[-DENIED_UNSAFE]
+             << " unsafe never placed: resources were not short enough; try a lower --capacity)";
+    cout << "\nRun with: " << command.str() << "\n";
+    return 0;
+}
@@ -0,0 +1,161 @@
+// Calla Chen
+// zotbank-logdump: decoder for the binary event log written by "binlog on" (logs/events.bin by default)
+//
+// Streams the file one record at a time, so logs of any size decode in constant memory. Prints one line per event,
+// or CSV with --csv, keeping only the customers and event types asked for. A torn last record (the session was
+// killed mid-write) is reported on stderr after everything before it. Build with: make zotbank-logdump
+//
+// Usage: zotbank-logdump [--csv] [--customer N]... [--type rq|rl|denial|deadlock|savepoint]... [file]
+#include "binary_log.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+using namespace std;
+
+// Outcome of an RQ/RL record, named as in events.log and the CSV logs
+static const char* resultName(int type, int result) {
+    if (type == BinaryLog::TYPE_RELEASE)
+        return result == 0 ? "RELEASED" : "INVALID";
+    switch (result) {
+        case 0: return "GRANTED";
+        case -1: return "DENIED_NEED";
+        case -2: return "DENIED_AVAIL";
+        case -3: return "DENIED_UNSAFE";
+        case -4: return "INVALID";
+        default: return "UNKNOWN";
+    }
+}
+
+// Filter name of a record: its type, or "denial" for a request denied by the bank
+static string filterName(const BinaryLogReader::Record& r) {
+    if (r.type == BinaryLog::TYPE_REQUEST && r.result < 0 && r.result >= -3) return "denial";
+    if (r.type == BinaryLog::TYPE_REQUEST) return "rq";
+    if (r.type == BinaryLog::TYPE_RELEASE) return "rl";
+    if (r.type == BinaryLog::TYPE_DEADLOCK) return "deadlock";
+    if (r.type == BinaryLog::TYPE_SAVEPOINT) return "savepoint";
+    return "unknown";
+}
+
+// Local time with microseconds, e.g. 2025-06-01 14:03:27.123456
+static string formatTime(long long micros) {
+    time_t seconds = (time_t)(micros / 1000000);
+    char date[32];
+    strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", localtime(&seconds));
+    char out[48];
+    snprintf(out, sizeof(out), "%s.%06lld", date, micros % 1000000);
+    return out;
+}
+
+static string joinValues(const vector<int>& values, const char* prefix) {
+    stringstream ss;
+    for (size_t i = 0; i < values.size(); ++i)
+        ss << (i ? " " : "") << prefix << values[i];
+    return ss.str();
+}
+
+static void printText(const BinaryLogReader::Record& r) {
+    cout << formatTime(r.timeMicros) << " " << BinaryLogReader::typeName(r.type);
+    switch (r.type) {
+        case BinaryLog::TYPE_REQUEST:
+        case BinaryLog::TYPE_RELEASE:
+            cout << " " << r.customer << " " << joinValues(r.values, "") << " → " << resultName(r.type, r.result);
+            break;
+        case BinaryLog::TYPE_DEADLOCK:
+            cout << " RQ " << r.customer << " " << joinValues(r.values, "") << " → " << r.result << " blocked: "
+                 << joinValues(r.extras, "P");
+            break;
+        case BinaryLog::TYPE_SAVEPOINT:
+            cout << " " << r.text;
+            break;
+    }
+    cout << "\n";
+}
+
+static void printCsv(const BinaryLogReader::Record& r) {
+    cout << r.timeMicros << "," << BinaryLogReader::typeName(r.type) << ",";
+    if (r.customer >= 0) cout << r.customer;
+    cout << "," << joinValues(r.values, "") << ",";
+    if (r.type == BinaryLog::TYPE_REQUEST || r.type == BinaryLog::TYPE_RELEASE)
+        cout << resultName(r.type, r.result);
+    else if (r.type == BinaryLog::TYPE_DEADLOCK)
+        cout << joinValues(r.extras, "P");
+    else
+        cout << r.text;
+    cout << "\n";
+}
+
+static int usage(const char* program) {
+    cerr << "Usage: " << program << " [--csv] [--customer N]... [--type rq|rl|denial|deadlock|savepoint]... [file]\n"
+         << "  Decodes a binary event log (default logs/events.bin). Filters of the same kind are ORed.\n";
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    bool csv = false;
+    set<int> customers;
+    set<string> types;
+    string path = "logs/events.bin";
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--csv") {
+            csv = true;
+        } else if (arg == "--customer" && i + 1 < argc) {
+            char* end;
+            long c = strtol(argv[++i], &end, 10);
+            if (*end != '\0' || c < 0) return usage(argv[0]);
+            customers.insert((int)c);
+        } else if (arg == "--type" && i + 1 < argc) {
+            string t = argv[++i];
+            if (t != "rq" && t != "rl" && t != "denial" && t != "deadlock" && t != "savepoint") return usage(argv[0]);
+            types.insert(t);
+        } else if (arg == "-h" || arg == "--help" || (arg.size() > 1 && arg[0] == '-')) {
+            return usage(argv[0]);
+        } else {
+            path = arg;
+        }
+    }
+
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        cerr << "[ERROR] Cannot open " << path << "\n";
+        return 1;
+    }
+    BinaryLogReader reader(file);
+    if (!reader.valid()) {
+        cerr << "[ERROR] " << path << " is not a ZotBank binary event log\n";
+        fclose(file);
+        return 1;
+    }
+
+    if (csv) cout << "time_us,event,customer,values,result\n";
+    BinaryLogReader::Record record;
+    unsigned long decoded = 0, shown = 0;
+    while (reader.next(record)) {
+        ++decoded;
+        if (!customers.empty() && !customers.count(record.customer)) continue;
+        if (!types.empty()) {
+            // An rq filter also keeps denied requests; denial keeps only those
+            string name = filterName(record);
+            if (!types.count(name) && !(name == "denial" && types.count("rq"))) continue;
+        }
+        ++shown;
+        if (csv) printCsv(record);
+        else printText(record);
+    }
+    bool torn = reader.truncated();
+    fclose(file);
+
+    cout.flush();
+    cerr << "[INFO] " << shown << " of " << decoded << " records shown from " << path << "\n";
+    if (torn) {
+        cerr << "[WARN] " << path << " ends in a torn or corrupt record; decoding stopped there\n";
+        return 2;
+    }
+    return 0;
+}